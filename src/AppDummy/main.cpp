@@ -1,6 +1,7 @@
 
 #include <format>
 #include <unordered_map>
+#include <vector>
 
 static std::string g_static = "Hello!";
 
@@ -19,6 +20,13 @@ int main(int argc, const char* argv[]) {
         }
     }
 
+    // Large enough that walking it eagerly is noticeable
+    std::vector<int> numbers(10'000'000);
+
+    for (size_t i = 0; i < numbers.size(); i++) {
+        numbers[i] = int(i);
+    }
+
     // Stop debugger here
     __builtin_debugtrap();
 
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <chrono>
+
+/// Functions exported by lldb-imgui for plugins to call
+namespace lldb::imgui {
+
+/// Frames are only drawn on input, or when the debugger's state changes. Plugins which animate, or
+/// display data which changes on its own should request new frames explicitly.
+///
+/// Safe to call from any thread.
+void RequestRedraw(std::chrono::milliseconds delay = {});
+
+/// Plugins flagged `kPluginRetained` only run when something they may depend on changed, and keep
+/// their last output on screen otherwise. Changes to the state of the debuggers they asked about,
+/// and their queries completing are picked up on their own, anything else the plugin displays has
+/// to be marked dirty.
+///
+/// Marks the calling plugin dirty when called from its entry points or queries. Threads the plugin
+/// started on its own can't be told apart, from them it marks all retained plugins dirty.
+///
+/// Safe to call from any thread.
+void MarkDirty();
+
+}
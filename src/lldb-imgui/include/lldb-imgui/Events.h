@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lldb {
+class SBDebugger;
+}
+
+/// Debugger events, gathered by the app on a background thread, and delivered to plugins once per
+/// frame, before any plugin draws. Plugins receive them through the `onDebuggerEvents` entry point
+/// of their descriptor, which is only called in frames in which something happened to `debugger`,
+/// that the plugin declared interest in through `PluginDescriptor::events`.
+namespace lldb::imgui {
+
+/// Kinds of events, as a mask
+enum DebuggerEventKind : uint32_t {
+    kEventStateChanges = 1 << 0,
+    kEventModules = 1 << 1,
+    kEventSymbols = 1 << 2,
+    kEventBreakpoints = 1 << 3,
+    kEventSelection = 1 << 4,
+    kEventOutput = 1 << 5,
+
+    kEventAll = ~0u,
+};
+
+/// Everything that happened to a debugger's targets, processes and threads since the last frame.
+/// Bursts are coalesced, the hundreds of module loads of an attach arrive as a single batch.
+struct DebuggerEvents {
+    /// Stops, resumes, launches, exits, and the like
+    uint32_t numStateChanges = 0;
+
+    /// The `lldb::StateType` of the last state change
+    uint32_t lastState = 0;
+
+    uint32_t numModulesLoaded = 0;
+    uint32_t numModulesUnloaded = 0;
+
+    bool isSymbolsLoaded = false;
+    bool isBreakpointsChanged = false;
+
+    bool isThreadSelectionChanged = false;
+    bool isFrameSelectionChanged = false;
+
+    /// The process wrote to its stdout or stderr
+    bool isOutputAvailable = false;
+
+    /// Mask of the `DebuggerEventKind`s which happened
+    uint32_t Kinds() const {
+        uint32_t kinds = 0;
+
+        if (numStateChanges) {
+            kinds |= kEventStateChanges;
+        }
+        if (numModulesLoaded || numModulesUnloaded) {
+            kinds |= kEventModules;
+        }
+        if (isSymbolsLoaded) {
+            kinds |= kEventSymbols;
+        }
+        if (isBreakpointsChanged) {
+            kinds |= kEventBreakpoints;
+        }
+        if (isThreadSelectionChanged || isFrameSelectionChanged) {
+            kinds |= kEventSelection;
+        }
+        if (isOutputAvailable) {
+            kinds |= kEventOutput;
+        }
+
+        return kinds;
+    }
+
+    void Merge(const DebuggerEvents& other) {
+        numStateChanges += other.numStateChanges;
+        lastState = other.numStateChanges ? other.lastState : lastState;
+
+        numModulesLoaded += other.numModulesLoaded;
+        numModulesUnloaded += other.numModulesUnloaded;
+
+        isSymbolsLoaded |= other.isSymbolsLoaded;
+        isBreakpointsChanged |= other.isBreakpointsChanged;
+
+        isThreadSelectionChanged |= other.isThreadSelectionChanged;
+        isFrameSelectionChanged |= other.isFrameSelectionChanged;
+
+        isOutputAvailable |= other.isOutputAvailable;
+    }
+};
+
+}
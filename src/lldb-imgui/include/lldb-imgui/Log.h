@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+/// Logging into the app's log console, which stores the arguments as they are and only formats the
+/// messages it displays. Logging costs a copy of the format string and the arguments, and neither
+/// formats nor allocates.
+namespace lldb::imgui {
+
+enum class LogLevel : uint8_t {
+    Trace,
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Critical,
+};
+
+/// Interned category name
+struct LogCategory;
+
+/// The result stays valid for the lifetime of the app. Takes a lock, so should be done once per category.
+///
+/// Safe to call from any thread.
+const LogCategory* InternLogCategory(std::string_view name);
+
+/// An argument as stored in the log, strings are copied along with it
+struct LogArg {
+    enum class Type : uint8_t {
+        Int,
+        UInt,
+        Double,
+        Bool,
+        Char,
+        Pointer,
+        String,
+    };
+
+    Type type;
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        bool b;
+        char c;
+        const void* p;
+        struct {
+            const char* data;
+            size_t size;
+        } s;
+    };
+};
+
+/// Safe to call from any thread.
+void WriteLog(const LogCategory* category, LogLevel level, std::string_view format, std::span<const LogArg> args);
+
+template<typename T>
+LogArg MakeLogArg(const T& value) {
+    if constexpr (std::same_as<T, bool>) {
+        return { .type = LogArg::Type::Bool, .b = value };
+    } else if constexpr (std::same_as<T, char>) {
+        return { .type = LogArg::Type::Char, .c = value };
+    } else if constexpr (std::signed_integral<T>) {
+        return { .type = LogArg::Type::Int, .i = value };
+    } else if constexpr (std::unsigned_integral<T>) {
+        return { .type = LogArg::Type::UInt, .u = value };
+    } else if constexpr (std::floating_point<T>) {
+        return { .type = LogArg::Type::Double, .d = double(value) };
+    } else if constexpr (std::convertible_to<const T&, std::string_view>) {
+        std::string_view string(value);
+        return { .type = LogArg::Type::String, .s = { string.data(), string.size() } };
+    } else if constexpr (std::is_pointer_v<T> || std::same_as<T, std::nullptr_t>) {
+        return { .type = LogArg::Type::Pointer, .p = static_cast<const void*>(value) };
+    } else {
+        static_assert(sizeof(T) == 0, "Only scalars, pointers and strings can be logged, format anything else up front");
+    }
+}
+
+/// Logs into a single category of the log console
+class Logger {
+public:
+    explicit Logger(std::string_view category)
+    : _category(InternLogCategory(category))
+    {}
+
+    template<typename... Args>
+    void Log(LogLevel level, std::format_string<const Args&...> format, const Args&... args) const {
+        std::array<LogArg, sizeof...(Args)> encoded { MakeLogArg(args)... };
+        WriteLog(_category, level, format.get(), encoded);
+    }
+
+    template<typename... Args>
+    void Trace(std::format_string<const Args&...> format, const Args&... args) const {
+        Log(LogLevel::Trace, format, args...);
+    }
+    template<typename... Args>
+    void Debug(std::format_string<const Args&...> format, const Args&... args) const {
+        Log(LogLevel::Debug, format, args...);
+    }
+    template<typename... Args>
+    void Info(std::format_string<const Args&...> format, const Args&... args) const {
+        Log(LogLevel::Info, format, args...);
+    }
+    template<typename... Args>
+    void Warn(std::format_string<const Args&...> format, const Args&... args) const {
+        Log(LogLevel::Warn, format, args...);
+    }
+    template<typename... Args>
+    void Error(std::format_string<const Args&...> format, const Args&... args) const {
+        Log(LogLevel::Error, format, args...);
+    }
+
+private:
+    const LogCategory* _category;
+};
+
+}
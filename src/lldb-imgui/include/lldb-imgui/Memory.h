@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace lldb {
+class SBDebugger;
+}
+
+namespace lldb::imgui {
+
+/// Memory of a process loaded from a core file, in place in a mapping of the core. Nothing is
+/// copied, pages of the core are read from disk as they are touched, and stay valid for as long as
+/// the app runs.
+///
+/// Empty if the process of `debugger` wasn't loaded from a core, or the core doesn't hold the whole
+/// range. Memory it doesn't hold, like the code of mapped files, can still be read through LLDB.
+///
+/// Never blocks, safe to call from any thread.
+std::span<const std::byte> MapCoreMemory(lldb::SBDebugger& debugger, uint64_t address, size_t size);
+
+}
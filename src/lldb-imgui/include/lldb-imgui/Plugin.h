@@ -0,0 +1,76 @@
+#pragma once
+
+#include "lldb-imgui/Events.h"
+
+#include <cstdint>
+
+namespace lldb {
+class SBDebugger;
+}
+
+/// Plugins describe their entry points and what they need from the app with a single descriptor
+///
+///     LLDB_IMGUI_PLUGIN({
+///         .flags = lldb::imgui::kPluginRetained,
+///         .events = lldb::imgui::kEventStateChanges | lldb::imgui::kEventModules,
+///         .drawDebugger = DrawDebugger,
+///     });
+///
+/// Fields have to be given in the order they are declared in, all of them are optional. Plugins
+/// without a descriptor are still bound by the `void Draw()` and
+/// `void DrawDebugger(lldb::SBDebugger&)` they export, and get nothing else.
+namespace lldb::imgui {
+
+class PluginState;
+
+/// Bumped whenever the meaning of an existing field changes. Fields are only ever appended, a
+/// plugin built against an older layout gets the defaults of the fields it doesn't know about.
+inline constexpr uint32_t kPluginABIVersion = 1;
+
+enum PluginFlags : uint32_t {
+    /// Only runs when something it may depend on changed, see `MarkDirty()`. Has to draw into
+    /// windows of its own, like any plugin which may be skipped: the app keeps those on screen, but
+    /// not what the plugin added to windows begun by someone else.
+    kPluginRetained = 1 << 0,
+
+    /// `prepare` touches neither ImGui, nor anything `draw` and `drawDebugger` use without
+    /// synchronization, and may run on a worker thread alongside other plugins. It is still called
+    /// for one debugger after the other.
+    kPluginThreadSafe = 1 << 1,
+};
+
+struct PluginDescriptor {
+    uint32_t abiVersion = kPluginABIVersion;
+    uint32_t size = sizeof(PluginDescriptor);
+
+    /// Mask of `PluginFlags`
+    uint32_t flags = 0;
+
+    /// Mask of the `DebuggerEventKind`s the plugin reacts to. Others are neither delivered, nor
+    /// do they make a retained plugin run again.
+    uint32_t events = kEventAll;
+
+    /// Runs at most this many times a second, zero for every frame. See `kPluginRetained` for what
+    /// is kept on screen in between.
+    double updateRate = 0;
+
+    void (*draw)() = nullptr;
+    void (*drawDebugger)(lldb::SBDebugger& debugger) = nullptr;
+
+    /// Called for each debugger in the frames the plugin runs in, before any plugin draws them.
+    /// Heavy lifting done here runs in parallel for thread safe plugins.
+    void (*prepare)(lldb::SBDebugger& debugger) = nullptr;
+
+    void (*onDebuggerEvents)(lldb::SBDebugger& debugger, const DebuggerEvents& events) = nullptr;
+
+    /// See `PluginState`
+    void (*saveState)(PluginState& state) = nullptr;
+    void (*restoreState)(PluginState& state) = nullptr;
+};
+
+}
+
+/// Exports the descriptor of the plugin, under a name the app looks up
+#define LLDB_IMGUI_PLUGIN(...)                                                       \
+    extern "C" __attribute__((visibility("default"), used))                          \
+    const lldb::imgui::PluginDescriptor LLDBImGuiPlugin = lldb::imgui::PluginDescriptor __VA_ARGS__
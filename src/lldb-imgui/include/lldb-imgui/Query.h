@@ -0,0 +1,154 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <exception>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+
+namespace lldb {
+class SBDebugger;
+}
+
+/// Queries run debugger calls on a worker thread, so that slow ones like expression evaluation
+/// don't stall rendering and input. Completed queries request a redraw.
+namespace lldb::imgui {
+
+/// Work submitted to the query thread
+class QueryTask {
+public:
+    virtual ~QueryTask() = default;
+
+    /// Runs on the query thread, and may block on the debugger
+    virtual void Run(lldb::SBDebugger& debugger) = 0;
+
+    /// Publishes the result of `Run`
+    virtual void Complete() = 0;
+    /// Called instead of `Complete` if the debugger's process changed state before the task could finish
+    virtual void Cancel() = 0;
+};
+
+/// Changes whenever the processes of `debugger` stop, resume, or are replaced, and when their
+/// selected thread or frame changes. Never blocks.
+///
+/// Safe to call from any thread.
+uint64_t GetDebuggerGeneration(lldb::SBDebugger& debugger);
+
+/// Queues `task` to run on the query thread. Tasks are cancelled if the debugger's generation
+/// changes before they finish.
+///
+/// Safe to call from any thread.
+void SubmitQuery(lldb::SBDebugger& debugger, std::shared_ptr<QueryTask> task);
+
+struct QueryCancelled : std::exception {
+    const char* what() const noexcept override {
+        return "Query cancelled";
+    }
+};
+
+/// Runs `work(SBDebugger&)` on the query thread. The future throws `QueryCancelled` if the query
+/// was cancelled.
+template<typename F>
+auto Submit(lldb::SBDebugger& debugger, F&& work) {
+    using Result = std::invoke_result_t<F, lldb::SBDebugger&>;
+
+    class Task : public QueryTask {
+    public:
+        explicit Task(F&& work)
+        : _work(std::forward<F>(work))
+        {}
+
+        void Run(lldb::SBDebugger& debugger) override {
+            try {
+                if constexpr (std::is_void_v<Result>) {
+                    _work(debugger);
+                } else {
+                    _result.emplace(_work(debugger));
+                }
+            } catch (...) {
+                _exception = std::current_exception();
+            }
+        }
+
+        void Complete() override {
+            if (_exception) {
+                _promise.set_exception(_exception);
+            } else if constexpr (std::is_void_v<Result>) {
+                _promise.set_value();
+            } else {
+                _promise.set_value(std::move(*_result));
+            }
+        }
+        void Cancel() override {
+            _promise.set_exception(std::make_exception_ptr(QueryCancelled()));
+        }
+
+        std::shared_future<Result> Future() {
+            return _promise.get_future().share();
+        }
+
+    private:
+        std::decay_t<F> _work;
+
+        std::conditional_t<std::is_void_v<Result>, bool, std::optional<Result>> _result {};
+        std::exception_ptr _exception;
+
+        std::promise<Result> _promise;
+    };
+
+    auto task = std::make_shared<Task>(std::forward<F>(work));
+    auto future = task->Future();
+
+    SubmitQuery(debugger, std::move(task));
+
+    return future;
+}
+
+/// Results of keyed queries against a single debugger, for immediate mode code which asks for the
+/// same values every frame. Results are dropped whenever the debugger's generation changes.
+template<typename T>
+class QueryCache {
+public:
+    /// Result of the query for `key`, or null while it is still running
+    template<typename F>
+    const T* Get(lldb::SBDebugger& debugger, const std::string& key, F&& work) {
+        auto generation = GetDebuggerGeneration(debugger);
+
+        if (std::exchange(_generation, generation) != generation) {
+            _entries.clear();
+        }
+
+        auto it = _entries.find(key);
+        if (it == _entries.end()) {
+            it = _entries.emplace(key, Submit(debugger, std::forward<F>(work))).first;
+        }
+
+        auto& future = it->second;
+        if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return nullptr;
+        }
+
+        try {
+            return &future.get();
+        } catch (const QueryCancelled&) {
+            // Try again next frame
+            _entries.erase(it);
+            return nullptr;
+        }
+    }
+
+    void Clear() {
+        _entries.clear();
+    }
+
+private:
+    uint64_t _generation = 0;
+    std::unordered_map<std::string, std::shared_future<T>> _entries;
+};
+
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/// Plugins keep what they computed across reloads through the `saveState` and `restoreState` entry
+/// points of their descriptor. `saveState` is called right before the plugin is unloaded for a
+/// reload, and `restoreState` right after its new version is loaded. Neither is called when the
+/// plugin is disabled or removed.
+namespace lldb::imgui {
+
+/// Arena owned by the app, which outlives the code of the plugin that filled it. It only ever holds
+/// bytes: pointers into the plugin, like vtables or the buffers of standard containers, don't make
+/// it across a reload.
+///
+/// The new version may lay its state out differently, so storing a version along with it is wise.
+class PluginState {
+public:
+    PluginState();
+    ~PluginState();
+
+    PluginState(const PluginState&) = delete;
+
+    /// `size` uninitialized bytes stored under `key`, replacing what was stored there before.
+    /// Aligned for any type.
+    std::span<std::byte> Allocate(std::string_view key, size_t size);
+
+    void Store(std::string_view key, std::span<const std::byte> bytes);
+
+    /// Bytes stored under `key`, empty if there are none. They stay valid until the plugin is
+    /// reloaded again, so they may be used in place rather than copied.
+    std::span<const std::byte> Find(std::string_view key) const;
+
+    /// Bytes stored in total
+    size_t Size() const;
+
+private:
+    std::vector<std::unique_ptr<std::byte[]>> _chunks;
+    size_t _chunkUsed = 0;
+
+    std::unordered_map<std::string, std::span<std::byte>> _entries;
+};
+
+/// Serializes plain values and strings, for `PluginState::Store`
+class StateWriter {
+public:
+    template<typename T> requires std::is_trivially_copyable_v<T>
+    void Write(const T& value) {
+        auto* bytes = reinterpret_cast<const std::byte*>(&value);
+
+        _bytes.insert(_bytes.end(), bytes, bytes + sizeof(T));
+    }
+
+    void Write(std::string_view string) {
+        Write<uint64_t>(string.size());
+
+        auto* bytes = reinterpret_cast<const std::byte*>(string.data());
+        _bytes.insert(_bytes.end(), bytes, bytes + string.size());
+    }
+
+    std::span<const std::byte> Bytes() const {
+        return _bytes;
+    }
+
+private:
+    std::vector<std::byte> _bytes;
+};
+
+/// Reads back what a `StateWriter` wrote. Reading past the end fails the reader, and every read
+/// after it, so a state written by an incompatible version can't take the plugin down.
+class StateReader {
+public:
+    explicit StateReader(std::span<const std::byte> bytes)
+    : _bytes(bytes)
+    {}
+
+    template<typename T> requires std::is_trivially_copyable_v<T>
+    bool Read(T& value) {
+        if (_isFailed || _bytes.size() < sizeof(T)) {
+            _isFailed = true;
+            return false;
+        }
+
+        std::memcpy(&value, _bytes.data(), sizeof(T));
+        _bytes = _bytes.subspan(sizeof(T));
+        return true;
+    }
+
+    bool Read(std::string& string) {
+        uint64_t size = 0;
+
+        if (!Read(size) || _bytes.size() < size) {
+            _isFailed = true;
+            return false;
+        }
+
+        string.assign(reinterpret_cast<const char*>(_bytes.data()), size);
+        _bytes = _bytes.subspan(size);
+        return true;
+    }
+
+    bool IsFailed() const {
+        return _isFailed;
+    }
+
+    /// Whether everything was read, and nothing failed
+    bool IsDone() const {
+        return !_isFailed && _bytes.empty();
+    }
+
+private:
+    std::span<const std::byte> _bytes;
+    bool _isFailed = false;
+};
+
+}
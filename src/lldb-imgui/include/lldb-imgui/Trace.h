@@ -0,0 +1,56 @@
+#pragma once
+
+#include <chrono>
+#include <string_view>
+
+/// Zones recorded while tracing is enabled through the View menu, or `--trace`, and saved as
+/// Chrome trace JSON which can be opened in Perfetto or chrome://tracing
+namespace lldb::imgui {
+
+/// Interned zone name
+struct TraceName;
+
+/// The result stays valid for the lifetime of the app. Takes a lock, so should be done once per zone.
+///
+/// Safe to call from any thread.
+const TraceName* InternTraceName(std::string_view name);
+
+bool IsTracing();
+
+/// Records a zone which ran on the calling thread from `start` to `end`
+///
+/// Safe to call from any thread.
+void RecordTraceZone(const TraceName* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+/// Records its own lifetime as a zone
+class TraceZone {
+public:
+    explicit TraceZone(const TraceName* name)
+    : _name(name)
+    {
+        if (IsTracing()) {
+            _start = std::chrono::steady_clock::now();
+        }
+    }
+    ~TraceZone() {
+        if (_start != std::chrono::steady_clock::time_point()) {
+            RecordTraceZone(_name, _start, std::chrono::steady_clock::now());
+        }
+    }
+
+    TraceZone(const TraceZone&) = delete;
+
+private:
+    const TraceName* _name;
+    std::chrono::steady_clock::time_point _start;
+};
+
+}
+
+#define TRACE_ZONE_CONCAT_(a, b) a##b
+#define TRACE_ZONE_CONCAT(a, b) TRACE_ZONE_CONCAT_(a, b)
+
+/// Records the enclosing scope as a zone
+#define TRACE_ZONE(name) \
+    static const auto* TRACE_ZONE_CONCAT(_traceName, __LINE__) = ::lldb::imgui::InternTraceName(name); \
+    ::lldb::imgui::TraceZone TRACE_ZONE_CONCAT(_traceZone, __LINE__)(TRACE_ZONE_CONCAT(_traceName, __LINE__))
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace lldb {
+class SBDebugger;
+}
+
+namespace lldb::imgui {
+
+/// Locates a variable in a stack frame of the debugger's selected process
+struct ValuePath {
+    /// Zero for the selected thread
+    uint64_t threadID = 0;
+    uint32_t frameIndex = 0;
+
+    /// Anything `SBFrame::GetValueForVariablePath` understands, like `foo.bar[2]->baz`
+    std::string path;
+};
+
+/// Snapshot of an `SBValue`
+struct ValueInfo {
+    bool isValid = false;
+    std::string error;
+
+    std::string type;
+    std::string value;
+    std::string summary;
+
+    uint32_t numChildren = 0;
+};
+
+/// Values are shared between all plugins, and fetched on the query thread once per stop of the
+/// process. Returns null while the value is being fetched, the result stays valid until the end of
+/// the frame.
+///
+/// Has to be called from the UI thread.
+const ValueInfo* FetchValue(lldb::SBDebugger& debugger, const ValuePath& path);
+
+}
@@ -1,5 +1,10 @@
 #include "App.h"
 
+#include "lldb-imgui/API.h"
+#include "LogRing.h"
+#include "PluginHost.h"
+#include "Trace.h"
+
 #include "lldb/API/LLDB.h"
 
 #include "SDL3/SDL.h"
@@ -13,6 +18,10 @@
 
 #include <filesystem>
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <format>
+#include <limits>
 
 /// PLANS:
 ///
@@ -44,7 +53,9 @@ class App::PluginHandler {
     std::unordered_map<PluginID, PluginSpec> _plugins;
 
     void SaveIniSettingsNow() {
-        ImGui::SaveIniSettingsToDisk(ImGui::GetIO().IniFilename);
+        if (auto* filename = ImGui::GetIO().IniFilename) {
+            ImGui::SaveIniSettingsToDisk(filename);
+        }
     }
 
     void DrawPluginMenuItem(PluginID id, PluginSpec& spec) {
@@ -64,6 +75,7 @@ class App::PluginHandler {
 
         changed |= Checkbox("Enabled", &spec.isEnabled);
         changed |= Checkbox("AutoReload", &spec.isAutoReload);
+        changed |= Checkbox("Out of process", &spec.isOutOfProcess);
 
         if (changed) {
             SaveIniSettingsNow();
@@ -108,6 +120,12 @@ class App::PluginHandler {
             DrawPluginMenuItem(entry.key, _plugins.at(entry.key));
         }
 
+        Separator();
+        if (BeginMenu("Blame")) {
+            _loader.DrawBlame();
+            EndMenu();
+        }
+
         Separator();
         if (MenuItem("Add")) {
             static std::array kFilters = {
@@ -178,6 +196,8 @@ public:
                 spec->isEnabled = true;
             } else if (StripPrefix(line, "isAutoReload=1")) {
                 spec->isAutoReload = true;
+            } else if (StripPrefix(line, "isOutOfProcess=1")) {
+                spec->isOutOfProcess = true;
             }
         };
         handler.ApplyAllFn = [](ImGuiContext*, ImGuiSettingsHandler* handler) {
@@ -196,11 +216,15 @@ public:
                 buffer->appendf("path=%s\n", plugin.path.c_str());
                 buffer->appendf("isEnabled=%d\n", plugin.isEnabled);
                 buffer->appendf("isAutoReload=%d\n", plugin.isAutoReload);
+                buffer->appendf("isOutOfProcess=%d\n", plugin.isOutOfProcess);
             }
         };
 
         ImGui::AddSettingsHandler(&handler);
-        ImGui::LoadIniSettingsFromDisk(ImGui::GetIO().IniFilename);
+
+        if (auto* filename = ImGui::GetIO().IniFilename) {
+            ImGui::LoadIniSettingsFromDisk(filename);
+        }
     }
     ~PluginHandler() {
         ImGui::RemoveSettingsHandler("Plugins");
@@ -219,6 +243,47 @@ public:
     }
 };
 
+/// Number of frames drawn after input, giving ImGui a chance to settle hover and navigation state
+static constexpr int kInputFrames = 3;
+
+/// How often the log and the stream are checked for changes while idle
+static constexpr auto kStatePollInterval = std::chrono::milliseconds(100);
+
+/// Half the period of ImGui's text input caret blinking
+static constexpr auto kCaretBlinkInterval = std::chrono::milliseconds(400);
+
+/// Earliest frame requested through `RequestRedraw`, zero if there is none
+static std::atomic<std::chrono::steady_clock::rep> g_redrawDeadline = 0;
+
+void RequestRedraw(std::chrono::milliseconds delay) {
+    auto deadline = (std::chrono::steady_clock::now() + delay).time_since_epoch().count();
+
+    auto current = g_redrawDeadline.load();
+    while (current == 0 || deadline < current) {
+        if (g_redrawDeadline.compare_exchange_weak(current, deadline)) {
+            break;
+        }
+    }
+
+    // The main thread picks up the deadline before going idle, but might already be waiting
+    if (!SDL_IsMainThread()) {
+        static const Uint32 kRedrawEvent = SDL_RegisterEvents(1);
+
+        SDL_Event event {
+            .type = kRedrawEvent,
+        };
+        SDL_PushEvent(&event);
+    }
+}
+
+std::optional<std::chrono::steady_clock::time_point> TakeRedrawDeadline() {
+    auto deadline = g_redrawDeadline.exchange(0);
+    if (deadline == 0) {
+        return std::nullopt;
+    }
+    return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(deadline));
+}
+
 static void LogAdapter(void* userdata, int rawCategory, SDL_LogPriority priority, const char* message) {
     using namespace spdlog;
     using namespace spdlog::level;
@@ -253,10 +318,13 @@ static void LogAdapter(void* userdata, int rawCategory, SDL_LogPriority priority
         case SDL_LOG_CATEGORY_GPU:         category = "GPU";         break;
     }
 
+    // Shows up as its own category in the log console
+    static auto logger = spdlog::default_logger()->clone("SDL");
+
     if (category) {
-        spdlog::log(level, "[SDL][{}] {}", category, message);
+        logger->log(level, "[{}] {}", category, message);
     } else {
-        spdlog::log(level, "[SDL][{}] {}", rawCategory, message);
+        logger->log(level, "[{}] {}", rawCategory, message);
     }
 }
 
@@ -273,25 +341,88 @@ bool App::EventWatch(void* userdata, SDL_Event* event) {
     return true;
 }
 
-App::App() = default;
+App::App()
+: _events([this] {
+    _queries.Wake();
+
+    // Retained plugins are marked out of date by the events they take, once delivered
+    RequestRedraw();
+})
+{}
 App::~App() = default;
 
 SDL_AppResult App::Init(std::span<const std::string_view> args) {
+    // Loggers walk their sinks without a lock, so other threads may be using the sinks of the default
+    // logger. It is replaced by one with the log ring added instead, and kept alive for whoever is
+    // in the middle of a call.
+    static auto previousLogger = spdlog::default_logger();
+
+    auto sinks = previousLogger->sinks();
+    sinks.push_back(std::make_shared<LogRingSink>());
+
+    auto logger = std::make_shared<spdlog::logger>(previousLogger->name(), sinks.begin(), sinks.end());
+    logger->set_level(previousLogger->level());
+    spdlog::set_default_logger(std::move(logger));
+
     SDL_SetLogOutputFunction(LogAdapter, nullptr);
 
-    if (!SDL_Init(SDL_INIT_EVENTS | SDL_INIT_VIDEO | SDL_INIT_GAMEPAD)) {
-        return SDL_APP_FAILURE;
+    bool isHeadless = false;
+    int benchmarkFrames = 0;
+
+    std::vector<std::string_view> plugins;
+    std::vector<std::string_view> targets;
+    std::vector<std::string_view> cores;
+
+    std::string_view serveAddress;
+    std::string_view connectAddress;
+
+    for (size_t i = 1; i < args.size(); i++) {
+        auto arg = args[i];
+        auto value = (i + 1 < args.size()) ? args[i + 1] : std::string_view();
+
+        if (arg == "--headless") {
+            isHeadless = true;
+        } else if (arg == "--benchmark") {
+            isHeadless = true;
+            benchmarkFrames = 1000;
+
+            if (std::from_chars(value.data(), value.data() + value.size(), benchmarkFrames).ec == std::errc()) {
+                i++;
+            }
+        } else if (arg == "--trace" && !value.empty()) {
+            _tracePath = args[++i];
+        } else if (arg == "--plugin" && !value.empty()) {
+            plugins.push_back(args[++i]);
+        } else if (arg == "--target" && !value.empty()) {
+            targets.push_back(args[++i]);
+        } else if (arg == "--core" && !value.empty()) {
+            cores.push_back(args[++i]);
+        } else if (arg == "--serve" && !value.empty()) {
+            isHeadless = true;
+            serveAddress = args[++i];
+        } else if (arg == "--connect" && !value.empty()) {
+            connectAddress = args[++i];
+        } else {
+            spdlog::warn("Ignoring unknown argument '{}'", arg);
+        }
     }
 
-    _window = SDL_CreateWindow("lldb-imgui", 1280, 720, SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY);
-    _gpu = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_METALLIB, true, nullptr);
+    SetTraceThreadName("Main");
 
-    if (!_gpu || !_window || !SDL_ClaimWindowForGPUDevice(_gpu, _window)) {
-        return SDL_APP_FAILURE;
+    if (!_tracePath.empty()) {
+        StartTracing();
     }
 
-    SDL_SetGPUSwapchainParameters(_gpu, _window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_VSYNC);
-    SDL_AddEventWatch(EventWatch, this);
+    // Count allocations from the very first one ImGui makes
+    InstallImGuiAllocationCounter();
+
+    if (isHeadless) {
+        if (!SDL_Init(SDL_INIT_EVENTS)) {
+            return SDL_APP_FAILURE;
+        }
+    } else if (!InitWindow()) {
+        return SDL_APP_FAILURE;
+    }
 
     // Setup ImGui
     ImGui::CreateContext();
@@ -306,41 +437,374 @@ SDL_AppResult App::Init(std::span<const std::string_view> args) {
     }
     ImGui::StyleColorsDark();
 
-    // Setup ImGui Platform/Renderer
-    ImGui_ImplSDL3_InitForSDLGPU(_window);
+    if (_window) {
+        // Setup ImGui Platform/Renderer
+        ImGui_ImplSDL3_InitForSDLGPU(_window);
 
-    ImGui_ImplSDLGPU3_InitInfo initInfo {
-        .Device = _gpu,
-        .ColorTargetFormat = SDL_GetGPUSwapchainTextureFormat(_gpu, _window),
-        .MSAASamples = SDL_GPU_SAMPLECOUNT_1,
-    };
-    ImGui_ImplSDLGPU3_Init(&initInfo);
+        ImGui_ImplSDLGPU3_InitInfo initInfo {
+            .Device = _gpu,
+            .ColorTargetFormat = SDL_GetGPUSwapchainTextureFormat(_gpu, _window),
+            .MSAASamples = SDL_GPU_SAMPLECOUNT_1,
+        };
+        ImGui_ImplSDLGPU3_Init(&initInfo);
+
+        // Raise the newly created window for the sake of RPC main, where this doesnt
+        // happen automatically the second time we enter foreground mode
+        SDL_RaiseWindow(_window);
+    } else {
+        // Null renderer: a fixed display, and a font atlas which is never uploaded
+        ImGuiIO& io = ImGui::GetIO();
+
+        io.DisplaySize = ImVec2(1280, 720);
+        io.IniFilename = nullptr;
+
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        io.Fonts->SetTexID(ImTextureID(1));
+    }
+
+    if (!connectAddress.empty()) {
+        // Viewers show the plugins of the server, and none of their own
+        ImGui::GetIO().IniFilename = nullptr;
+
+        _streamViewer = StreamViewer::Connect(connectAddress);
+        if (!_streamViewer) {
+            return SDL_APP_FAILURE;
+        }
+    }
+    if (!serveAddress.empty()) {
+        _streamServer = StreamServer::Listen(serveAddress);
+        if (!_streamServer) {
+            return SDL_APP_FAILURE;
+        }
+    }
 
-    // Raise the newly created window for the sake of RPC main, where this doesnt
-    // happen automatically the second time we enter foreground mode
-    SDL_RaiseWindow(_window);
+    // Has to precede the plugin handler, which loads the settings file
+    AddSettingsHandler();
 
-    _pluginLoader = PluginLoader::Create();
+    _pluginLoader = PluginLoader::Create(_threadPool);
     _pluginHandler = std::make_unique<PluginHandler>(*_pluginLoader, _window);
+    _pluginLoader->SetFrameBudget(_pluginFrameBudgetMs);
+
+    // Plugins and targets from the command line, these don't touch the persisted plugin list
+    for (size_t i = 0; i < plugins.size(); i++) {
+        _pluginLoader->Update(std::numeric_limits<PluginID>::max() - i, PluginSpec {
+            .path = plugins[i],
+            .isEnabled = true,
+        });
+    }
+    if (!targets.empty() || !cores.empty()) {
+        SBDebugger::Initialize();
+    }
+    if (!targets.empty()) {
+        auto debugger = SBDebugger::Create(false);
+
+        for (auto target : targets) {
+            SBError error;
+            debugger.CreateTarget(std::string(target).c_str(), nullptr, nullptr, false, error);
+
+            if (error.Fail()) {
+                spdlog::error("Failed to create target '{}': {}", target, error.GetCString());
+            }
+        }
+        AddDebugger(debugger);
+    }
+
+    // Each core gets a debugger of its own, which is what its mapping is looked up by
+    for (auto core : cores) {
+        auto debugger = SBDebugger::Create(false);
+
+        SBError error;
+        auto target = debugger.CreateTarget("", nullptr, nullptr, false, error);
+
+        if (error.Success()) {
+            target.LoadCore(std::string(core).c_str(), error);
+        }
+        if (error.Fail()) {
+            spdlog::error("Failed to load core '{}': {}", core, error.GetCString());
+
+            SBDebugger::Destroy(debugger);
+            continue;
+        }
+
+        std::string mapError;
+        if (!_coreMemory.Add(debugger, core, mapError)) {
+            spdlog::warn("Reading the memory of core '{}' through LLDB: {}", core, mapError);
+        }
+
+        AddDebugger(debugger);
+    }
+
+    if (benchmarkFrames > 0) {
+        _benchmark = std::make_unique<Benchmark>(benchmarkFrames, 10);
+    }
 
     return SDL_APP_CONTINUE;
 }
 
+bool App::InitWindow() {
+    if (!SDL_Init(SDL_INIT_EVENTS | SDL_INIT_VIDEO | SDL_INIT_GAMEPAD)) {
+        return false;
+    }
+
+    _window = SDL_CreateWindow("lldb-imgui", 1280, 720, SDL_WINDOW_RESIZABLE | SDL_WINDOW_HIGH_PIXEL_DENSITY);
+    _gpu = SDL_CreateGPUDevice(SDL_GPU_SHADERFORMAT_SPIRV | SDL_GPU_SHADERFORMAT_DXIL | SDL_GPU_SHADERFORMAT_METALLIB, true, nullptr);
+
+    if (!_gpu || !_window || !SDL_ClaimWindowForGPUDevice(_gpu, _window)) {
+        return false;
+    }
+
+    SDL_SetGPUSwapchainParameters(_gpu, _window, SDL_GPU_SWAPCHAINCOMPOSITION_SDR, SDL_GPU_PRESENTMODE_VSYNC);
+    SDL_AddEventWatch(EventWatch, this);
+
+    return true;
+}
+
 SDL_AppResult App::Iterate() {
-    if (SDL_GetWindowFlags(_window) & SDL_WINDOW_MINIMIZED) {
+    if (_benchmark) {
+        Draw();
+
+        if (_benchmark->Record(_frameStats)) {
+            return SDL_APP_CONTINUE;
+        }
+
+        _benchmark->Report();
+        return SDL_APP_SUCCESS;
+    }
+
+    if (_streamViewer && !_streamViewer->IsConnected()) {
+        return SDL_APP_SUCCESS;
+    }
+
+    if (_window && SDL_GetWindowFlags(_window) & SDL_WINDOW_MINIMIZED) {
         SDL_Delay(10);
 
         return SDL_APP_CONTINUE;
     }
 
+    auto now = Clock::now();
+
+    if (now >= _nextStatePoll) {
+        _nextStatePoll = now + kStatePollInterval;
+
+        if (_logConsole.Update() && _isLogOpen) {
+            RequestFrames(1);
+        }
+        if (_streamServer && _streamServer->Update()) {
+            RequestFrames(1);
+        }
+    }
+
+    auto deadline = g_redrawDeadline.load();
+    if (deadline != 0 && deadline <= now.time_since_epoch().count()) {
+        if (g_redrawDeadline.compare_exchange_strong(deadline, 0)) {
+            RequestFrames(1);
+        }
+    }
+
+    if (_isIdleRendering && _pendingFrames == 0) {
+        return SDL_APP_CONTINUE;
+    }
+    if (now < _lastFrame + std::chrono::milliseconds(_minFrameIntervalMs)) {
+        return SDL_APP_CONTINUE;
+    }
+
     Draw();
 
     return SDL_APP_CONTINUE;
 }
 
+Sint32 App::IdleTimeout() const {
+    if (_benchmark) {
+        return 0;
+    }
+
+    auto now = Clock::now();
+
+    Clock::time_point due = now;
+
+    if (_isIdleRendering && _pendingFrames == 0) {
+        due = _nextStatePoll;
+
+        if (auto deadline = g_redrawDeadline.load()) {
+            due = std::min(due, Clock::time_point(Clock::duration(deadline)));
+        }
+    }
+
+    due = std::max(due, _lastFrame + std::chrono::milliseconds(_minFrameIntervalMs));
+
+    if (due <= now) {
+        return 0;
+    }
+    return std::chrono::ceil<std::chrono::milliseconds>(due - now).count();
+}
+
+void App::RequestFrames(int count) {
+    _pendingFrames = std::max(_pendingFrames, count);
+}
+
+void App::AddSettingsHandler() {
+    ImGuiSettingsHandler handler;
+
+    handler.TypeName = "Rendering";
+    handler.TypeHash = ImHashStr(handler.TypeName);
+    handler.UserData = this;
+
+    handler.ReadOpenFn = [](ImGuiContext*, ImGuiSettingsHandler* handler, const char* name) -> void* {
+        return handler->UserData;
+    };
+    handler.ReadLineFn = [](ImGuiContext*, ImGuiSettingsHandler* handler, void* ptr, const char* line) {
+        auto* app = reinterpret_cast<App*>(ptr);
+
+        int value = 0;
+        float budget = 0;
+
+        if (sscanf(line, "isIdleRendering=%d", &value) == 1) {
+            app->_isIdleRendering = value;
+        } else if (sscanf(line, "minFrameIntervalMs=%d", &value) == 1) {
+            app->_minFrameIntervalMs = std::max(value, 0);
+        } else if (sscanf(line, "isVariablesOpen=%d", &value) == 1) {
+            app->_isVariablesOpen = value;
+        } else if (sscanf(line, "isSymbolsOpen=%d", &value) == 1) {
+            app->_isSymbolsOpen = value;
+        } else if (sscanf(line, "isWatchesOpen=%d", &value) == 1) {
+            app->_isWatchesOpen = value;
+        } else if (sscanf(line, "isLogOpen=%d", &value) == 1) {
+            app->_isLogOpen = value;
+        } else if (sscanf(line, "pluginFrameBudgetMs=%f", &budget) == 1) {
+            app->_pluginFrameBudgetMs = std::max(budget, 0.0f);
+        }
+    };
+    handler.WriteAllFn = [](ImGuiContext*, ImGuiSettingsHandler* handler, ImGuiTextBuffer* buffer) {
+        auto* app = reinterpret_cast<App*>(handler->UserData);
+
+        buffer->appendf("[%s][App]\n", handler->TypeName);
+        buffer->appendf("isIdleRendering=%d\n", app->_isIdleRendering);
+        buffer->appendf("minFrameIntervalMs=%d\n", app->_minFrameIntervalMs);
+        buffer->appendf("pluginFrameBudgetMs=%.1f\n", app->_pluginFrameBudgetMs);
+        buffer->appendf("isVariablesOpen=%d\n", app->_isVariablesOpen);
+        buffer->appendf("isSymbolsOpen=%d\n", app->_isSymbolsOpen);
+        buffer->appendf("isWatchesOpen=%d\n", app->_isWatchesOpen);
+        buffer->appendf("isLogOpen=%d\n", app->_isLogOpen);
+    };
+
+    ImGui::AddSettingsHandler(&handler);
+}
+
+void App::DrawViewMenu() {
+    using namespace ImGui;
+
+    if (!BeginMainMenuBar()) {
+        return;
+    }
+
+    if (BeginMenu("View")) {
+        bool changed = false;
+
+        changed |= Checkbox("Idle rendering", &_isIdleRendering);
+        SetItemTooltip("Only draw frames on input, debugger state changes, or when plugins request it");
+
+        changed |= SliderInt("Min frame interval", &_minFrameIntervalMs, 0, 100, "%d ms");
+
+        if (SliderFloat("Plugin frame budget", &_pluginFrameBudgetMs, 0, 33, "%.1f ms")) {
+            _pluginLoader->SetFrameBudget(_pluginFrameBudgetMs);
+            changed = true;
+        }
+        SetItemTooltip("Plugins which keep exceeding their share of this are throttled, 0 disables throttling");
+
+        Separator();
+        changed |= MenuItem("Variables", nullptr, &_isVariablesOpen);
+        changed |= MenuItem("Symbols", nullptr, &_isSymbolsOpen);
+        changed |= MenuItem("Watches", nullptr, &_isWatchesOpen);
+        changed |= MenuItem("Log", nullptr, &_isLogOpen);
+
+        Separator();
+        if (bool isTracing = IsTracing(); MenuItem("Record trace", nullptr, &isTracing)) {
+            isTracing ? StartTracing() : StopTracing();
+        }
+        if (MenuItem("Save trace...", nullptr, false, _window != nullptr)) {
+            StopTracing();
+
+            static std::array kFilters = {
+                SDL_DialogFileFilter {
+                    .name = "Chrome trace",
+                    .pattern = "json",
+                },
+            };
+
+            SDL_DialogFileCallback completion = [](void *userdata, const char* const *filelist, int filter) {
+                if (!filelist || !filelist[0]) {
+                    return;
+                }
+
+                WriteTrace(filelist[0]);
+            };
+            SDL_ShowSaveFileDialog(completion, nullptr, _window, kFilters.data(), kFilters.size(), "trace.json");
+        }
+        SetItemTooltip("Stops recording, the trace opens in ui.perfetto.dev or chrome://tracing");
+
+        if (changed && GetIO().IniFilename) {
+            SaveIniSettingsToDisk(GetIO().IniFilename);
+        }
+
+        EndMenu();
+    }
+
+    EndMainMenuBar();
+}
+
+void App::DrawVariables(SBDebugger& debugger) {
+    using namespace ImGui;
+
+    if (!_isVariablesOpen) {
+        return;
+    }
+
+    auto title = std::format("Variables ({})", debugger.GetID());
+
+    if (Begin(title.c_str(), &_isVariablesOpen)) {
+        _variableTrees.try_emplace(debugger.GetID(), _queries).first->second.Draw(debugger);
+    }
+    End();
+}
+
+void App::DrawSymbols(SBDebugger& debugger) {
+    using namespace ImGui;
+
+    if (!_isSymbolsOpen) {
+        return;
+    }
+
+    auto title = std::format("Symbols ({})", debugger.GetID());
+
+    if (Begin(title.c_str(), &_isSymbolsOpen)) {
+        _symbolNavigators.try_emplace(debugger.GetID(), _threadPool).first->second.Draw(debugger);
+    }
+    End();
+}
+
+void App::DrawWatches(SBDebugger& debugger) {
+    using namespace ImGui;
+
+    if (!_isWatchesOpen) {
+        return;
+    }
+
+    auto title = std::format("Watches ({})", debugger.GetID());
+
+    if (Begin(title.c_str(), &_isWatchesOpen)) {
+        _watchLists[debugger.GetID()].Draw(debugger);
+    }
+    End();
+}
+
 SDL_AppResult App::Event(const SDL_Event& event) {
     ImGui_ImplSDL3_ProcessEvent(&event);
 
+    RequestFrames(kInputFrames);
+
     if (event.type == SDL_EVENT_WINDOW_CLOSE_REQUESTED && event.window.windowID == SDL_GetWindowID(_window)) {
         return SDL_APP_SUCCESS;
     }
@@ -352,9 +816,26 @@ SDL_AppResult App::Event(const SDL_Event& event) {
 }
 
 void App::Quit() {
+    if (!_tracePath.empty()) {
+        StopTracing();
+        WriteTrace(_tracePath);
+    }
+
+    ImGui::RemoveSettingsHandler("Rendering");
+
     _pluginHandler.reset();
     _pluginLoader.reset();
 
+    _streamServer.reset();
+    _streamViewer.reset();
+
+    if (!_window) {
+        ImGui::DestroyContext();
+
+        SDL_QuitSubSystem(SDL_INIT_EVENTS);
+        return;
+    }
+
     SDL_WaitForGPUIdle(_gpu);
 
     ImGui_ImplSDL3_Shutdown();
@@ -371,30 +852,142 @@ void App::Quit() {
 
 void App::AddDebugger(SBDebugger& debugger) {
     _debuggers.push_back(debugger);
+    _queries.AddDebugger(debugger);
+    _events.AddDebugger(debugger);
+
+    RequestFrames(kInputFrames);
 }
 
 void App::Draw() {
-    ImGui_ImplSDLGPU3_NewFrame();
-    ImGui_ImplSDL3_NewFrame();
+    TRACE_ZONE("Frame");
+
+    _lastFrame = Clock::now();
+    _pendingFrames = std::max(_pendingFrames - 1, 0);
+
+    _frameStats = FrameStats();
+
+    auto allocations = GetThreadAllocationCount();
+    auto phaseStart = Clock::now();
+    auto phaseCPUStart = GetThreadCPUTime();
+
+    static const auto kPhaseTraceNames = [] {
+        std::array<const TraceName*, size_t(FramePhase::Count)> names;
+
+        for (size_t i = 0; i < names.size(); i++) {
+            names[i] = InternTraceName(GetFramePhaseName(FramePhase(i)));
+        }
+        return names;
+    }();
+
+    auto endPhase = [&](FramePhase phase) {
+        auto now = Clock::now();
+        auto cpuNow = GetThreadCPUTime();
+
+        RecordTraceZone(kPhaseTraceNames[size_t(phase)], phaseStart, now);
+        phaseStart = now;
+
+        _frameStats.phases[size_t(phase)] = cpuNow - std::exchange(phaseCPUStart, cpuNow);
+        _frameStats.phasesRun |= 1u << size_t(phase);
+    };
+
+    if (_window) {
+        ImGui_ImplSDLGPU3_NewFrame();
+        ImGui_ImplSDL3_NewFrame();
+    } else if (_streamServer) {
+        _streamServer->Update();
+
+        if (_streamServer->ApplyInput()) {
+            RequestFrames(kInputFrames);
+        }
+    } else {
+        ImGui::GetIO().DeltaTime = 1.0f / 60.0f;
+    }
 
     ImGui::NewFrame();
+    _values.BeginFrame(_debuggers);
+    endPhase(FramePhase::NewFrame);
+
+    if (_streamViewer) {
+        _streamViewer->Draw();
+    } else {
+        _pluginHandler->Draw();
+        DrawViewMenu();
+    }
+
+    if (_isLogOpen) {
+        _logConsole.Draw(&_isLogOpen);
+    }
+    endPhase(FramePhase::PluginHandler);
+
+    auto events = _events.Drain();
+
+    for (auto& debugger : _debuggers) {
+        if (auto it = events.find(debugger.GetID()); it != events.end()) {
+            _pluginLoader->DeliverEvents(debugger, it->second);
+        }
+    }
 
-    _pluginHandler->Draw();
     _pluginLoader->DrawPlugins();
+    _pluginLoader->PrepareDebuggers(_debuggers);
+    endPhase(FramePhase::Plugins);
 
-    std::erase_if(_debuggers, [&](auto& debugger) {
+    auto numRemoved = std::erase_if(_debuggers, [&](auto& debugger) {
         _pluginLoader->DrawDebugger(debugger);
+        DrawVariables(debugger);
+        DrawSymbols(debugger);
+        DrawWatches(debugger);
 
         return !debugger.IsValid();
     });
 
+    // Removed debuggers can't tell their ID anymore, so keep the views of the remaining ones
+    if (numRemoved != 0) {
+        auto isRemoved = [&](const auto& entry) {
+            return std::ranges::none_of(_debuggers, [&](auto& debugger) {
+                return debugger.GetID() == entry.first;
+            });
+        };
+        std::erase_if(_variableTrees, isRemoved);
+        std::erase_if(_symbolNavigators, isRemoved);
+        std::erase_if(_watchLists, isRemoved);
+    }
+    endPhase(FramePhase::Debuggers);
+
+    // Keep drawing while something is being dragged, and let the text caret blink
+    if (ImGui::GetIO().WantTextInput) {
+        RequestRedraw(kCaretBlinkInterval);
+    } else if (ImGui::IsAnyItemActive()) {
+        RequestFrames(1);
+    }
+
     ImGui::EndFrame();
 
     // Rendering
     ImGui::Render();
     ImDrawData* draw_data = ImGui::GetDrawData();
+    _pluginLoader->EndFrame(draw_data);
+
+    if (_streamViewer) {
+        _streamViewer->EndFrame(draw_data);
+    }
+    if (_streamServer) {
+        _streamServer->SendFrame(draw_data);
+    }
     const bool is_minimized = (draw_data->DisplaySize.x <= 0.0f || draw_data->DisplaySize.y <= 0.0f);
 
+    _frameStats.vertices = draw_data->TotalVtxCount;
+    _frameStats.indices = draw_data->TotalIdxCount;
+
+    for (auto* list : draw_data->CmdLists) {
+        _frameStats.drawCommands += list->CmdBuffer.Size;
+    }
+    endPhase(FramePhase::Render);
+
+    if (!_gpu) {
+        _frameStats.allocations = GetThreadAllocationCount() - allocations;
+        return;
+    }
+
     SDL_GPUCommandBuffer* command_buffer = SDL_AcquireGPUCommandBuffer(_gpu); // Acquire a GPU command buffer
 
     SDL_GPUTexture* swapchain_texture;
@@ -402,7 +995,10 @@ void App::Draw() {
 
     if (swapchain_texture != nullptr && !is_minimized) {
         // This is mandatory: call Imgui_ImplSDLGPU3_PrepareDrawData() to upload the vertex/index buffer!
-        Imgui_ImplSDLGPU3_PrepareDrawData(draw_data, command_buffer);
+        {
+            TRACE_ZONE("PrepareDrawData");
+            Imgui_ImplSDLGPU3_PrepareDrawData(draw_data, command_buffer);
+        }
 
         // Setup and start a render pass
         SDL_GPUColorTargetInfo target_info = {};
@@ -423,6 +1019,9 @@ void App::Draw() {
 
     // Submit the command buffer
     SDL_SubmitGPUCommandBuffer(command_buffer);
+
+    endPhase(FramePhase::Submit);
+    _frameStats.allocations = GetThreadAllocationCount() - allocations;
 }
 
 }
@@ -1,10 +1,24 @@
 #pragma once
 
 #include "PluginLoader.h"
+#include "Benchmark.h"
+#include "CoreMemory.h"
+#include "EventBus.h"
+#include "LogConsole.h"
+#include "QueryEngine.h"
+#include "StreamServer.h"
+#include "StreamViewer.h"
+#include "SymbolNavigator.h"
+#include "ThreadPool.h"
+#include "ValueCache.h"
+#include "VariableTree.h"
+#include "WatchList.h"
 
 #include "SDL3/SDL_init.h"
 #include "SDL3/SDL_gpu.h"
 
+#include <chrono>
+#include <filesystem>
 #include <unordered_map>
 #include <string_view>
 #include <span>
@@ -30,19 +44,79 @@ public:
 
     void AddDebugger(SBDebugger& debugger);
 
+    /// Milliseconds the caller may wait for events before calling `Iterate()` again
+    Sint32 IdleTimeout() const;
+
 private:
+    using Clock = std::chrono::steady_clock;
+
     static bool EventWatch(void* userdata, SDL_Event* event);
 
+    bool InitWindow();
+
+    void RequestFrames(int count);
+
+    void AddSettingsHandler();
+    void DrawViewMenu();
+    void DrawVariables(SBDebugger& debugger);
+    void DrawSymbols(SBDebugger& debugger);
+    void DrawWatches(SBDebugger& debugger);
+
     void Draw();
 
+    // Both are null when running headless
     SDL_Window* _window = nullptr;
     SDL_GPUDevice* _gpu = nullptr;
 
+    FrameStats _frameStats;
+    std::unique_ptr<Benchmark> _benchmark;
+
+    // Written on quit when tracing from the command line
+    std::filesystem::path _tracePath;
+
+    // Outlives the plugins, which may have queries in flight
+    QueryEngine _queries;
+    ValueCache _values {_queries};
+
+    // Wakes the queries and the UI when a debugger broadcasts a change
+    EventBus _events;
+
+    // Cores opened with `--core`, outlives the plugins holding on to their memory
+    CoreMemory _coreMemory;
+
+    ThreadPool _threadPool;
+
     class PluginHandler;
     std::unique_ptr<PluginHandler> _pluginHandler;
     std::unique_ptr<PluginLoader> _pluginLoader;
 
     std::vector<SBDebugger> _debuggers;
+
+    // Serving the UI to a viewer with `--serve`, or viewing another app's with `--connect`
+    std::unique_ptr<StreamServer> _streamServer;
+    std::unique_ptr<StreamViewer> _streamViewer;
+
+    bool _isVariablesOpen = false;
+    std::unordered_map<lldb::user_id_t, VariableTree> _variableTrees;
+
+    bool _isSymbolsOpen = false;
+    std::unordered_map<lldb::user_id_t, SymbolNavigator> _symbolNavigators;
+
+    bool _isWatchesOpen = false;
+    std::unordered_map<lldb::user_id_t, WatchList> _watchLists;
+
+    bool _isLogOpen = false;
+    LogConsole _logConsole;
+
+    // Idle rendering
+    bool _isIdleRendering = true;
+    int _minFrameIntervalMs = 0;
+    float _pluginFrameBudgetMs = 8.0f;
+
+    int _pendingFrames = 1;
+
+    Clock::time_point _lastFrame;
+    Clock::time_point _nextStatePoll;
 };
 
 }
@@ -0,0 +1,179 @@
+#include "Benchmark.h"
+
+#include "imgui.h"
+
+#include <time.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <print>
+
+static thread_local uint64_t t_allocations = 0;
+
+#if defined(LLDB_IMGUI_COUNT_ALLOCATIONS)
+// Replacing the global allocation functions also covers plugins, which resolve these against the app
+void* operator new(size_t size) {
+    t_allocations++;
+
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+#endif
+
+namespace lldb::imgui {
+
+static constexpr std::array kPhaseNames = {
+    "NewFrame",
+    "PluginHandler",
+    "Plugins",
+    "Debuggers",
+    "Render",
+    "Submit",
+};
+static_assert(kPhaseNames.size() == size_t(FramePhase::Count));
+
+const char* GetFramePhaseName(FramePhase phase) {
+    return kPhaseNames[size_t(phase)];
+}
+
+std::chrono::nanoseconds GetThreadCPUTime() {
+    timespec time {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+
+    return std::chrono::seconds(time.tv_sec) + std::chrono::nanoseconds(time.tv_nsec);
+}
+
+bool IsCountingAllocations() {
+#if defined(LLDB_IMGUI_COUNT_ALLOCATIONS)
+    return true;
+#else
+    return false;
+#endif
+}
+
+uint64_t GetThreadAllocationCount() {
+    return t_allocations;
+}
+
+void InstallImGuiAllocationCounter() {
+    auto alloc = [](size_t size, void*) -> void* {
+        t_allocations++;
+        return std::malloc(size);
+    };
+    auto free = [](void* ptr, void*) {
+        std::free(ptr);
+    };
+
+    ImGui::SetAllocatorFunctions(alloc, free);
+}
+
+Benchmark::Benchmark(int frames, int warmupFrames)
+: _frames(frames)
+, _warmupFrames(warmupFrames)
+{
+    _samples.reserve(frames);
+}
+
+bool Benchmark::Record(const FrameStats& stats) {
+    if (_warmupFrames > 0) {
+        _warmupFrames--;
+        return true;
+    }
+
+    _samples.push_back(stats);
+    return _samples.size() < size_t(_frames);
+}
+
+void Benchmark::Report() const {
+    if (_samples.empty()) {
+        return;
+    }
+
+    struct Summary {
+        double mean;
+        double p50;
+        double p99;
+        double max;
+    };
+
+    auto summarize = [&](auto&& value) {
+        std::vector<double> values;
+        values.reserve(_samples.size());
+
+        for (const auto& sample : _samples) {
+            values.push_back(value(sample));
+        }
+        std::sort(values.begin(), values.end());
+
+        double sum = 0;
+        for (double value : values) {
+            sum += value;
+        }
+
+        auto percentile = [&](double p) {
+            return values[std::min<size_t>(values.size() * p, values.size() - 1)];
+        };
+
+        return Summary {
+            .mean = sum / values.size(),
+            .p50 = percentile(0.50),
+            .p99 = percentile(0.99),
+            .max = values.back(),
+        };
+    };
+
+    auto print = [](const char* name, const Summary& summary) {
+        std::println("{:<16}{:>12.1f}{:>12.1f}{:>12.1f}{:>12.1f}", name, summary.mean, summary.p50, summary.p99, summary.max);
+    };
+
+    std::println("Frames: {}", _samples.size());
+    std::println();
+    std::println("{:<16}{:>12}{:>12}{:>12}{:>12}", "CPU time [us]", "mean", "p50", "p99", "max");
+
+    for (size_t i = 0; i < size_t(FramePhase::Count); i++) {
+        bool isRun = std::ranges::any_of(_samples, [&](const FrameStats& stats) {
+            return stats.phasesRun & (1u << i);
+        });
+        if (!isRun) {
+            std::println("{:<16}{:>12}", kPhaseNames[i], "not run");
+            continue;
+        }
+
+        print(kPhaseNames[i], summarize([&](const FrameStats& stats) {
+            return std::chrono::duration<double, std::micro>(stats.phases[i]).count();
+        }));
+    }
+    print("Total", summarize([&](const FrameStats& stats) {
+        std::chrono::nanoseconds total {};
+
+        for (auto phase : stats.phases) {
+            total += phase;
+        }
+        return std::chrono::duration<double, std::micro>(total).count();
+    }));
+
+    std::println();
+    std::println("{:<16}{:>12}{:>12}{:>12}{:>12}", "Per frame", "mean", "p50", "p99", "max");
+
+    print("Vertices", summarize([](const FrameStats& stats) {
+        return stats.vertices;
+    }));
+    print("Indices", summarize([](const FrameStats& stats) {
+        return stats.indices;
+    }));
+    print("Draw commands", summarize([](const FrameStats& stats) {
+        return stats.drawCommands;
+    }));
+    print(IsCountingAllocations() ? "Allocations" : "ImGui allocs", summarize([](const FrameStats& stats) {
+        return stats.allocations;
+    }));
+}
+
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Phases of `App::Draw`, in order
+enum class FramePhase {
+    NewFrame,
+    PluginHandler,
+    Plugins,
+    Debuggers,
+    Render,
+    Submit,
+
+    Count,
+};
+
+const char* GetFramePhaseName(FramePhase phase);
+
+/// CPU time and output of a single frame
+struct FrameStats {
+    std::array<std::chrono::nanoseconds, size_t(FramePhase::Count)> phases {};
+
+    /// Mask of the phases which ran, headless frames are never submitted
+    uint32_t phasesRun = 0;
+
+    int vertices = 0;
+    int indices = 0;
+    int drawCommands = 0;
+
+    uint64_t allocations = 0;
+};
+
+/// CPU time spent by the calling thread so far
+std::chrono::nanoseconds GetThreadCPUTime();
+
+/// Whether `operator new` is counted, which takes a build with `LLDB_IMGUI_COUNT_ALLOCATIONS`.
+/// ImGui's allocations are always counted.
+bool IsCountingAllocations();
+
+/// Number of heap allocations made by the calling thread so far, through `operator new` or ImGui
+uint64_t GetThreadAllocationCount();
+
+/// Makes ImGui's allocations show up in `GetThreadAllocationCount`, has to precede `ImGui::CreateContext`
+void InstallImGuiAllocationCounter();
+
+/// Collects the statistics of a fixed number of frames, and reports on them
+class Benchmark {
+public:
+    Benchmark(int frames, int warmupFrames);
+
+    /// Returns whether more frames are needed
+    bool Record(const FrameStats& stats);
+
+    void Report() const;
+
+private:
+    int _frames;
+    int _warmupFrames;
+
+    std::vector<FrameStats> _samples;
+};
+
+}
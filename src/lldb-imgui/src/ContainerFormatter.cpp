@@ -0,0 +1,610 @@
+#include "ContainerFormatter.h"
+
+#include "ValueCache.h"
+
+#include "lldb/API/LLDB.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <initializer_list>
+#include <limits>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Longer strings are cut short, like LLDB does by default
+static constexpr size_t kMaxStringLength = 1024;
+
+/// Granularity in which the nodes of hash tables are read
+static constexpr addr_t kPageSize = 4096;
+
+/// Pages kept around by a single `PageReader`
+static constexpr size_t kMaxPages = 256;
+
+namespace {
+
+enum class Kind {
+    Scalar,
+    String,
+    Other,
+};
+
+struct ElementType {
+    SBType type;
+    std::string name;
+
+    size_t size = 0;
+    Kind kind = Kind::Other;
+
+    // Of strings
+    bool isLibCxx = false;
+};
+
+}
+
+static std::string String(const char* str) {
+    return str ? std::string(str) : std::string();
+}
+
+template<typename T>
+static T Load(const uint8_t* data) {
+    T value;
+    memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+static bool ReadMemory(SBProcess& process, addr_t address, void* buffer, size_t size) {
+    if (size == 0) {
+        return true;
+    }
+
+    SBError error;
+    return process.ReadMemory(address, buffer, size, error) == size && error.Success();
+}
+
+/// Reads scattered nodes through the pages of memory they lie in. Nodes allocated one after the
+/// other tend to share pages, so walking a linked structure takes a read per page rather than per
+/// node, in whichever direction it goes.
+class PageReader {
+public:
+    explicit PageReader(SBProcess& process)
+    : _process(process)
+    {}
+
+    bool Read(addr_t address, void* buffer, size_t size) {
+        auto base = address & ~(kPageSize - 1);
+
+        if (address + size > base + kPageSize) {
+            return ReadMemory(_process, address, buffer, size);
+        }
+
+        auto it = _pages.find(base);
+        if (it == _pages.end()) {
+            if (_pages.size() >= kMaxPages) {
+                _pages.clear();
+            }
+
+            std::vector<uint8_t> page(kPageSize);
+
+            // Left empty if only part of the page is mapped, like at the end of the heap
+            if (!ReadMemory(_process, base, page.data(), page.size())) {
+                page.clear();
+            }
+            it = _pages.emplace(base, std::move(page)).first;
+        }
+
+        if (it->second.empty()) {
+            return ReadMemory(_process, address, buffer, size);
+        }
+
+        memcpy(buffer, it->second.data() + (address - base), size);
+        return true;
+    }
+
+private:
+    SBProcess& _process;
+
+    std::unordered_map<addr_t, std::vector<uint8_t>> _pages;
+};
+
+/// First of the member paths which exists, as an unsigned value
+static std::optional<uint64_t> ReadMember(SBValue& raw, std::initializer_list<const char*> paths) {
+    for (auto* path : paths) {
+        auto member = raw.GetValueForExpressionPath(path);
+
+        if (member.IsValid()) {
+            return member.GetValueAsUnsigned();
+        }
+    }
+    return std::nullopt;
+}
+
+/// Name of a standard library type without its namespace, or empty for other types
+static std::string_view StripNamespace(std::string_view name, bool& isLibCxx) {
+    isLibCxx = false;
+
+    for (auto prefix : { "std::__1::", "std::__2::" }) {
+        if (name.starts_with(prefix)) {
+            isLibCxx = true;
+            return name.substr(strlen(prefix));
+        }
+    }
+    for (auto prefix : { "std::__cxx11::", "std::" }) {
+        if (name.starts_with(prefix)) {
+            return name.substr(strlen(prefix));
+        }
+    }
+    return {};
+}
+
+static std::optional<std::string> FormatScalar(SBType type, const uint8_t* data) {
+    if (type.IsPointerType()) {
+        return std::format("0x{:016x}", Load<uint64_t>(data));
+    }
+
+    auto character = [](uint8_t c) {
+        if (c >= 0x20 && c < 0x7f) {
+            return std::format("'{}'", char(c));
+        }
+        return std::format("'\\x{:02x}'", c);
+    };
+
+    switch (type.GetBasicType()) {
+        case eBasicTypeBool:             return data[0] ? "true" : "false";
+        case eBasicTypeChar:             return character(data[0]);
+        case eBasicTypeSignedChar:       return character(data[0]);
+        case eBasicTypeUnsignedChar:     return character(data[0]);
+        case eBasicTypeShort:            return std::format("{}", Load<int16_t>(data));
+        case eBasicTypeUnsignedShort:    return std::format("{}", Load<uint16_t>(data));
+        case eBasicTypeInt:              return std::format("{}", Load<int32_t>(data));
+        case eBasicTypeUnsignedInt:      return std::format("{}", Load<uint32_t>(data));
+        case eBasicTypeLong:             return std::format("{}", Load<int64_t>(data));
+        case eBasicTypeUnsignedLong:     return std::format("{}", Load<uint64_t>(data));
+        case eBasicTypeLongLong:         return std::format("{}", Load<int64_t>(data));
+        case eBasicTypeUnsignedLongLong: return std::format("{}", Load<uint64_t>(data));
+        case eBasicTypeFloat:            return std::format("{}", Load<float>(data));
+        case eBasicTypeDouble:           return std::format("{}", Load<double>(data));
+
+        default: {
+            return std::nullopt;
+        }
+    }
+}
+
+static ElementType Classify(SBType type) {
+    auto canonical = type.GetCanonicalType();
+
+    ElementType element {
+        .type = type,
+        .name = String(type.GetDisplayTypeName()),
+        .size = canonical.GetByteSize(),
+    };
+
+    uint8_t zeroes[8] = {};
+
+    bool isScalar = canonical.IsPointerType() || (element.size <= sizeof(zeroes) && FormatScalar(canonical, zeroes));
+    if (isScalar) {
+        element.kind = Kind::Scalar;
+        return element;
+    }
+
+    auto typeName = String(canonical.GetName());
+
+    auto name = StripNamespace(typeName, element.isLibCxx);
+    if (name.starts_with("basic_string<char,")) {
+        element.kind = Kind::String;
+    }
+
+    return element;
+}
+
+/// Alignment of a type, from the alignment of its members
+static size_t AlignmentOf(SBType type, int depth = 0) {
+    auto canonical = type.GetCanonicalType();
+
+    if (canonical.IsPointerType() || canonical.IsReferenceType()) {
+        return 8;
+    }
+    if (canonical.IsArrayType()) {
+        return AlignmentOf(canonical.GetArrayElementType(), depth);
+    }
+    if (canonical.GetBasicType() != eBasicTypeInvalid) {
+        return std::clamp<size_t>(canonical.GetByteSize(), 1, 16);
+    }
+
+    // Whatever holds this many nested members almost certainly holds a pointer too
+    if (depth > 8) {
+        return 8;
+    }
+
+    size_t alignment = 1;
+
+    for (uint32_t i = 0; i < canonical.GetNumberOfDirectBaseClasses(); i++) {
+        alignment = std::max(alignment, AlignmentOf(canonical.GetDirectBaseClassAtIndex(i).GetType(), depth + 1));
+    }
+    for (uint32_t i = 0; i < canonical.GetNumberOfFields(); i++) {
+        alignment = std::max(alignment, AlignmentOf(canonical.GetFieldAtIndex(i).GetType(), depth + 1));
+    }
+
+    return alignment;
+}
+
+static size_t AlignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static std::string Quote(std::string_view string, bool isTruncated) {
+    std::string result = "\"";
+
+    for (char c : string) {
+        switch (c) {
+            case '"':  result += "\\\""; break;
+            case '\\': result += "\\\\"; break;
+            case '\n': result += "\\n";  break;
+            case '\r': result += "\\r";  break;
+            case '\t': result += "\\t";  break;
+
+            default: {
+                if (uint8_t(c) < 0x20) {
+                    result += std::format("\\x{:02x}", uint8_t(c));
+                } else {
+                    result += c;
+                }
+                break;
+            }
+        }
+    }
+
+    result += "\"";
+
+    if (isTruncated) {
+        result += "...";
+    }
+    return result;
+}
+
+/// Summary of a `std::string` from its representation at `address`
+static std::optional<std::string> DecodeString(SBProcess& process, const uint8_t* bytes, addr_t address, bool isLibCxx) {
+    uint64_t size = 0;
+    addr_t data = 0;
+
+    if (isLibCxx) {
+        // Short strings are flagged by the lowest bit of the first byte, and start right after it
+        if ((bytes[0] & 1) == 0) {
+            size = bytes[0] >> 1;
+
+            if (size > 22) {
+                return std::nullopt;
+            }
+            return Quote(std::string_view(reinterpret_cast<const char*>(bytes + 1), size), false);
+        }
+
+        size = Load<uint64_t>(bytes + 8);
+        data = Load<uint64_t>(bytes + 16);
+    } else {
+        data = Load<uint64_t>(bytes);
+        size = Load<uint64_t>(bytes + 8);
+
+        // Short strings point at their local buffer
+        if (data == address + 16) {
+            if (size > 15) {
+                return std::nullopt;
+            }
+            return Quote(std::string_view(reinterpret_cast<const char*>(bytes + 16), size), false);
+        }
+    }
+
+    std::string string(std::min<uint64_t>(size, kMaxStringLength), '\0');
+
+    if (!ReadMemory(process, data, string.data(), string.size())) {
+        return std::nullopt;
+    }
+    return Quote(string, size > kMaxStringLength);
+}
+
+/// Decodes scalars and strings, and asks LLDB for everything else
+static ValueInfo DecodeElement(SBValue& container, ElementType& element, const uint8_t* bytes, addr_t address, const std::string& name) {
+    auto process = container.GetProcess();
+
+    switch (element.kind) {
+        case Kind::Scalar: {
+            if (auto value = FormatScalar(element.type.GetCanonicalType(), bytes)) {
+                return ValueInfo {
+                    .isValid = true,
+                    .type = element.name,
+                    .value = std::move(*value),
+                };
+            }
+            break;
+        }
+        case Kind::String: {
+            if (auto summary = DecodeString(process, bytes, address, element.isLibCxx)) {
+                return ValueInfo {
+                    .isValid = true,
+                    .type = element.name,
+                    .summary = std::move(*summary),
+                };
+            }
+            break;
+        }
+        case Kind::Other: {
+            break;
+        }
+    }
+
+    auto value = container.CreateValueFromAddress(name.c_str(), address, element.type);
+    return SnapshotValue(value);
+}
+
+std::optional<ContainerFormatter::Page> ContainerFormatter::Read(SBValue& container, uint32_t first, uint32_t count) {
+    auto process = container.GetProcess();
+
+    if (process.GetAddressByteSize() != 8 || process.GetByteOrder() != eByteOrderLittle) {
+        return std::nullopt;
+    }
+
+    auto raw = container.GetNonSyntheticValue();
+
+    auto typeName = String(raw.GetType().GetCanonicalType().GetName());
+
+    bool isLibCxx = false;
+    auto name = StripNamespace(typeName, isLibCxx);
+
+    if (name.starts_with("vector<") && !name.starts_with("vector<bool,")) {
+        return ReadVector(container, raw, isLibCxx, first, count);
+    }
+    if (name.starts_with("deque<")) {
+        return ReadDeque(container, raw, isLibCxx, first, count);
+    }
+    if (name.starts_with("unordered_map<")) {
+        return ReadUnorderedMap(container, raw, isLibCxx, first, count);
+    }
+    return std::nullopt;
+}
+
+std::optional<ContainerFormatter::Page> ContainerFormatter::ReadVector(SBValue& container, SBValue& raw, bool isLibCxx, uint32_t first, uint32_t count) {
+    auto process = container.GetProcess();
+
+    auto begin = isLibCxx ? ReadMember(raw, { ".__begin_" }) : ReadMember(raw, { "._M_impl._M_start" });
+    auto end = isLibCxx ? ReadMember(raw, { ".__end_" }) : ReadMember(raw, { "._M_impl._M_finish" });
+
+    auto element = Classify(raw.GetType().GetCanonicalType().GetTemplateArgumentType(0));
+
+    if (!begin || !end || *end < *begin || element.size == 0 || (*end - *begin) % element.size) {
+        return std::nullopt;
+    }
+
+    Page page;
+    page.numChildren = std::min<uint64_t>((*end - *begin) / element.size, std::numeric_limits<uint32_t>::max());
+
+    count = std::min(count, page.numChildren - std::min(first, page.numChildren));
+
+    // The whole page in one go
+    std::vector<uint8_t> bytes(count * element.size);
+
+    auto address = *begin + uint64_t(first) * element.size;
+    if (!ReadMemory(process, address, bytes.data(), bytes.size())) {
+        return std::nullopt;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        auto name = std::format("[{}]", first + i);
+        auto info = DecodeElement(container, element, bytes.data() + i * element.size, address + i * element.size, name);
+
+        page.elements.push_back(Element {
+            .name = std::move(name),
+            .info = std::move(info),
+        });
+    }
+
+    return page;
+}
+
+std::optional<ContainerFormatter::Page> ContainerFormatter::ReadDeque(SBValue& container, SBValue& raw, bool isLibCxx, uint32_t first, uint32_t count) {
+    auto process = container.GetProcess();
+
+    auto element = Classify(raw.GetType().GetCanonicalType().GetTemplateArgumentType(0));
+    if (element.size == 0) {
+        return std::nullopt;
+    }
+
+    // Elements live in blocks of a fixed number of them, found through an array of pointers. The
+    // first element is `start` elements into the first block.
+    uint64_t blockSize = 0;
+    uint64_t start = 0;
+    uint64_t size = 0;
+
+    std::optional<uint64_t> map;
+
+    if (isLibCxx) {
+        blockSize = element.size < 256 ? 4096 / element.size : 16;
+
+        map = ReadMember(raw, { ".__map_.__begin_" });
+
+        auto startMember = ReadMember(raw, { ".__start_" });
+        auto sizeMember = ReadMember(raw, { ".__size_.__value_", ".__size_" });
+
+        if (!startMember || !sizeMember) {
+            return std::nullopt;
+        }
+        start = *startMember;
+        size = *sizeMember;
+    } else {
+        blockSize = element.size < 512 ? 512 / element.size : 1;
+
+        map = ReadMember(raw, { "._M_impl._M_start._M_node" });
+
+        auto startCur = ReadMember(raw, { "._M_impl._M_start._M_cur" });
+        auto startFirst = ReadMember(raw, { "._M_impl._M_start._M_first" });
+        auto finishCur = ReadMember(raw, { "._M_impl._M_finish._M_cur" });
+        auto finishFirst = ReadMember(raw, { "._M_impl._M_finish._M_first" });
+        auto finishNode = ReadMember(raw, { "._M_impl._M_finish._M_node" });
+
+        if (!map || !startCur || !startFirst || !finishCur || !finishFirst || !finishNode) {
+            return std::nullopt;
+        }
+        if (*startCur < *startFirst || *finishCur < *finishFirst || *finishNode < *map) {
+            return std::nullopt;
+        }
+
+        start = (*startCur - *startFirst) / element.size;
+
+        auto end = (*finishNode - *map) / sizeof(addr_t) * blockSize + (*finishCur - *finishFirst) / element.size;
+        if (end < start) {
+            return std::nullopt;
+        }
+        size = end - start;
+    }
+
+    if (!map) {
+        return std::nullopt;
+    }
+
+    Page page;
+    page.numChildren = std::min<uint64_t>(size, std::numeric_limits<uint32_t>::max());
+
+    count = std::min(count, page.numChildren - std::min(first, page.numChildren));
+    if (count == 0) {
+        return page;
+    }
+
+    // Pointers to the blocks the page spans in one go, then a read per block
+    auto firstIndex = start + first;
+    auto firstBlock = firstIndex / blockSize;
+
+    std::vector<addr_t> blocks((firstIndex + count - 1) / blockSize - firstBlock + 1);
+
+    if (!ReadMemory(process, *map + firstBlock * sizeof(addr_t), blocks.data(), blocks.size() * sizeof(addr_t))) {
+        return std::nullopt;
+    }
+
+    std::vector<uint8_t> bytes;
+
+    for (uint32_t i = 0; i < count;) {
+        auto index = firstIndex + i;
+        auto offset = index % blockSize;
+
+        uint32_t run = std::min<uint64_t>(blockSize - offset, count - i);
+        auto address = blocks[index / blockSize - firstBlock] + offset * element.size;
+
+        bytes.resize(run * element.size);
+
+        if (!ReadMemory(process, address, bytes.data(), bytes.size())) {
+            return std::nullopt;
+        }
+
+        for (uint32_t j = 0; j < run; j++) {
+            auto name = std::format("[{}]", first + i + j);
+            auto info = DecodeElement(container, element, bytes.data() + j * element.size, address + j * element.size, name);
+
+            page.elements.push_back(Element {
+                .name = std::move(name),
+                .info = std::move(info),
+            });
+        }
+
+        i += run;
+    }
+
+    return page;
+}
+
+std::optional<ContainerFormatter::Page> ContainerFormatter::ReadUnorderedMap(SBValue& container, SBValue& raw, bool isLibCxx, uint32_t first, uint32_t count) {
+    auto process = container.GetProcess();
+
+    std::optional<uint64_t> size;
+    std::optional<uint64_t> head;
+
+    if (isLibCxx) {
+        size = ReadMember(raw, { ".__table_.__p2_.__value_", ".__table_.__size_" });
+        head = ReadMember(raw, { ".__table_.__p1_.__value_.__next_", ".__table_.__first_node_.__next_" });
+    } else {
+        size = ReadMember(raw, { "._M_h._M_element_count" });
+        head = ReadMember(raw, { "._M_h._M_before_begin._M_nxt" });
+    }
+
+    auto type = raw.GetType().GetCanonicalType();
+
+    auto key = Classify(type.GetTemplateArgumentType(0));
+    auto value = Classify(type.GetTemplateArgumentType(1));
+
+    if (!size || !head || key.size == 0 || value.size == 0) {
+        return std::nullopt;
+    }
+
+    Page page;
+    page.numChildren = std::min<uint64_t>(*size, std::numeric_limits<uint32_t>::max());
+
+    count = std::min(count, page.numChildren - std::min(first, page.numChildren));
+    if (count == 0) {
+        return page;
+    }
+
+    // Nodes start with the pointer to the next one, libc++ also stores the hash before the value
+    auto alignment = std::max(AlignmentOf(key.type), AlignmentOf(value.type));
+
+    auto valueOffset = AlignUp(isLibCxx ? 16 : 8, alignment);
+    auto secondOffset = AlignUp(key.size, AlignmentOf(value.type));
+    auto nodeSize = valueOffset + AlignUp(secondOffset + value.size, alignment);
+
+    // Nodes walked are remembered for the following pages
+    auto& chain = _chains[raw.GetLoadAddress()];
+    if (chain.empty()) {
+        chain.push_back(*head);
+    }
+
+    PageReader reader(process);
+    std::vector<uint8_t> node(nodeSize);
+
+    auto pairName = std::format("std::pair<const {}, {}>", key.name, value.name);
+
+    for (uint32_t i = std::min<uint32_t>(first, chain.size() - 1); i < first + count; i++) {
+        if (!reader.Read(chain[i], node.data(), node.size())) {
+            return std::nullopt;
+        }
+
+        if (i + 1 == chain.size() && i + 1 < page.numChildren) {
+            auto next = Load<addr_t>(node.data());
+
+            if (next == 0) {
+                return std::nullopt;
+            }
+            chain.push_back(next);
+        }
+
+        // Only walked through to reach the page
+        if (i < first) {
+            continue;
+        }
+
+        auto address = chain[i] + valueOffset;
+        auto name = std::format("[{}]", i);
+
+        auto firstInfo = DecodeElement(container, key, node.data() + valueOffset, address, "first");
+        auto secondInfo = DecodeElement(container, value, node.data() + valueOffset + secondOffset, address + secondOffset, "second");
+
+        auto describe = [](const ValueInfo& info) {
+            if (!info.isValid) {
+                return std::string("<error>");
+            }
+            return info.value.empty() ? info.summary : info.value;
+        };
+
+        page.elements.push_back(Element {
+            .name = std::move(name),
+            .info = ValueInfo {
+                .isValid = true,
+                .type = pairName,
+                .summary = std::format("(first = {}, second = {})", describe(firstInfo), describe(secondInfo)),
+                .numChildren = 2,
+            },
+        });
+    }
+
+    return page;
+}
+
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "lldb-imgui/Values.h"
+
+#include "lldb/API/SBValue.h"
+
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Reads the elements of standard library containers with a few bulk memory reads, instead of the
+/// many round trips per element LLDB's synthetic children take.
+///
+/// Knows `std::vector`, `std::deque` and `std::unordered_map` of libc++ and libstdc++ on 64 bit
+/// little endian targets. Scalars and strings are decoded in process, other elements are handed to
+/// LLDB's formatters by address.
+///
+/// Only to be used on the query thread, and only for a single stop of the process.
+class ContainerFormatter {
+public:
+    struct Element {
+        std::string name;
+        ValueInfo info;
+    };
+
+    struct Page {
+        uint32_t numChildren = 0;
+        std::vector<Element> elements;
+    };
+
+    /// Nullopt if the container's layout is unknown, and LLDB's formatters should be used instead
+    std::optional<Page> Read(SBValue& container, uint32_t first, uint32_t count);
+
+private:
+    std::optional<Page> ReadVector(SBValue& container, SBValue& raw, bool isLibCxx, uint32_t first, uint32_t count);
+    std::optional<Page> ReadDeque(SBValue& container, SBValue& raw, bool isLibCxx, uint32_t first, uint32_t count);
+    std::optional<Page> ReadUnorderedMap(SBValue& container, SBValue& raw, bool isLibCxx, uint32_t first, uint32_t count);
+
+    // Nodes of hash tables walked so far, by the address of the table
+    std::unordered_map<lldb::addr_t, std::vector<lldb::addr_t>> _chains;
+};
+
+}
@@ -0,0 +1,123 @@
+#include "CoreMemory.h"
+
+#include "lldb-imgui/Memory.h"
+
+#include "spdlog/spdlog.h"
+
+#if !defined(__APPLE__)
+#include "ElfFile.h"
+#endif
+
+#include <algorithm>
+#include <format>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+namespace lldb::imgui {
+
+struct CoreMemory::Core {
+#if !defined(__APPLE__)
+    // Owns the mapping the segments are pointing into
+    std::optional<ElfFile> file;
+#endif
+
+    struct Segment {
+        uint64_t address;
+        std::span<const std::byte> data;
+    };
+
+    // Ordered by address
+    std::vector<Segment> segments;
+};
+
+static CoreMemory* g_memory = nullptr;
+
+std::span<const std::byte> MapCoreMemory(SBDebugger& debugger, uint64_t address, size_t size) {
+    return g_memory ? g_memory->Map(debugger, address, size) : std::span<const std::byte>();
+}
+
+CoreMemory::CoreMemory() {
+    g_memory = this;
+}
+
+CoreMemory::~CoreMemory() {
+    g_memory = nullptr;
+}
+
+bool CoreMemory::Add(SBDebugger& debugger, const std::filesystem::path& path, std::string& error) {
+#if defined(__APPLE__)
+    error = std::format("'{}' can't be mapped, only ELF cores are supported", path.string());
+    return false;
+#else
+    auto file = ElfFile::Open(path, error);
+    if (!file) {
+        return false;
+    }
+    if (file->Header().e_type != ET_CORE) {
+        error = std::format("'{}' is not a core file", path.string());
+        return false;
+    }
+
+    auto core = std::make_unique<Core>();
+
+    uint64_t total = 0;
+
+    for (const auto& segment : file->Segments()) {
+        if (segment.p_type != PT_LOAD) {
+            continue;
+        }
+
+        // Segments the core doesn't store, like the code of mapped files, are left to LLDB
+        auto data = file->SegmentData(segment);
+        if (data.empty()) {
+            continue;
+        }
+
+        core->segments.push_back(Core::Segment {
+            .address = segment.p_vaddr,
+            .data = data,
+        });
+        total += data.size();
+    }
+
+    std::ranges::sort(core->segments, {}, &Core::Segment::address);
+
+    spdlog::info("Mapped {} segments, {} MiB of memory from core '{}'",
+        core->segments.size(), total / (1024 * 1024), path.string());
+
+    core->file = std::move(file);
+
+    std::unique_lock lock(_mutex);
+    _cores[debugger.GetID()] = std::move(core);
+
+    return true;
+#endif
+}
+
+std::span<const std::byte> CoreMemory::Map(SBDebugger& debugger, uint64_t address, size_t size) {
+    std::shared_lock lock(_mutex);
+
+    auto it = _cores.find(debugger.GetID());
+    if (it == _cores.end()) {
+        return {};
+    }
+
+    const auto& segments = it->second->segments;
+
+    // Last segment starting at or before `address`
+    auto segment = std::ranges::upper_bound(segments, address, {}, &Core::Segment::address);
+    if (segment == segments.begin()) {
+        return {};
+    }
+    segment--;
+
+    auto offset = address - segment->address;
+
+    if (offset > segment->data.size() || size > segment->data.size() - offset) {
+        return {};
+    }
+    return segment->data.subspan(offset, size);
+}
+
+}
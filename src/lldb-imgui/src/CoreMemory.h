@@ -0,0 +1,39 @@
+#pragma once
+
+#include "lldb/API/SBDebugger.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+
+namespace lldb::imgui {
+
+/// Serves the memory of processes loaded from core files straight from a read-only mapping of the
+/// core, instead of going through LLDB for each read. Only the pages of the core which are looked
+/// at are ever read from disk.
+class CoreMemory {
+public:
+    CoreMemory();
+    ~CoreMemory();
+
+    CoreMemory(const CoreMemory&) = delete;
+
+    /// Maps the core the process of `debugger` was loaded from. Fails for cores which can't be
+    /// mapped, their memory is still read through LLDB.
+    bool Add(SBDebugger& debugger, const std::filesystem::path& path, std::string& error);
+
+    /// Bytes stored in the core at `address`, empty unless the core holds the whole range
+    std::span<const std::byte> Map(SBDebugger& debugger, uint64_t address, size_t size);
+
+private:
+    struct Core;
+
+    std::shared_mutex _mutex;
+    std::unordered_map<lldb::user_id_t, std::unique_ptr<Core>> _cores;
+};
+
+}
@@ -0,0 +1,617 @@
+#include "DrawStream.h"
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifndef MSG_NOSIGNAL
+// SO_NOSIGPIPE is set on the socket instead
+#define MSG_NOSIGNAL 0
+#endif
+
+namespace lldb::imgui::stream {
+
+namespace {
+
+struct FrameHeader {
+    ImVec2 displayPos;
+    ImVec2 displaySize;
+    ImVec2 framebufferScale;
+
+    ImTextureID fontTexture;
+
+    uint32_t numLists;
+    uint32_t reserved;
+};
+
+struct ListHeader {
+    uint32_t numCommands;
+    uint32_t numVertices;
+    uint32_t numIndices;
+};
+
+/// Free of padding, so equal commands serialize to equal bytes
+struct Command {
+    ImVec4 clipRect;
+    ImTextureID texture;
+
+    uint32_t vertexOffset;
+    uint32_t indexOffset;
+    uint32_t elementCount;
+    uint32_t reserved;
+};
+
+enum class ListEncoding : uint8_t {
+    /// Identical to the list at the same position in the previous frame
+    Same,
+    Raw,
+    /// Runs of bytes XOR'd with the list at the same position in the previous frame
+    Delta,
+};
+
+/// Bounds checked reads out of a payload
+class Cursor {
+public:
+    explicit Cursor(std::span<const uint8_t> data)
+    : _data(data)
+    {}
+
+    template<typename T>
+    bool Read(T& value) {
+        auto bytes = Take(sizeof(T));
+        if (bytes.size() != sizeof(T)) {
+            return false;
+        }
+
+        memcpy(&value, bytes.data(), sizeof(T));
+        return true;
+    }
+
+    std::optional<uint64_t> Varint() {
+        uint64_t value = 0;
+
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = 0;
+            if (!Read(byte)) {
+                return std::nullopt;
+            }
+
+            value |= uint64_t(byte & 0x7f) << shift;
+
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        return std::nullopt;
+    }
+
+    /// Empty if there are fewer than `size` bytes left
+    std::span<const uint8_t> Take(size_t size) {
+        if (size > _data.size() - _offset) {
+            _offset = _data.size();
+            return {};
+        }
+
+        auto bytes = _data.subspan(_offset, size);
+        _offset += size;
+        return bytes;
+    }
+
+private:
+    std::span<const uint8_t> _data;
+    size_t _offset = 0;
+};
+
+}
+
+/// Runs of unchanged bytes at least this long end a run of changed ones
+static constexpr size_t kMinUnchangedRun = 8;
+
+template<typename T>
+static void Append(std::vector<uint8_t>& out, const T* data, size_t count = 1) {
+    auto* bytes = reinterpret_cast<const uint8_t*>(data);
+    out.insert(out.end(), bytes, bytes + count * sizeof(T));
+}
+
+static void AppendVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(uint8_t(value) | 0x80);
+        value >>= 7;
+    }
+    out.push_back(uint8_t(value));
+}
+
+static void Serialize(const ImDrawList* list, std::vector<uint8_t>& out) {
+    out.clear();
+    out.resize(sizeof(ListHeader));
+
+    ListHeader header {
+        .numCommands = 0,
+        .numVertices = uint32_t(list->VtxBuffer.Size),
+        .numIndices = uint32_t(list->IdxBuffer.Size),
+    };
+
+    for (const auto& command : list->CmdBuffer) {
+        // Callbacks point into this process
+        if (command.UserCallback) {
+            continue;
+        }
+
+        Command serialized {
+            .clipRect = command.ClipRect,
+            .texture = command.TextureId,
+            .vertexOffset = command.VtxOffset,
+            .indexOffset = command.IdxOffset,
+            .elementCount = command.ElemCount,
+            .reserved = 0,
+        };
+        Append(out, &serialized);
+
+        header.numCommands++;
+    }
+
+    memcpy(out.data(), &header, sizeof(header));
+
+    Append(out, list->VtxBuffer.Data, list->VtxBuffer.Size);
+    Append(out, list->IdxBuffer.Data, list->IdxBuffer.Size);
+}
+
+/// Encodes `current` as alternating runs of unchanged and changed bytes, the latter XOR'd with `previous`
+static void EncodeDelta(std::span<const uint8_t> previous, std::span<const uint8_t> current, std::vector<uint8_t>& out) {
+    auto diff = [&](size_t i) -> uint8_t {
+        return current[i] ^ (i < previous.size() ? previous[i] : 0);
+    };
+
+    size_t i = 0;
+
+    while (i < current.size()) {
+        size_t unchanged = 0;
+        while (i + unchanged < current.size() && diff(i + unchanged) == 0) {
+            unchanged++;
+        }
+
+        size_t begin = i + unchanged;
+        size_t end = begin;
+
+        while (end < current.size()) {
+            if (diff(end) != 0) {
+                end++;
+                continue;
+            }
+
+            size_t run = 0;
+            while (end + run < current.size() && run < kMinUnchangedRun && diff(end + run) == 0) {
+                run++;
+            }
+
+            if (run == kMinUnchangedRun || end + run == current.size()) {
+                break;
+            }
+            end += run;
+        }
+
+        AppendVarint(out, unchanged);
+        AppendVarint(out, end - begin);
+
+        for (size_t j = begin; j < end; j++) {
+            out.push_back(diff(j));
+        }
+
+        i = end;
+    }
+}
+
+static bool DecodeDelta(std::span<const uint8_t> previous, Cursor& cursor, size_t size, std::vector<uint8_t>& out) {
+    out.resize(size);
+
+    auto original = [&](size_t i) -> uint8_t {
+        return i < previous.size() ? previous[i] : 0;
+    };
+
+    size_t i = 0;
+
+    while (i < size) {
+        auto unchanged = cursor.Varint();
+        auto changed = cursor.Varint();
+
+        if (!unchanged || !changed || (*unchanged == 0 && *changed == 0)) {
+            return false;
+        }
+        if (*unchanged > size - i || *changed > size - i - *unchanged) {
+            return false;
+        }
+
+        for (auto end = i + *unchanged; i < end; i++) {
+            out[i] = original(i);
+        }
+
+        auto bytes = cursor.Take(*changed);
+        if (bytes.size() != *changed) {
+            return false;
+        }
+
+        for (auto byte : bytes) {
+            out[i] = byte ^ original(i);
+            i++;
+        }
+    }
+    return true;
+}
+
+static void ConfigureSocket(int fd, bool isConnection) {
+    int enable = 1;
+
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+    // Frames are sent whole, and input is tiny, neither should wait for more to come
+    if (isConnection) {
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+
+#ifdef SO_NOSIGPIPE
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+}
+
+void AppendMessage(std::vector<uint8_t>& out, MessageType type, std::span<const uint8_t> payload) {
+    auto size = uint32_t(payload.size());
+
+    Append(out, &size);
+    Append(out, &type);
+    out.insert(out.end(), payload.begin(), payload.end());
+}
+
+void MessageReader::Receive(SocketRelay& relay) {
+    // Messages handed out before are done with
+    _buffer.erase(_buffer.begin(), _buffer.begin() + _offset);
+    _offset = 0;
+
+    auto size = _buffer.size();
+
+    _buffer.resize(size + relay.Available());
+    _buffer.resize(size + relay.Read(std::span(_buffer).subspan(size)));
+}
+
+std::optional<MessageReader::Message> MessageReader::Next() {
+    constexpr size_t kHeaderSize = sizeof(uint32_t) + sizeof(MessageType);
+
+    if (_isCorrupt || _buffer.size() - _offset < kHeaderSize) {
+        return std::nullopt;
+    }
+
+    uint32_t size = 0;
+    memcpy(&size, &_buffer[_offset], sizeof(size));
+
+    if (size > kMaxMessageSize) {
+        _isCorrupt = true;
+        return std::nullopt;
+    }
+    if (_buffer.size() - _offset < kHeaderSize + size) {
+        return std::nullopt;
+    }
+
+    Message message {
+        .type = MessageType(_buffer[_offset + sizeof(uint32_t)]),
+        .payload = std::span(_buffer).subspan(_offset + kHeaderSize, size),
+    };
+    _offset += kHeaderSize + size;
+
+    return message;
+}
+
+bool DrawStreamEncoder::Encode(const ImDrawData* drawData, ImTextureID fontTexture, std::vector<uint8_t>& payload) {
+    payload.clear();
+
+    FrameHeader header {
+        .displayPos = drawData->DisplayPos,
+        .displaySize = drawData->DisplaySize,
+        .framebufferScale = drawData->FramebufferScale,
+        .fontTexture = fontTexture,
+        .numLists = uint32_t(drawData->CmdListsCount),
+        .reserved = 0,
+    };
+    Append(payload, &header);
+
+    bool isChanged = !_header || !std::ranges::equal(*_header, payload);
+
+    if (isChanged) {
+        _header = payload;
+    }
+
+    _lists.resize(drawData->CmdListsCount);
+
+    for (int i = 0; i < drawData->CmdListsCount; i++) {
+        auto& previous = _lists[i];
+
+        Serialize(drawData->CmdLists[i], _scratch);
+
+        if (_scratch == previous) {
+            payload.push_back(uint8_t(ListEncoding::Same));
+            continue;
+        }
+
+        isChanged = true;
+
+        auto start = payload.size();
+
+        // Only worth it if the list is mostly the same as before
+        payload.push_back(uint8_t(ListEncoding::Delta));
+        AppendVarint(payload, _scratch.size());
+        EncodeDelta(previous, _scratch, payload);
+
+        if (previous.empty() || payload.size() - start > _scratch.size()) {
+            payload.resize(start);
+
+            payload.push_back(uint8_t(ListEncoding::Raw));
+            AppendVarint(payload, _scratch.size());
+            payload.insert(payload.end(), _scratch.begin(), _scratch.end());
+        }
+
+        std::swap(previous, _scratch);
+    }
+
+    return isChanged;
+}
+
+void DrawStreamEncoder::Reset() {
+    _header.reset();
+    _lists.clear();
+}
+
+DrawStreamDecoder::~DrawStreamDecoder() {
+    for (auto* list : _drawLists) {
+        IM_DELETE(list);
+    }
+}
+
+bool DrawStreamDecoder::Decode(std::span<const uint8_t> payload, ImTextureID fontTexture) {
+    Cursor cursor(payload);
+
+    FrameHeader header;
+    if (!cursor.Read(header)) {
+        return false;
+    }
+
+    // Each list takes at least a byte
+    if (header.numLists > payload.size()) {
+        return false;
+    }
+
+    auto numPrevious = _lists.size();
+
+    _lists.resize(header.numLists);
+
+    while (_drawLists.size() < header.numLists) {
+        _drawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+    }
+    while (_drawLists.size() > header.numLists) {
+        IM_DELETE(_drawLists.back());
+        _drawLists.pop_back();
+    }
+
+    for (size_t i = 0; i < header.numLists; i++) {
+        uint8_t encoding = 0;
+        if (!cursor.Read(encoding)) {
+            return false;
+        }
+
+        if (ListEncoding(encoding) == ListEncoding::Same) {
+            if (i >= numPrevious) {
+                return false;
+            }
+            continue;
+        }
+
+        auto size = cursor.Varint();
+        if (!size || *size > kMaxMessageSize) {
+            return false;
+        }
+
+        if (ListEncoding(encoding) == ListEncoding::Raw) {
+            auto bytes = cursor.Take(*size);
+            if (bytes.size() != *size) {
+                return false;
+            }
+
+            _lists[i].assign(bytes.begin(), bytes.end());
+        } else if (ListEncoding(encoding) == ListEncoding::Delta) {
+            auto previous = i < numPrevious ? std::span<const uint8_t>(_lists[i]) : std::span<const uint8_t>();
+
+            if (!DecodeDelta(previous, cursor, *size, _scratch)) {
+                return false;
+            }
+
+            std::swap(_lists[i], _scratch);
+        } else {
+            return false;
+        }
+
+        if (!Build(_drawLists[i], _lists[i], header.fontTexture, fontTexture)) {
+            return false;
+        }
+    }
+
+    _hasFrame = true;
+    return true;
+}
+
+bool DrawStreamDecoder::Build(ImDrawList* list, std::span<const uint8_t> bytes, ImTextureID streamFontTexture, ImTextureID fontTexture) {
+    Cursor cursor(bytes);
+
+    ListHeader header;
+    if (!cursor.Read(header)) {
+        return false;
+    }
+
+    auto commands = cursor.Take(size_t(header.numCommands) * sizeof(Command));
+    auto vertices = cursor.Take(size_t(header.numVertices) * sizeof(ImDrawVert));
+    auto indices = cursor.Take(size_t(header.numIndices) * sizeof(ImDrawIdx));
+
+    if (commands.size() != header.numCommands * sizeof(Command)) {
+        return false;
+    }
+    if (vertices.size() != header.numVertices * sizeof(ImDrawVert) || indices.size() != header.numIndices * sizeof(ImDrawIdx)) {
+        return false;
+    }
+
+    list->CmdBuffer.resize(0);
+    list->VtxBuffer.resize(int(header.numVertices));
+    list->IdxBuffer.resize(int(header.numIndices));
+
+    memcpy(list->VtxBuffer.Data, vertices.data(), vertices.size());
+    memcpy(list->IdxBuffer.Data, indices.data(), indices.size());
+
+    for (uint32_t i = 0; i < header.numCommands; i++) {
+        Command serialized;
+        memcpy(&serialized, commands.data() + i * sizeof(Command), sizeof(Command));
+
+        if (serialized.indexOffset > header.numIndices || serialized.elementCount > header.numIndices - serialized.indexOffset) {
+            return false;
+        }
+
+        // The GPU would read past the vertices
+        auto* first = list->IdxBuffer.Data + serialized.indexOffset;
+        auto* last = first + serialized.elementCount;
+
+        if (first != last && uint64_t(serialized.vertexOffset) + *std::max_element(first, last) >= header.numVertices) {
+            return false;
+        }
+
+        // The font atlas is the only texture both sides have
+        if (serialized.texture != streamFontTexture) {
+            continue;
+        }
+
+        ImDrawCmd command;
+        command.ClipRect = serialized.clipRect;
+        command.TextureId = fontTexture;
+        command.VtxOffset = serialized.vertexOffset;
+        command.IdxOffset = serialized.indexOffset;
+        command.ElemCount = serialized.elementCount;
+
+        list->CmdBuffer.push_back(command);
+    }
+    return true;
+}
+
+void DrawStreamDecoder::EndFrame(ImDrawData* drawData) {
+    if (!_hasFrame) {
+        return;
+    }
+
+    for (size_t i = 0; i < _drawLists.size(); i++) {
+        auto* list = _drawLists[i];
+
+        drawData->CmdLists.insert(drawData->CmdLists.begin() + i, list);
+        drawData->CmdListsCount++;
+
+        drawData->TotalVtxCount += list->VtxBuffer.Size;
+        drawData->TotalIdxCount += list->IdxBuffer.Size;
+    }
+}
+
+int OpenSocket(std::string_view address, bool isServer, std::string& error) {
+    std::string host = isServer ? "127.0.0.1" : "localhost";
+    std::string port(address);
+
+    if (auto colon = address.rfind(':'); colon != std::string_view::npos) {
+        host = address.substr(0, colon);
+        port = address.substr(colon + 1);
+    }
+
+    addrinfo hints {
+        .ai_flags = isServer ? AI_PASSIVE : 0,
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+    };
+
+    addrinfo* results = nullptr;
+
+    if (int result = getaddrinfo(host.c_str(), port.c_str(), &hints, &results); result != 0) {
+        error = gai_strerror(result);
+        return -1;
+    }
+
+    int fd = -1;
+
+    for (auto* info = results; info; info = info->ai_next) {
+        fd = socket(info->ai_family, info->ai_socktype, info->ai_protocol);
+        if (fd == -1) {
+            error = strerror(errno);
+            continue;
+        }
+
+        int enable = 1;
+
+        if (isServer) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+            if (bind(fd, info->ai_addr, info->ai_addrlen) == 0 && listen(fd, 1) == 0) {
+                break;
+            }
+        } else if (connect(fd, info->ai_addr, info->ai_addrlen) == 0) {
+            break;
+        }
+
+        error = strerror(errno);
+
+        close(fd);
+        fd = -1;
+    }
+
+    freeaddrinfo(results);
+
+    if (fd != -1) {
+        ConfigureSocket(fd, !isServer);
+    }
+    return fd;
+}
+
+int AcceptSocket(int listener) {
+    int fd = accept(listener, nullptr, nullptr);
+
+    if (fd != -1) {
+        ConfigureSocket(fd, true);
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    }
+    return fd;
+}
+
+bool SendAll(int socket, std::span<const uint8_t> data) {
+    while (!data.empty()) {
+        auto sent = send(socket, data.data(), data.size(), MSG_NOSIGNAL);
+
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent <= 0) {
+            return false;
+        }
+
+        data = data.subspan(sent);
+    }
+    return true;
+}
+
+ptrdiff_t SendSome(int socket, std::span<const uint8_t> data) {
+    while (true) {
+        auto sent = send(socket, data.data(), data.size(), MSG_NOSIGNAL);
+
+        if (sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        return sent < 0 ? -1 : sent;
+    }
+}
+
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+#include "SocketRelay.h"
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// Wire format of the remote rendering stream, between an app serving its UI with `--serve`, and a
+/// viewer started with `--connect`. Both ends are expected to be the same build, so ImGui structures
+/// are sent as they are.
+///
+/// Every message is a 32 bit payload size, a `MessageType`, and the payload. The server greets with
+/// a `Hello`, then sends a `Frame` whenever its draw data changed. The viewer sends `Input` whenever
+/// it has some, or its display changed.
+namespace lldb::imgui::stream {
+
+static constexpr uint32_t kMagic = 0x4c494453;
+
+/// Anything larger is taken for a corrupt stream
+static constexpr size_t kMaxMessageSize = 256 * 1024 * 1024;
+
+enum class MessageType : uint8_t {
+    Hello,
+    Frame,
+    Input,
+};
+
+struct Hello {
+    uint32_t magic;
+    uint32_t imguiVersion;
+
+    uint32_t vertexSize;
+    uint32_t indexSize;
+    uint32_t inputEventSize;
+};
+
+/// Followed by `numEvents` of `ImGuiInputEvent`
+struct InputHeader {
+    ImVec2 displaySize;
+    ImVec2 framebufferScale;
+
+    uint32_t numEvents;
+    uint32_t reserved;
+};
+
+/// Appends a message to `out`
+void AppendMessage(std::vector<uint8_t>& out, MessageType type, std::span<const uint8_t> payload);
+
+/// Reassembles messages out of what a socket relay received
+class MessageReader {
+public:
+    struct Message {
+        MessageType type;
+
+        /// Valid until the next call to `Receive`
+        std::span<const uint8_t> payload;
+    };
+
+    /// Takes whatever arrived, without blocking
+    void Receive(SocketRelay& relay);
+
+    /// The next complete message, if there is one. Nothing follows once the stream turned out corrupt.
+    std::optional<Message> Next();
+
+    bool IsCorrupt() const {
+        return _isCorrupt;
+    }
+
+private:
+    std::vector<uint8_t> _buffer;
+    size_t _offset = 0;
+
+    bool _isCorrupt = false;
+};
+
+/// Encodes frames as the difference to the last one encoded. Draw lists identical to the one at the
+/// same position in the last frame cost a byte, those which changed are sent as runs of the bytes
+/// which differ.
+class DrawStreamEncoder {
+public:
+    /// Writes the payload of a `Frame` message into `payload`, false if nothing changed since the
+    /// last frame, in which case there is no need to send anything
+    bool Encode(const ImDrawData* drawData, ImTextureID fontTexture, std::vector<uint8_t>& payload);
+
+    /// Encodes the next frame on its own, for a viewer which has seen none of the previous ones
+    void Reset();
+
+private:
+    std::optional<std::vector<uint8_t>> _header;
+
+    // Serialized draw lists of the last frame
+    std::vector<std::vector<uint8_t>> _lists;
+    std::vector<uint8_t> _scratch;
+};
+
+/// Applies frames encoded by `DrawStreamEncoder`
+class DrawStreamDecoder {
+public:
+    DrawStreamDecoder() = default;
+    DrawStreamDecoder(const DrawStreamDecoder&) = delete;
+    ~DrawStreamDecoder();
+
+    /// False if `payload` is malformed, or was encoded against a different previous frame
+    bool Decode(std::span<const uint8_t> payload, ImTextureID fontTexture);
+
+    /// Adds the last decoded frame below everything else in `drawData`
+    void EndFrame(ImDrawData* drawData);
+
+    bool HasFrame() const {
+        return _hasFrame;
+    }
+
+private:
+    bool Build(ImDrawList* list, std::span<const uint8_t> bytes, ImTextureID streamFontTexture, ImTextureID fontTexture);
+
+    bool _hasFrame = false;
+
+    std::vector<std::vector<uint8_t>> _lists;
+    std::vector<ImDrawList*> _drawLists;
+    std::vector<uint8_t> _scratch;
+};
+
+/// Opens a TCP socket for `address`, given as `[host:]port`. Servers listen on it, with the host
+/// defaulting to the loopback interface, viewers connect to it. Returns -1 with `error` set on failure.
+int OpenSocket(std::string_view address, bool isServer, std::string& error);
+
+/// Accepts a pending connection on a non-blocking listening socket, -1 if there is none. The result
+/// is non-blocking too.
+int AcceptSocket(int listener);
+
+/// Writes all of `data` to a blocking socket
+bool SendAll(int socket, std::span<const uint8_t> data);
+
+/// Writes as much of `data` as a non-blocking socket takes, -1 once the connection is gone
+ptrdiff_t SendSome(int socket, std::span<const uint8_t> data);
+
+}
@@ -0,0 +1,147 @@
+#include "ElfFile.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <format>
+#include <utility>
+
+namespace lldb::imgui {
+
+std::optional<ElfFile> ElfFile::Open(const std::filesystem::path& path, std::string& error) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        error = std::format("Failed to open '{}': {}", path.string(), strerror(errno));
+        return std::nullopt;
+    }
+
+    struct stat stat;
+    if (fstat(fd, &stat) != 0 || static_cast<size_t>(stat.st_size) < sizeof(Elf64_Ehdr)) {
+        error = std::format("'{}' is too small to be an ELF file", path.string());
+        close(fd);
+        return std::nullopt;
+    }
+
+    void* data = mmap(nullptr, stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        error = std::format("Failed to map '{}': {}", path.string(), strerror(errno));
+        return std::nullopt;
+    }
+
+    ElfFile file(reinterpret_cast<const std::byte*>(data), stat.st_size);
+
+    const auto& header = file.Header();
+
+    if (std::memcmp(header.e_ident, ELFMAG, SELFMAG) != 0) {
+        error = std::format("'{}' is not an ELF file", path.string());
+        return std::nullopt;
+    }
+    if (header.e_ident[EI_CLASS] != ELFCLASS64) {
+        error = std::format("'{}' is not a 64-bit ELF file", path.string());
+        return std::nullopt;
+    }
+    if (header.e_shoff + header.e_shnum * sizeof(Elf64_Shdr) > file._size) {
+        error = std::format("'{}' has a truncated section header table", path.string());
+        return std::nullopt;
+    }
+    if (header.e_phoff + header.e_phnum * sizeof(Elf64_Phdr) > file._size) {
+        error = std::format("'{}' has a truncated program header table", path.string());
+        return std::nullopt;
+    }
+    // Core files come without sections
+    if (header.e_shnum != 0 && header.e_shstrndx >= header.e_shnum) {
+        error = std::format("'{}' has no section name table", path.string());
+        return std::nullopt;
+    }
+
+    return file;
+}
+
+ElfFile::ElfFile(const std::byte* data, size_t size)
+: _data(data)
+, _size(size)
+{}
+
+ElfFile::ElfFile(ElfFile&& other)
+: _data(std::exchange(other._data, nullptr))
+, _size(std::exchange(other._size, 0))
+{}
+
+ElfFile& ElfFile::operator=(ElfFile&& other) {
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    return *this;
+}
+
+ElfFile::~ElfFile() {
+    if (_data) {
+        munmap(const_cast<std::byte*>(_data), _size);
+    }
+}
+
+const Elf64_Ehdr& ElfFile::Header() const {
+    return *reinterpret_cast<const Elf64_Ehdr*>(_data);
+}
+
+std::span<const Elf64_Shdr> ElfFile::Sections() const {
+    const auto& header = Header();
+
+    return { reinterpret_cast<const Elf64_Shdr*>(_data + header.e_shoff), header.e_shnum };
+}
+
+std::string_view ElfFile::SectionName(const Elf64_Shdr& section) const {
+    auto sections = Sections();
+
+    if (Header().e_shstrndx >= sections.size()) {
+        return {};
+    }
+    auto names = SectionData(sections[Header().e_shstrndx]);
+
+    if (section.sh_name >= names.size()) {
+        return {};
+    }
+
+    auto* name = reinterpret_cast<const char*>(names.data() + section.sh_name);
+    return { name, strnlen(name, names.size() - section.sh_name) };
+}
+
+const Elf64_Shdr* ElfFile::FindSection(std::string_view name) const {
+    for (const auto& section : Sections()) {
+        if (SectionName(section) == name) {
+            return &section;
+        }
+    }
+    return nullptr;
+}
+
+std::span<const std::byte> ElfFile::SectionData(const Elf64_Shdr& section) const {
+    if (section.sh_type == SHT_NOBITS) {
+        return {};
+    }
+    if (section.sh_offset > _size || section.sh_size > _size - section.sh_offset) {
+        return {};
+    }
+
+    return { _data + section.sh_offset, section.sh_size };
+}
+
+std::span<const Elf64_Phdr> ElfFile::Segments() const {
+    const auto& header = Header();
+
+    return { reinterpret_cast<const Elf64_Phdr*>(_data + header.e_phoff), header.e_phnum };
+}
+
+std::span<const std::byte> ElfFile::SegmentData(const Elf64_Phdr& segment) const {
+    if (segment.p_offset > _size || segment.p_filesz > _size - segment.p_offset) {
+        return {};
+    }
+
+    return { _data + segment.p_offset, segment.p_filesz };
+}
+
+}
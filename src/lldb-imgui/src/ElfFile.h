@@ -0,0 +1,56 @@
+#pragma once
+
+#include <elf.h>
+
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <span>
+
+namespace lldb::imgui {
+
+/// Read-only mapping of an ELF64 file, for poking at sections without involving LLDB
+class ElfFile {
+public:
+#if defined(__x86_64__)
+    static constexpr Elf64_Half kHostMachine = EM_X86_64;
+#elif defined(__aarch64__)
+    static constexpr Elf64_Half kHostMachine = EM_AARCH64;
+#endif
+
+    static std::optional<ElfFile> Open(const std::filesystem::path& path, std::string& error);
+
+    ElfFile(ElfFile&& other);
+    ElfFile& operator=(ElfFile&& other);
+    ~ElfFile();
+
+    const Elf64_Ehdr& Header() const;
+
+    std::span<const Elf64_Shdr> Sections() const;
+    std::string_view SectionName(const Elf64_Shdr& section) const;
+
+    const Elf64_Shdr* FindSection(std::string_view name) const;
+
+    /// Contents of a section as stored in the file, empty for `SHT_NOBITS`
+    std::span<const std::byte> SectionData(const Elf64_Shdr& section) const;
+
+    std::span<const Elf64_Phdr> Segments() const;
+
+    /// Contents of a segment as stored in the file, which may be shorter than it is in memory
+    std::span<const std::byte> SegmentData(const Elf64_Phdr& segment) const;
+
+    template<typename T>
+    std::span<const T> SectionArray(const Elf64_Shdr& section) const {
+        auto data = SectionData(section);
+
+        return { reinterpret_cast<const T*>(data.data()), data.size() / sizeof(T) };
+    }
+
+private:
+    ElfFile(const std::byte* data, size_t size);
+
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+};
+
+}
@@ -0,0 +1,223 @@
+#include "EventBus.h"
+
+#include "Trace.h"
+
+#include "lldb/API/LLDB.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <format>
+#include <utility>
+#include <vector>
+
+namespace lldb::imgui {
+
+static constexpr uint32_t kWakeupBit = 1;
+
+// Posted to by the query thread, which the app stops only after the bus is gone
+static std::mutex g_busMutex;
+static EventBus* g_bus = nullptr;
+
+void PostPolledEvents(lldb::user_id_t debugger, const DebuggerEvents& events) {
+    std::lock_guard lock(g_busMutex);
+
+    if (g_bus) {
+        g_bus->Post(debugger, events);
+    }
+}
+
+bool IsProcessShadowed(uint32_t process) {
+    std::lock_guard lock(g_busMutex);
+
+    return g_bus && g_bus->IsShadowed(process);
+}
+
+static DebuggerEvents Classify(const SBEvent& event) {
+    DebuggerEvents events;
+
+    auto type = event.GetType();
+
+    if (SBProcess::EventIsProcessEvent(event)) {
+        if (type & SBProcess::eBroadcastBitStateChanged) {
+            events.numStateChanges = 1;
+            events.lastState = SBProcess::GetStateFromEvent(event);
+        }
+        if (type & (SBProcess::eBroadcastBitSTDOUT | SBProcess::eBroadcastBitSTDERR)) {
+            events.isOutputAvailable = true;
+        }
+    } else if (SBBreakpoint::EventIsBreakpointEvent(event)) {
+        events.isBreakpointsChanged = true;
+    } else if (SBTarget::EventIsTargetEvent(event)) {
+        if (type & SBTarget::eBroadcastBitModulesLoaded) {
+            events.numModulesLoaded = SBTarget::GetNumModulesFromEvent(event);
+        }
+        if (type & SBTarget::eBroadcastBitModulesUnloaded) {
+            events.numModulesUnloaded = SBTarget::GetNumModulesFromEvent(event);
+        }
+        if (type & SBTarget::eBroadcastBitSymbolsLoaded) {
+            events.isSymbolsLoaded = true;
+        }
+    } else if (SBThread::EventIsThreadEvent(event)) {
+        if (type & SBThread::eBroadcastBitThreadSelected) {
+            events.isThreadSelectionChanged = true;
+        }
+        if (type & (SBThread::eBroadcastBitSelectedFrameChanged | SBThread::eBroadcastBitStackChanged)) {
+            events.isFrameSelectionChanged = true;
+        }
+    }
+
+    return events;
+}
+
+EventBus::EventBus(std::function<void()> onEvents)
+: _onEvents(std::move(onEvents))
+{
+    std::lock_guard lock(g_busMutex);
+    g_bus = this;
+}
+
+EventBus::~EventBus() {
+    {
+        std::lock_guard lock(g_busMutex);
+        g_bus = nullptr;
+    }
+
+    for (auto& listener : _listeners) {
+        Stop(*listener);
+    }
+}
+
+void EventBus::AddDebugger(SBDebugger& debugger) {
+    auto id = debugger.GetID();
+
+    bool isListening = std::ranges::any_of(_listeners, [&](const auto& listener) {
+        return listener->id == id;
+    });
+    if (isListening) {
+        return;
+    }
+
+    auto name = std::format("lldb-imgui.events.{}", id);
+
+    auto entry = std::make_unique<Listener>(Listener {
+        .debugger = debugger,
+        .id = id,
+        .listener = SBListener(name.c_str()),
+        .wakeup = SBBroadcaster(name.c_str()),
+    });
+
+    // By class, so that targets and threads created later are covered as well
+    auto& listener = entry->listener;
+
+    listener.StartListeningForEventClass(debugger, SBTarget::GetBroadcasterClassName(),
+        SBTarget::eBroadcastBitBreakpointChanged | SBTarget::eBroadcastBitModulesLoaded | SBTarget::eBroadcastBitModulesUnloaded | SBTarget::eBroadcastBitSymbolsLoaded);
+    listener.StartListeningForEventClass(debugger, SBThread::GetBroadcasterClassName(),
+        SBThread::eBroadcastBitStackChanged | SBThread::eBroadcastBitThreadSelected | SBThread::eBroadcastBitSelectedFrameChanged);
+
+    listener.StartListeningForEvents(entry->wakeup, kWakeupBit);
+
+    ShadowTargets(*entry);
+
+    entry->thread = std::thread([this, entry = entry.get()] {
+        Run(*entry);
+    });
+
+    _listeners.push_back(std::move(entry));
+}
+
+std::unordered_map<lldb::user_id_t, DebuggerEvents> EventBus::Drain() {
+    std::erase_if(_listeners, [&](auto& listener) {
+        if (listener->debugger.IsValid()) {
+            return false;
+        }
+
+        Stop(*listener);
+        return true;
+    });
+
+    std::lock_guard lock(_mutex);
+
+    return std::exchange(_pending, {});
+}
+
+void EventBus::Post(lldb::user_id_t debugger, const DebuggerEvents& events) {
+    std::lock_guard lock(_mutex);
+
+    _pending[debugger].Merge(events);
+}
+
+bool EventBus::IsShadowed(uint32_t process) {
+    std::lock_guard lock(_mutex);
+
+    return _shadowedProcesses.contains(process);
+}
+
+void EventBus::Run(Listener& entry) {
+    SetTraceThreadName(std::format("Events ({})", entry.id));
+
+    SBEvent event;
+
+    while (true) {
+        if (!entry.listener.WaitForEvent(UINT32_MAX, event)) {
+            continue;
+        }
+
+        TRACE_ZONE("Debugger events");
+
+        DebuggerEvents events;
+        std::vector<uint32_t> processes;
+
+        // Takes the rest of the burst along, the UI is only woken once for it
+        do {
+            if (event.BroadcasterMatchesRef(entry.wakeup)) {
+                return;
+            }
+
+            // Process events only come in as the shadow listener
+            if (SBProcess::EventIsProcessEvent(event)) {
+                processes.push_back(SBProcess::GetProcessFromEvent(event).GetUniqueID());
+            }
+
+            events.Merge(Classify(event));
+        } while (entry.listener.GetNextEvent(event));
+
+        // New targets announce themselves by loading modules
+        if (events.numModulesLoaded > 0) {
+            ShadowTargets(entry);
+        }
+
+        {
+            std::lock_guard lock(_mutex);
+            _pending[entry.id].Merge(events);
+            _shadowedProcesses.insert(processes.begin(), processes.end());
+        }
+
+        _onEvents();
+    }
+}
+
+void EventBus::ShadowTargets(Listener& entry) {
+    auto& debugger = entry.debugger;
+
+    for (uint32_t i = 0; i < debugger.GetNumTargets(); i++) {
+        auto target = debugger.GetTargetAtIndex(i);
+        auto info = target.GetLaunchInfo();
+
+        // Someone else's to keep
+        if (info.GetShadowListener().IsValid()) {
+            continue;
+        }
+
+        info.SetShadowListener(entry.listener);
+        target.SetLaunchInfo(info);
+    }
+}
+
+void EventBus::Stop(Listener& entry) {
+    entry.wakeup.BroadcastEventByType(kWakeupBit);
+    entry.thread.join();
+
+    entry.listener.Clear();
+}
+
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "lldb-imgui/Events.h"
+
+#include "lldb/API/SBBroadcaster.h"
+#include "lldb/API/SBDebugger.h"
+#include "lldb/API/SBListener.h"
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Listens to the events of each debugger with an `SBListener` of its own, each drained by a
+/// thread of its own, so nothing has to poll the debuggers for changes. Events are coalesced into
+/// a single `DebuggerEvents` per debugger until the UI picks them up.
+///
+/// Whichever listener takes a process event first handles the stop, so process events are only
+/// listened to as the shadow listener of processes launched through their target's launch info,
+/// which only gets them once the debugger handled them. The state of processes launched otherwise
+/// is left to `QueryEngine` polling, which posts the changes it finds, see `PostPolledEvents`.
+class EventBus {
+public:
+    /// `onEvents` is called on a listening thread after each burst of events
+    explicit EventBus(std::function<void()> onEvents);
+    ~EventBus();
+
+    EventBus(const EventBus&) = delete;
+
+    void AddDebugger(SBDebugger& debugger);
+
+    /// Events since the last call, by debugger ID. Stops listening to debuggers which went away.
+    std::unordered_map<lldb::user_id_t, DebuggerEvents> Drain();
+
+    /// See `PostPolledEvents`
+    void Post(lldb::user_id_t debugger, const DebuggerEvents& events);
+
+    /// See `IsProcessShadowed`
+    bool IsShadowed(uint32_t process);
+
+private:
+    struct Listener {
+        SBDebugger debugger;
+        lldb::user_id_t id;
+
+        SBListener listener;
+
+        // Wakes the thread to stop it
+        SBBroadcaster wakeup;
+
+        std::thread thread;
+    };
+
+    void Run(Listener& listener);
+
+    /// Makes the listener the shadow listener of processes launched by the debugger's targets
+    static void ShadowTargets(Listener& listener);
+    void Stop(Listener& listener);
+
+    std::function<void()> _onEvents;
+
+    std::vector<std::unique_ptr<Listener>> _listeners;
+
+    std::mutex _mutex;
+    std::unordered_map<lldb::user_id_t, DebuggerEvents> _pending;
+
+    // Unique IDs of the processes whose events came in through a shadow listener
+    std::unordered_set<uint32_t> _shadowedProcesses;
+};
+
+/// Merges `events` into those pending for `debugger`, for changes nothing broadcast to the bus.
+/// Does nothing once the bus is gone.
+///
+/// Safe to call from any thread.
+void PostPolledEvents(lldb::user_id_t debugger, const DebuggerEvents& events);
+
+/// Whether the bus got events of the process with `process` as its unique ID. Processes are only
+/// known to be shadowed once their first event came in.
+///
+/// Safe to call from any thread.
+bool IsProcessShadowed(uint32_t process);
+
+}
@@ -1,19 +1,107 @@
 #include "Expose.h"
+#include "SymbolCache.h"
+#include "Trace.h"
 
 #include "spdlog/spdlog.h"
 
-#include "lldb/API/SBDebugger.h"
+#include "lldb/API/LLDB.h"
 
+#if defined(__APPLE__)
 #include <mach-o/dyld.h>
 #include <mach-o/loader.h>
 #include <mach-o/getsect.h>
 #include <mach-o/ldsyms.h>
+#else
+#include "ElfFile.h"
+
+#include <link.h>
+#endif
 
 #include <dlfcn.h>
 #include <unistd.h>
 
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
 namespace lldb::imgui {
+namespace {
+
+/// An image we are looking for private symbols in
+struct ReflectedImage {
+    std::string label;
+    std::string path;
+    std::optional<std::string> uuid;
+
+    // Symbol offsets in the cache are relative to this
+    uintptr_t loadAddress = 0;
+};
+
+/// Symbols of a single image, either mapped from the on-disk cache, or indexed by both their mangled
+/// and plain names on a cold start
+struct ModuleSymbols {
+    std::string path;
+    uintptr_t loadAddress = 0;
+
+    std::optional<SymbolCache> cache;
+    std::unordered_map<std::string_view, void*> byName;
+
+#if !defined(__APPLE__)
+    // Owns the string tables `byName` is pointing into
+    std::optional<ElfFile> file;
+#endif
+
+    void Add(const char* name, void* addr) {
+        if (name && name[0] != '\0') {
+            byName.try_emplace(name, addr);
+        }
+    }
+
+    void* Find(std::string_view name) const {
+        if (cache) {
+            if (auto offset = cache->Find(name)) {
+                return reinterpret_cast<void*>(loadAddress + *offset);
+            }
+            return nullptr;
+        }
+
+        if (auto it = byName.find(name); it != byName.end()) {
+            return it->second;
+        }
+        return nullptr;
+    }
 
+    size_t Size() const {
+        return cache ? cache->Size() : byName.size();
+    }
+};
+
+struct SymbolTable {
+#if defined(__APPLE__)
+    // Only created when there is an image without a cache. Symbol names are owned by the string
+    // pool of this target's debugger
+    SBTarget self;
+#endif
+
+    // Ordered by preference
+    std::vector<ModuleSymbols> modules;
+
+    void* Find(std::string_view name) const {
+        for (const auto& module : modules) {
+            if (auto* addr = module.Find(name)) {
+                return addr;
+            }
+        }
+        return nullptr;
+    }
+};
+
+}
+
+#if defined(__APPLE__)
 static void LogAdapter(const char* message, void* baton) {
     spdlog::info("[SelfDebugger] {}", message);
 }
@@ -51,82 +139,354 @@ static std::optional<std::string> GetImageUUID(void* imageBase) {
     return std::nullopt;
 }
 
+static std::vector<ReflectedImage> GetReflectedImages() {
+    std::vector<ReflectedImage> images;
+
+    auto reflectImageWithAddr = [&](std::string_view label, const void* addr) {
+        Dl_info info;
+        if (!dladdr(addr, &info)) {
+            spdlog::warn("Failed to load module for '{}'", label);
+            return;
+        }
+
+        images.push_back(ReflectedImage {
+            .label = std::string(label),
+            .path = info.dli_fname,
+            .uuid = GetImageUUID(info.dli_fbase),
+            .loadAddress = reinterpret_cast<uintptr_t>(info.dli_fbase),
+        });
+    };
+
+    // Always reflect on LLDB - having this first makes it the preferred source of symbols
+    reflectImageWithAddr("lldb", (void*) SBDebugger::Initialize);
+
+    // Reflect on host executable if it isn't us
+    if (auto* header = (void*) _dyld_get_image_header(0)) {
+        if (header != &_mh_execute_header) {
+            reflectImageWithAddr("host", header);
+        }
+    }
+
+    return images;
+}
+
 static SBTarget CreateSelfReflection() {
     auto status = SBDebugger::InitializeWithErrorHandling();
     if (!status.Success()) {
         spdlog::error("Failed to initialize LLDB API: {}", status.GetCString());
         return {};
     }
-    
+
     auto debugger = SBDebugger::Create(false, LogAdapter, nullptr);
     if (!debugger.IsValid()) {
         spdlog::error("Failed to create self-debugger!");
         return {};
     }
 
-    auto target = debugger.CreateTarget(nullptr);
+    return debugger.CreateTarget(nullptr);
+}
 
-    auto loadModuleWithAddr = [&](std::string_view label, void* addr) {
-        Dl_info info;
-        if (!dladdr(addr, &info)) {
-            spdlog::warn("Failed to load module for '{}'", label);
-            return;
+static bool IndexImage(SymbolTable& table, const ReflectedImage& image, ModuleSymbols& symbols) {
+    if (!image.uuid) {
+        spdlog::error("Failed to determine UUID for '{}'", image.label);
+        return false;
+    }
+
+    if (!table.self.IsValid()) {
+        table.self = CreateSelfReflection();
+    }
+
+    auto& target = table.self;
+    if (!target.IsValid()) {
+        return false;
+    }
+
+    auto mod = target.AddModule(image.path.c_str(), nullptr, image.uuid->c_str());
+    auto* header = reinterpret_cast<struct mach_header_64*>(image.loadAddress);
+
+    for (auto i = 0; i < mod.GetNumSections(); i++) {
+        auto segment = mod.GetSectionAtIndex(i);
+
+        for (auto j = 0; j < segment.GetNumSubSections(); j++) {
+            auto section = segment.GetSubSectionAtIndex(j);
+
+            unsigned long size = 0;
+            void* base = getsectiondata(header, segment.GetName(), section.GetName(), &size);
+
+            auto err = target.SetSectionLoadAddress(section, reinterpret_cast<addr_t>(base));
+            if (!err.Success()) {
+                spdlog::warn("Failed to slide {}.{} in {}", segment.GetName(), section.GetName(), image.path);
+            }
         }
+    }
 
-        auto uuid = GetImageUUID(info.dli_fbase);
-        if (!uuid) {
-            spdlog::error("Failed to determine UUID for '{}'", label);
-            return;
+    symbols.byName.reserve(mod.GetNumSymbols() * 2);
+
+    for (size_t i = 0; i < mod.GetNumSymbols(); i++) {
+        auto symbol = mod.GetSymbolAtIndex(i);
+
+        addr_t loadAddr = symbol.GetStartAddress().GetLoadAddress(target);
+        if (loadAddr == LLDB_INVALID_ADDRESS) {
+            continue;
         }
 
-        auto mod = target.AddModule(info.dli_fname, nullptr, uuid->c_str());
+        symbols.Add(symbol.GetMangledName(), reinterpret_cast<void*>(loadAddr));
+        symbols.Add(symbol.GetName(), reinterpret_cast<void*>(loadAddr));
+    }
+
+    return true;
+}
+
+#else
+/// Formats the GNU build-id note of a loaded image the same way LLDB expects it as a UUID
+static std::optional<std::string> GetImageUUID(const dl_phdr_info& image) {
+    for (int i = 0; i < image.dlpi_phnum; i++) {
+        const auto& phdr = image.dlpi_phdr[i];
+
+        if (phdr.p_type != PT_NOTE) {
+            continue;
+        }
+
+        auto noteAddr = image.dlpi_addr + phdr.p_vaddr;
+        auto noteEnd = noteAddr + phdr.p_memsz;
 
-        for (auto i = 0; i < mod.GetNumSections(); i++) {
-            auto segment = mod.GetSectionAtIndex(i);
+        while (noteAddr + sizeof(ElfW(Nhdr)) <= noteEnd) {
+            auto* note = reinterpret_cast<const ElfW(Nhdr)*>(noteAddr);
 
-            for (auto j = 0; j < segment.GetNumSubSections(); j++) {
-                auto section = segment.GetSubSectionAtIndex(j);
+            auto nameAddr = noteAddr + sizeof(ElfW(Nhdr));
+            auto descAddr = nameAddr + ((note->n_namesz + 3) & ~3);
 
-                unsigned long size = 0;
-                void* base = getsectiondata((struct mach_header_64*) info.dli_fbase, segment.GetName(), section.GetName(), &size);
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && std::memcmp((void*) nameAddr, "GNU", 4) == 0) {
+                auto* desc = reinterpret_cast<const uint8_t*>(descAddr);
 
-                auto err = target.SetSectionLoadAddress(section, reinterpret_cast<addr_t>(base));
-                if (!err.Success()) {
-                    spdlog::warn("Failed to slide {}.{} in {}", segment.GetName(), section.GetName(), info.dli_fname);
+                std::string uuid;
+
+                for (uint32_t j = 0; j < note->n_descsz; j++) {
+                    uuid.append(std::format("{:02X}", desc[j]));
                 }
+                return uuid;
             }
+
+            noteAddr = descAddr + ((note->n_descsz + 3) & ~3);
         }
+    }
+
+    return std::nullopt;
+}
+
+static std::vector<ReflectedImage> GetReflectedImages() {
+    struct LoadedImage {
+        void* base = nullptr;
+        ReflectedImage image;
+    };
+    std::vector<LoadedImage> loaded;
+
+    dl_iterate_phdr([](dl_phdr_info* info, size_t, void* raw) -> int {
+        auto& entry = reinterpret_cast<std::vector<LoadedImage>*>(raw)->emplace_back();
+
+        // The segment mapped from the start of the file is the one containing the ELF header
+        for (int i = 0; i < info->dlpi_phnum; i++) {
+            const auto& phdr = info->dlpi_phdr[i];
+
+            if (phdr.p_type == PT_LOAD && phdr.p_offset == 0) {
+                entry.base = reinterpret_cast<void*>(info->dlpi_addr + phdr.p_vaddr);
+                break;
+            }
+        }
+
+        // Symbol values are relative to the slide, rather than to the ELF header
+        entry.image.loadAddress = info->dlpi_addr;
+        entry.image.path = info->dlpi_name;
+        entry.image.uuid = GetImageUUID(*info);
+
+        // The main executable is always first, and is reported without a name
+        if (entry.image.path.empty()) {
+            entry.image.path = std::filesystem::read_symlink("/proc/self/exe").string();
+        }
+        return 0;
+    }, &loaded);
+
+    auto findImageWithAddr = [&](void* addr) -> LoadedImage* {
+        Dl_info info;
+        if (!dladdr(addr, &info)) {
+            return nullptr;
+        }
+
+        for (auto& entry : loaded) {
+            if (entry.base == info.dli_fbase) {
+                return &entry;
+            }
+        }
+        return nullptr;
+    };
+
+    std::vector<ReflectedImage> images;
+
+    auto reflectImage = [&](std::string_view label, LoadedImage* entry) {
+        if (!entry) {
+            spdlog::warn("Failed to load module for '{}'", label);
+            return;
+        }
+
+        entry->image.label = label;
+        images.push_back(entry->image);
     };
 
     // Always reflect on LLDB - having this first makes it the preferred source of symbols
-    loadModuleWithAddr("lldb", (void*) SBDebugger::Initialize);
+    reflectImage("lldb", findImageWithAddr((void*) SBDebugger::Initialize));
 
     // Reflect on host executable if it isn't us
-    if (auto* header = (void*) _dyld_get_image_header(0)) {
-        if (header != &_mh_execute_header) {
-            loadModuleWithAddr("host", header);
-        }
+    if (!loaded.empty() && &loaded.front() != findImageWithAddr((void*) GetReflectedImages)) {
+        reflectImage("host", &loaded.front());
     }
 
-    return target;
+    return images;
 }
 
-void* Expose(const char* name) {
-    static SBTarget self = CreateSelfReflection();
+/// Indexes the symbol tables of an image straight from its file, private symbols included if not stripped
+static bool IndexImage(SymbolTable& table, const ReflectedImage& image, ModuleSymbols& symbols) {
+    std::string error;
+
+    auto file = ElfFile::Open(image.path, error);
+    if (!file) {
+        spdlog::error("Failed to index symbols: {}", error);
+        return false;
+    }
+
+    auto* symtab = file->FindSection(".symtab");
+    auto* dynsym = file->FindSection(".dynsym");
 
-    for (uint32_t i = 0; i < self.GetNumModules(); i++) {
-        auto mod = self.GetModuleAtIndex(i);
+    if (!symtab) {
+        spdlog::warn("'{}' has no .symtab, only exported symbols can be exposed", image.path);
+    }
 
-        auto symbol = mod.FindSymbol(name);
-        if (!symbol.IsValid()) {
+    for (auto* section : { symtab, dynsym }) {
+        if (!section || section->sh_link >= file->Sections().size()) {
             continue;
         }
 
-        addr_t loadAddr = symbol.GetStartAddress().GetLoadAddress(self);
-        return reinterpret_cast<void*>(loadAddr);
+        auto strings = file->SectionArray<char>(file->Sections()[section->sh_link]);
+        auto entries = file->SectionArray<Elf64_Sym>(*section);
+
+        symbols.byName.reserve(symbols.byName.size() + entries.size());
+
+        for (const auto& entry : entries) {
+            if (entry.st_shndx == SHN_UNDEF || entry.st_name == 0 || entry.st_name >= strings.size()) {
+                continue;
+            }
+
+            switch (ELF64_ST_TYPE(entry.st_info)) {
+                case STT_FUNC:
+                case STT_OBJECT:
+                case STT_GNU_IFUNC:
+                case STT_NOTYPE:
+                    break;
+
+                default:
+                    continue;
+            }
+
+            auto* name = strings.data() + entry.st_name;
+            auto length = strnlen(name, strings.size() - entry.st_name);
+
+            symbols.byName.try_emplace(std::string_view(name, length), reinterpret_cast<void*>(image.loadAddress + entry.st_value));
+        }
+    }
+
+    symbols.file = std::move(file);
+    return true;
+}
+#endif
+
+static void WriteSymbolCache(const std::filesystem::path& path, const ModuleSymbols& symbols) {
+    std::vector<SymbolCache::Entry> entries;
+    entries.reserve(symbols.byName.size());
+
+    for (const auto& [name, addr] : symbols.byName) {
+        entries.push_back(SymbolCache::Entry {
+            .name = name,
+            .offset = reinterpret_cast<uintptr_t>(addr) - symbols.loadAddress,
+        });
+    }
+
+    if (!SymbolCache::Write(path, entries)) {
+        spdlog::warn("Failed to write symbol cache '{}'", path.string());
+    }
+}
+
+static SymbolTable BuildSymbolTable() {
+    TRACE_ZONE("BuildSymbolTable");
+
+    SymbolTable table;
+
+    for (const auto& image : GetReflectedImages()) {
+        auto start = std::chrono::steady_clock::now();
+
+        ModuleSymbols symbols {
+            .path = image.path,
+            .loadAddress = image.loadAddress,
+        };
+
+        std::filesystem::path cachePath;
+
+        if (image.uuid) {
+            cachePath = SymbolCache::PathFor(*image.uuid);
+            symbols.cache = SymbolCache::Open(cachePath);
+        }
+
+        const char* source = "Mapped cached";
+
+        if (!symbols.cache) {
+            if (!IndexImage(table, image, symbols)) {
+                continue;
+            }
+            if (!cachePath.empty()) {
+                WriteSymbolCache(cachePath, symbols);
+            }
+
+            source = "Indexed";
+        }
+
+        auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        spdlog::info("{} {} symbols of '{}' in {:.1f} ms", source, symbols.Size(), image.path, elapsed.count());
+
+        table.modules.push_back(std::move(symbols));
+    }
+
+    return table;
+}
+
+static const SymbolTable& GetSymbolTable() {
+    static SymbolTable table = BuildSymbolTable();
+    return table;
+}
+
+void* Expose(const char* name) {
+    TRACE_ZONE("Expose");
+
+    return GetSymbolTable().Find(name);
+}
+
+std::vector<std::string_view> ExposeSection(std::span<const char> section) {
+    TRACE_ZONE("ExposeSection");
+
+    const auto& table = GetSymbolTable();
+
+    std::vector<std::string_view> missing;
+
+    auto symbol = section.data();
+    auto end = symbol + section.size();
+
+    while (symbol < end) {
+        std::string_view name(symbol, strnlen(symbol, end - symbol));
+        symbol += name.size() + 1;
+
+        if (!name.empty() && !table.Find(name)) {
+            missing.push_back(name);
+        }
     }
 
-    return nullptr;
+    return missing;
 }
 
 }
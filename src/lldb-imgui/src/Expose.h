@@ -2,6 +2,10 @@
 
 #include <stddef.h>
 
+#include <span>
+#include <string_view>
+#include <vector>
+
 namespace lldb::imgui {
 
 /// Alternate implementation of `dlsym` using LLDB to find private symbols inside
@@ -9,6 +13,10 @@ namespace lldb::imgui {
 /// - `LLDB.framework` if it happens to be loaded
 void* Expose(const char* symbol);
 
+/// Resolves every name of an `exposed_symbols` section in a single pass over the symbol index, and
+/// returns the ones which could not be found
+std::vector<std::string_view> ExposeSection(std::span<const char> section);
+
 template<typename T>
 T* Expose(const char* symbol) {
     return reinterpret_cast<T*>(Expose(symbol));
@@ -21,6 +29,7 @@ T* Expose(const char* symbol) {
 ///
 /// To not ruin the call, `x8` is saved in `x16` which is specified to be clobberable across call boundaries
 /// https://developer.arm.com/documentation/102374/0102/Procedure-Call-Standard
+#if defined(__APPLE__)
 #define EXPOSE(NAME)                                                                 \
     extern "C" {                                                                     \
         __attribute__((section("__CONST,exposed_symbols")))                          \
@@ -39,5 +48,22 @@ T* Expose(const char* symbol) {
         __attribute__((ifunc(#NAME "_resolver")))                                    \
         void NAME();                                                                 \
     }
+#else
+/// On ELF the resolvers run while `dlopen` is still relocating, before any static initializers of the
+/// plugin had a chance to, so the lookup has to happen in the resolver itself. The resolver is never
+/// part of an actual call, so there is no return value register to protect either.
+#define EXPOSE(NAME)                                                                 \
+    extern "C" {                                                                     \
+        __attribute__((section("exposed_symbols"), used))                            \
+        __attribute__((internal_linkage))                                            \
+        static const char NAME##_symbol[] = #NAME;                                   \
+                                                                                     \
+        void* NAME##_resolver() {                                                    \
+            return lldb::imgui::Expose(NAME##_symbol);                               \
+        }                                                                            \
+        __attribute__((ifunc(#NAME "_resolver")))                                    \
+        void NAME();                                                                 \
+    }
+#endif
 
 }
@@ -0,0 +1,83 @@
+#include "InputReplay.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace lldb::imgui {
+
+static bool IsValidSource(ImGuiMouseSource source) {
+    return source >= 0 && source < ImGuiMouseSource_COUNT;
+}
+
+/// Whether `event` is one ImGui could have recorded itself, anything else trips its assertions or
+/// indexes past its arrays
+static bool IsValidInputEvent(const ImGuiInputEvent& event) {
+    switch (event.Type) {
+        case ImGuiInputEventType_MousePos: {
+            // Positions far off screen stand for no mouse at all, only NaNs are meaningless
+            return IsValidSource(event.MousePos.MouseSource) && !std::isnan(event.MousePos.PosX) && !std::isnan(event.MousePos.PosY);
+        }
+        case ImGuiInputEventType_MouseWheel: {
+            return IsValidSource(event.MouseWheel.MouseSource) && std::isfinite(event.MouseWheel.WheelX) && std::isfinite(event.MouseWheel.WheelY);
+        }
+        case ImGuiInputEventType_MouseButton: {
+            return IsValidSource(event.MouseButton.MouseSource) && event.MouseButton.Button >= 0 && event.MouseButton.Button < ImGuiMouseButton_COUNT;
+        }
+        case ImGuiInputEventType_Key: {
+            return ImGui::IsNamedKeyOrMod(event.Key.Key) && std::isfinite(event.Key.AnalogValue);
+        }
+        case ImGuiInputEventType_Text:
+        case ImGuiInputEventType_Focus: {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+bool ReplayInputEvents(std::span<const ImGuiInputEvent> events) {
+    ImGuiIO& io = ImGui::GetIO();
+
+    if (!std::ranges::all_of(events, IsValidInputEvent)) {
+        return false;
+    }
+
+    for (const auto& event : events) {
+        switch (event.Type) {
+            case ImGuiInputEventType_MousePos: {
+                io.AddMouseSourceEvent(event.MousePos.MouseSource);
+                io.AddMousePosEvent(event.MousePos.PosX, event.MousePos.PosY);
+                break;
+            }
+            case ImGuiInputEventType_MouseWheel: {
+                io.AddMouseSourceEvent(event.MouseWheel.MouseSource);
+                io.AddMouseWheelEvent(event.MouseWheel.WheelX, event.MouseWheel.WheelY);
+                break;
+            }
+            case ImGuiInputEventType_MouseButton: {
+                io.AddMouseSourceEvent(event.MouseButton.MouseSource);
+                io.AddMouseButtonEvent(event.MouseButton.Button, event.MouseButton.Down);
+                break;
+            }
+            case ImGuiInputEventType_Key: {
+                io.AddKeyAnalogEvent(event.Key.Key, event.Key.Down, event.Key.AnalogValue);
+                break;
+            }
+            case ImGuiInputEventType_Text: {
+                io.AddInputCharacter(event.Text.Char);
+                break;
+            }
+            case ImGuiInputEventType_Focus: {
+                io.AddFocusEvent(event.AppFocused.Focused);
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <span>
+
+namespace lldb::imgui {
+
+/// Queues input events recorded in another ImGui context, usually taken from its `InputEventsTrail`,
+/// as if they came from the platform backend of the current one. Queues none of them and returns
+/// false if any is invalid.
+bool ReplayInputEvents(std::span<const ImGuiInputEvent> events);
+
+}
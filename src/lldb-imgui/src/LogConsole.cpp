@@ -0,0 +1,242 @@
+#include "LogConsole.h"
+
+#include "lldb-imgui/API.h"
+
+#include <algorithm>
+#include <array>
+#include <cfloat>
+#include <chrono>
+#include <string>
+
+namespace lldb::imgui {
+
+static constexpr std::array kLevelNames = {
+    "Trace",
+    "Debug",
+    "Info",
+    "Warn",
+    "Error",
+    "Critical",
+};
+
+static ImVec4 LevelColor(LogLevel level) {
+    switch (level) {
+        case LogLevel::Trace:
+        case LogLevel::Debug:
+            return ImGui::GetStyleColorVec4(ImGuiCol_TextDisabled);
+        case LogLevel::Info:
+            return ImGui::GetStyleColorVec4(ImGuiCol_Text);
+        case LogLevel::Warn:
+            return ImVec4(1.0f, 0.8f, 0.3f, 1.0f);
+        case LogLevel::Error:
+        case LogLevel::Critical:
+            return ImVec4(1.0f, 0.4f, 0.4f, 1.0f);
+    }
+    return ImGui::GetStyleColorVec4(ImGuiCol_Text);
+}
+
+bool LogConsole::Update() {
+    auto& ring = GetLogRing();
+
+    bool isUpdated = false;
+
+    while (_position < ring.End()) {
+        auto position = _position;
+        auto result = ring.Read(_position, _record);
+
+        if (result == LogRing::ReadResult::Pending) {
+            break;
+        }
+        if (result == LogRing::ReadResult::Overwritten) {
+            _position = ring.Resync();
+            continue;
+        }
+        if (result == LogRing::ReadResult::Padding) {
+            continue;
+        }
+
+        auto* category = _record.category;
+
+        if (std::ranges::find(_categories, category) == _categories.end()) {
+            auto it = std::ranges::upper_bound(_categories, category->name, {}, &LogCategory::name);
+            _categories.insert(it, category);
+        }
+
+        _rows.push_back(Row {
+            .position = position,
+            .level = _record.level,
+            .category = category,
+        });
+        isUpdated = true;
+    }
+
+    // Drop what was overwritten since
+    auto begin = ring.Begin();
+
+    while (!_rows.empty() && _rows.front().position < begin) {
+        _rows.pop_front();
+    }
+    while (!_filtered.empty() && _filtered.front() < begin) {
+        _filtered.pop_front();
+    }
+
+    return isUpdated;
+}
+
+bool LogConsole::IsShown(const Row& row) const {
+    return row.level >= _minLevel && !_hiddenCategories.contains(row.category);
+}
+
+void LogConsole::Filter() {
+    auto it = std::ranges::lower_bound(_rows, _filteredUntil, {}, &Row::position);
+    auto budget = kSearchBudget;
+
+    for (; it != _rows.end(); it++) {
+        if (!IsShown(*it)) {
+            continue;
+        }
+
+        if (_search.IsActive()) {
+            if (budget-- == 0) {
+                break;
+            }
+
+            auto position = it->position;
+            if (GetLogRing().Read(position, _record) != LogRing::ReadResult::Record) {
+                continue;
+            }
+
+            auto message = _record.Format();
+            if (!_search.PassFilter(message.data(), message.data() + message.size())) {
+                continue;
+            }
+        }
+
+        _filtered.push_back(it->position);
+    }
+
+    if (it != _rows.end()) {
+        _filteredUntil = it->position;
+    } else if (!_rows.empty()) {
+        _filteredUntil = _rows.back().position + 1;
+    }
+}
+
+void LogConsole::ResetFilter() {
+    _filtered.clear();
+    _filteredUntil = 0;
+}
+
+void LogConsole::Draw(bool* isOpen) {
+    using namespace ImGui;
+
+    if (!Begin("Log", isOpen)) {
+        End();
+        return;
+    }
+
+    Update();
+
+    int level = int(_minLevel);
+
+    SetNextItemWidth(GetFontSize() * 8);
+    if (Combo("##Level", &level, kLevelNames.data(), int(kLevelNames.size()))) {
+        _minLevel = LogLevel(level);
+        ResetFilter();
+    }
+
+    SameLine();
+    if (Button("Categories")) {
+        OpenPopup("Categories");
+    }
+    if (BeginPopup("Categories")) {
+        for (auto* category : _categories) {
+            bool isShown = !_hiddenCategories.contains(category);
+
+            if (Checkbox(category->name.c_str(), &isShown)) {
+                if (isShown) {
+                    _hiddenCategories.erase(category);
+                } else {
+                    _hiddenCategories.insert(category);
+                }
+                ResetFilter();
+            }
+        }
+        EndPopup();
+    }
+
+    SameLine();
+    if (_search.Draw("Search", -FLT_MIN)) {
+        ResetFilter();
+    }
+
+    Filter();
+
+    bool isSearching = !_rows.empty() && _filteredUntil <= _rows.back().position;
+    if (isSearching) {
+        // Continues on the next frame
+        RequestRedraw();
+    }
+
+    TextDisabled("%zu of %zu messages%s", _filtered.size(), _rows.size(), isSearching ? ", searching..." : "");
+
+    auto flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+
+    if (BeginTable("Log", 4, flags)) {
+        TableSetupScrollFreeze(0, 1);
+        TableSetupColumn("Time", ImGuiTableColumnFlags_WidthFixed);
+        TableSetupColumn("Level", ImGuiTableColumnFlags_WidthFixed);
+        TableSetupColumn("Category", ImGuiTableColumnFlags_WidthFixed);
+        TableSetupColumn("Message", ImGuiTableColumnFlags_WidthStretch);
+        TableHeadersRow();
+
+        auto& ring = GetLogRing();
+
+        ImGuiListClipper clipper;
+        clipper.Begin(int(_filtered.size()));
+
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+                auto position = _filtered[row];
+
+                TableNextRow();
+                TableNextColumn();
+
+                if (ring.Read(position, _record) != LogRing::ReadResult::Record) {
+                    TextDisabled("Overwritten");
+                    continue;
+                }
+
+                auto time = std::chrono::duration<double>(_record.time - ring.StartTime());
+                Text("%.3f", time.count());
+
+                TableNextColumn();
+                TextColored(LevelColor(_record.level), "%s", kLevelNames[size_t(_record.level)]);
+
+                TableNextColumn();
+                TextUnformatted(_record.category->name.c_str());
+
+                TableNextColumn();
+                auto message = _record.Format();
+                auto firstLine = std::string_view(message).substr(0, message.find('\n'));
+
+                // Rows have to be a single line for the clipper, the rest is shown on hover
+                TextUnformatted(firstLine.data(), firstLine.data() + firstLine.size());
+                if (firstLine.size() < message.size()) {
+                    SetItemTooltip("%s", message.c_str());
+                }
+            }
+        }
+
+        // Follow new messages while scrolled to the bottom
+        if (GetScrollY() >= GetScrollMaxY()) {
+            SetScrollHereY(1.0f);
+        }
+
+        EndTable();
+    }
+
+    End();
+}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "LogRing.h"
+
+#include "imgui.h"
+
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Window listing the log ring. Only the level and category of each record are kept around, records
+/// are formatted when they scroll into view, or when the search gets to them.
+class LogConsole {
+public:
+    // Records formatted per frame while searching
+    static constexpr size_t kSearchBudget = 2048;
+
+    /// Reads the records logged since the last update, returns whether there were any
+    bool Update();
+
+    void Draw(bool* isOpen);
+
+private:
+    struct Row {
+        uint64_t position;
+        LogLevel level;
+        const LogCategory* category;
+    };
+
+    bool IsShown(const Row& row) const;
+
+    /// Carries the filters over to rows which were not filtered yet
+    void Filter();
+    void ResetFilter();
+
+    // Reused for every read, to keep its storage
+    LogRing::Record _record;
+
+    uint64_t _position = 0;
+    std::deque<Row> _rows;
+
+    // Ordered by name
+    std::vector<const LogCategory*> _categories;
+
+    LogLevel _minLevel = LogLevel::Trace;
+    std::unordered_set<const LogCategory*> _hiddenCategories;
+    ImGuiTextFilter _search;
+
+    // Positions of the rows passing all filters, and where filtering continues
+    std::deque<uint64_t> _filtered;
+    uint64_t _filteredUntil = 0;
+};
+
+}
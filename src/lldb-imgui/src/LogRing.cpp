@@ -0,0 +1,306 @@
+#include "LogRing.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+namespace {
+
+/// Formats a stored argument with the format spec of its replacement field, as the logged value would
+struct FormatArg {
+    // Null when the format string refers to more arguments than were logged
+    const lldb::imgui::LogArg* arg = nullptr;
+};
+
+}
+
+template<>
+struct std::formatter<FormatArg> {
+    std::string_view spec;
+
+    constexpr auto parse(std::format_parse_context& context) {
+        auto it = context.begin();
+
+        while (it != context.end() && *it != '}') {
+            if (*it == '{') {
+                throw std::format_error("Nested replacement fields are not supported");
+            }
+            it++;
+        }
+
+        spec = std::string_view(context.begin(), it);
+        return it;
+    }
+
+    auto format(const FormatArg& formatArg, std::format_context& context) const {
+        using Type = lldb::imgui::LogArg::Type;
+
+        if (!formatArg.arg) {
+            throw std::format_error("Argument index out of range");
+        }
+
+        auto pattern = std::format("{{:{}}}", spec);
+        auto forward = [&](const auto& value) {
+            return std::vformat_to(context.out(), pattern, std::make_format_args(value));
+        };
+
+        const auto& arg = *formatArg.arg;
+
+        switch (arg.type) {
+            case Type::Int:     return forward(arg.i);
+            case Type::UInt:    return forward(arg.u);
+            case Type::Double:  return forward(arg.d);
+            case Type::Bool:    return forward(arg.b);
+            case Type::Char:    return forward(arg.c);
+            case Type::Pointer: return forward(arg.p);
+            case Type::String:  return forward(std::string_view(arg.s.data, arg.s.size));
+        }
+        return context.out();
+    }
+};
+
+namespace lldb::imgui {
+
+static size_t AlignUp(size_t size, size_t alignment) {
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+std::string LogRing::Record::Format() const {
+    std::array<FormatArg, kMaxArgs> formatArgs;
+
+    for (size_t i = 0; i < numArgs; i++) {
+        formatArgs[i].arg = &args[i];
+    }
+
+    try {
+        return std::vformat(format, std::apply([](auto&... args) {
+            return std::make_format_args(args...);
+        }, formatArgs));
+    } catch (const std::format_error&) {
+        return std::string(format);
+    }
+}
+
+LogRing::LogRing()
+: _buffer(std::make_unique<uint8_t[]>(kCapacity))
+, _startTime(Clock::now())
+{}
+
+uint8_t* LogRing::At(uint64_t position) const {
+    return _buffer.get() + position % kCapacity;
+}
+
+uint64_t LogRing::Reserve(size_t size) {
+    auto position = _reserved.load(std::memory_order_relaxed);
+
+    while (true) {
+        // Records never wrap around, the end of the buffer is filled with padding instead
+        auto offset = position % kCapacity;
+        auto padding = offset + size > kCapacity ? kCapacity - offset : 0;
+
+        if (_reserved.compare_exchange_weak(position, position + padding + size, std::memory_order_acq_rel)) {
+            if (padding) {
+                auto* header = reinterpret_cast<Header*>(At(position));
+
+                header->size = uint32_t(padding);
+                header->level = kPaddingLevel;
+
+                std::atomic_ref(header->published).store(position + 1, std::memory_order_release);
+            }
+            return position + padding;
+        }
+    }
+}
+
+void LogRing::Write(const LogCategory* category, LogLevel level, std::string_view format, std::span<const LogArg> args) {
+    args = args.first(std::min(args.size(), kMaxArgs));
+    format = format.substr(0, std::min<size_t>(format.size(), UINT16_MAX));
+
+    auto size = sizeof(Header) + args.size() * sizeof(StoredArg) + format.size();
+
+    for (const auto& arg : args) {
+        if (arg.type == LogArg::Type::String) {
+            size += std::min(arg.s.size, kMaxStringSize);
+        }
+    }
+
+    size = AlignUp(size, kAlignment);
+
+    auto position = Reserve(size);
+    auto* bytes = At(position);
+
+    auto* header = reinterpret_cast<Header*>(bytes);
+    header->size = uint32_t(size);
+    header->formatSize = uint16_t(format.size());
+    header->level = uint8_t(level);
+    header->numArgs = uint8_t(args.size());
+    header->time = Clock::now().time_since_epoch().count();
+    header->category = category;
+
+    auto* stored = reinterpret_cast<StoredArg*>(bytes + sizeof(Header));
+    auto* text = reinterpret_cast<char*>(stored + args.size());
+
+    memcpy(text, format.data(), format.size());
+    text += format.size();
+
+    for (const auto& arg : args) {
+        stored->type = uint64_t(arg.type);
+
+        switch (arg.type) {
+            case LogArg::Type::Int:     stored->value = uint64_t(arg.i); break;
+            case LogArg::Type::UInt:    stored->value = arg.u; break;
+            case LogArg::Type::Double:  stored->value = std::bit_cast<uint64_t>(arg.d); break;
+            case LogArg::Type::Bool:    stored->value = arg.b; break;
+            case LogArg::Type::Char:    stored->value = uint8_t(arg.c); break;
+            case LogArg::Type::Pointer: stored->value = reinterpret_cast<uintptr_t>(arg.p); break;
+            case LogArg::Type::String: {
+                stored->value = std::min(arg.s.size, kMaxStringSize);
+
+                memcpy(text, arg.s.data, stored->value);
+                text += stored->value;
+                break;
+            }
+        }
+        stored++;
+    }
+
+    std::atomic_ref(header->published).store(position + 1, std::memory_order_release);
+}
+
+LogRing::ReadResult LogRing::Read(uint64_t& position, Record& record) const {
+    if (position < Begin()) {
+        return ReadResult::Overwritten;
+    }
+
+    auto* bytes = At(position);
+    auto* source = reinterpret_cast<Header*>(bytes);
+
+    if (std::atomic_ref(source->published).load(std::memory_order_acquire) != position + 1) {
+        return position < Begin() ? ReadResult::Overwritten : ReadResult::Pending;
+    }
+
+    Header header;
+    memcpy(&header, bytes, kPaddingSize);
+
+    bool isPadding = header.level == kPaddingLevel;
+    auto minSize = isPadding ? kPaddingSize : sizeof(Header);
+
+    // Torn by a writer a lap ahead
+    if (header.size < minSize || header.size > kCapacity - position % kCapacity) {
+        return ReadResult::Overwritten;
+    }
+
+    if (!isPadding) {
+        memcpy(&header, bytes, sizeof(Header));
+
+        record.storage.resize(header.size - sizeof(Header));
+        memcpy(record.storage.data(), bytes + sizeof(Header), record.storage.size());
+    }
+
+    // Writers which reserved past a full lap may have written into the copy while it was made
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (_reserved.load(std::memory_order_relaxed) > position + kCapacity) {
+        return ReadResult::Overwritten;
+    }
+
+    position += header.size;
+
+    if (isPadding) {
+        return ReadResult::Padding;
+    }
+
+    record.time = Clock::time_point(Clock::duration(header.time));
+    record.level = LogLevel(header.level);
+    record.category = header.category;
+    record.numArgs = header.numArgs;
+
+    auto* stored = reinterpret_cast<const StoredArg*>(record.storage.data());
+    auto* text = reinterpret_cast<const char*>(stored + header.numArgs);
+
+    record.format = std::string_view(text, header.formatSize);
+    text += header.formatSize;
+
+    for (size_t i = 0; i < header.numArgs; i++, stored++) {
+        auto& arg = record.args[i];
+        arg.type = LogArg::Type(stored->type);
+
+        switch (arg.type) {
+            case LogArg::Type::Int:     arg.i = int64_t(stored->value); break;
+            case LogArg::Type::UInt:    arg.u = stored->value; break;
+            case LogArg::Type::Double:  arg.d = std::bit_cast<double>(stored->value); break;
+            case LogArg::Type::Bool:    arg.b = stored->value != 0; break;
+            case LogArg::Type::Char:    arg.c = char(stored->value); break;
+            case LogArg::Type::Pointer: arg.p = reinterpret_cast<const void*>(stored->value); break;
+            case LogArg::Type::String: {
+                arg.s = { text, size_t(stored->value) };
+                text += stored->value;
+                break;
+            }
+        }
+    }
+
+    return ReadResult::Record;
+}
+
+LogRing& GetLogRing() {
+    // Loggers are used during static initialization
+    static LogRing ring;
+    return ring;
+}
+
+const LogCategory* InternLogCategory(std::string_view name) {
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::unique_ptr<LogCategory>> categories;
+
+    std::scoped_lock lock(mutex);
+
+    auto& interned = categories[std::string(name)];
+    if (!interned) {
+        interned = std::make_unique<LogCategory>(LogCategory { .name = std::string(name) });
+    }
+    return interned.get();
+}
+
+void WriteLog(const LogCategory* category, LogLevel level, std::string_view format, std::span<const LogArg> args) {
+    GetLogRing().Write(category, level, format, args);
+}
+
+void LogRingSink::log(const spdlog::details::log_msg& message) {
+    LogLevel level;
+
+    switch (message.level) {
+        case spdlog::level::trace:    level = LogLevel::Trace;    break;
+        case spdlog::level::debug:    level = LogLevel::Debug;    break;
+        case spdlog::level::info:     level = LogLevel::Info;     break;
+        case spdlog::level::warn:     level = LogLevel::Warn;     break;
+        case spdlog::level::err:      level = LogLevel::Error;    break;
+        case spdlog::level::critical: level = LogLevel::Critical; break;
+        default: return;
+    }
+
+    std::string_view name(message.logger_name.data(), message.logger_name.size());
+    if (name.empty()) {
+        name = "lldb-imgui";
+    }
+
+    // Saves taking the lock of `InternLogCategory` on every message
+    thread_local std::vector<std::pair<std::string, const LogCategory*>> categories;
+
+    auto it = std::find_if(categories.begin(), categories.end(), [&](const auto& entry) {
+        return entry.first == name;
+    });
+    if (it == categories.end()) {
+        it = categories.emplace(categories.end(), std::string(name), InternLogCategory(name));
+    }
+
+    std::array args {
+        MakeLogArg(std::string_view(message.payload.data(), message.payload.size())),
+    };
+    GetLogRing().Write(it->second, level, "{}", args);
+}
+
+}
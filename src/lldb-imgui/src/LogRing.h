@@ -0,0 +1,142 @@
+#pragma once
+
+#include "lldb-imgui/Log.h"
+
+#include "spdlog/sinks/sink.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lldb::imgui {
+
+struct LogCategory {
+    std::string name;
+};
+
+/// Log records of all threads, kept in a fixed size byte buffer in the binary form they were logged
+/// in, which overwrites the oldest records once full.
+///
+/// Writers reserve their record with a single atomic operation, and publish it once written. Readers
+/// copy a record out, and only afterwards check whether it was overwritten in the meantime.
+class LogRing {
+public:
+    static constexpr size_t kCapacity = 4 * 1024 * 1024;
+    static constexpr size_t kMaxArgs = 16;
+
+    using Clock = std::chrono::steady_clock;
+
+    /// A record copied out of the ring, its strings point into `storage`
+    struct Record {
+        Clock::time_point time;
+        LogLevel level = LogLevel::Info;
+        const LogCategory* category = nullptr;
+
+        std::string_view format;
+        std::array<LogArg, kMaxArgs> args {};
+        size_t numArgs = 0;
+
+        std::vector<uint8_t> storage;
+
+        /// Formats the message, or returns the format string if the arguments don't fit it
+        std::string Format() const;
+    };
+
+    LogRing();
+
+    LogRing(const LogRing&) = delete;
+
+    /// Safe to call from any thread.
+    void Write(const LogCategory* category, LogLevel level, std::string_view format, std::span<const LogArg> args);
+
+    /// Position after the last reserved record
+    uint64_t End() const {
+        return _reserved.load(std::memory_order_acquire);
+    }
+
+    /// Position of the oldest record which may still be intact
+    uint64_t Begin() const {
+        auto end = End();
+        return end > kCapacity ? end - kCapacity : 0;
+    }
+
+    /// First position at or after `Begin()` which is known to start a record, to continue reading at
+    /// after falling behind by more than the capacity
+    uint64_t Resync() const {
+        return (Begin() + kCapacity - 1) / kCapacity * kCapacity;
+    }
+
+    enum class ReadResult {
+        Record,
+        // Filler at the end of the buffer, which only has to be skipped
+        Padding,
+        // Not published yet, nothing after it has been read
+        Pending,
+        Overwritten,
+    };
+
+    /// Copies out the record at `position`, and advances `position` past it
+    ReadResult Read(uint64_t& position, Record& record) const;
+
+    /// When the ring was created, record times are relative to this
+    Clock::time_point StartTime() const {
+        return _startTime;
+    }
+
+private:
+    // Multiple of the alignment of every record
+    static constexpr size_t kAlignment = 16;
+    static constexpr size_t kPaddingSize = 16;
+    static constexpr uint8_t kPaddingLevel = 0xff;
+
+    // Longer strings are truncated
+    static constexpr size_t kMaxStringSize = 16 * 1024;
+
+    struct Header {
+        // Position of the record plus one, once published
+        uint64_t published;
+        uint32_t size;
+        uint16_t formatSize;
+        uint8_t level;
+        uint8_t numArgs;
+
+        // Padding only fills the fields above
+        Clock::rep time;
+        const LogCategory* category;
+    };
+    static_assert(sizeof(Header) % kAlignment == 0);
+    static_assert(offsetof(Header, time) == kPaddingSize);
+
+    // Fixed size part of an argument, strings follow the format string
+    struct StoredArg {
+        uint64_t type;
+        uint64_t value;
+    };
+
+    uint64_t Reserve(size_t size);
+    uint8_t* At(uint64_t position) const;
+
+    std::unique_ptr<uint8_t[]> _buffer;
+    std::atomic<uint64_t> _reserved = 0;
+
+    Clock::time_point _startTime;
+};
+
+/// The ring all logs end up in
+LogRing& GetLogRing();
+
+/// Forwards spdlog's messages into the log ring, under the name of their logger
+class LogRingSink final : public spdlog::sinks::sink {
+public:
+    void log(const spdlog::details::log_msg& message) override;
+    void flush() override {}
+
+    void set_pattern(const std::string&) override {}
+    void set_formatter(std::unique_ptr<spdlog::formatter>) override {}
+};
+
+}
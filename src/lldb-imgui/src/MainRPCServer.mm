@@ -1,5 +1,7 @@
 #include "App.h"
 #include "Expose.h"
+#include "LogRing.h"
+#include "SocketRelay.h"
 
 #include "lldb/API/LLDB.h"
 
@@ -21,7 +23,6 @@
 
 #include <filesystem>
 #include <vector>
-#include <thread>
 #include <span>
 
 // MARK: Custom main loop
@@ -146,8 +147,12 @@ void SocketIdle() {
     SDL_Event event;
 
     while (true) {
-        if (!SDL_WaitEvent(&event)) {
-            std::terminate();
+        // Time out when the app has a frame due, even without input
+        if (!SDL_WaitEventTimeout(&event, g_app ? g_app->IdleTimeout() : -1)) {
+            if (g_app && g_app->Iterate() != SDL_APP_CONTINUE) {
+                EnterBackgroundMode();
+            }
+            continue;
         }
         if (event.type == kInterruptIdleEvent.type) {
             return;
@@ -184,7 +189,8 @@ namespace {
 
 auto loggerBuffer = std::make_shared<spdlog::sinks::ringbuffer_sink_mt>(1024);
 auto logger = [] {
-    auto logger = spdlog::logger("Injection", loggerBuffer);
+    // The buffer is replayed to the user when injection fails, the log console shows it either way
+    auto logger = spdlog::logger("Injection", { loggerBuffer, std::make_shared<LogRingSink>() });
     
     logger.set_level(spdlog::level::trace);
     logger.flush_on(spdlog::level::trace);
@@ -204,8 +210,7 @@ int* g_socketFDPtr = nullptr;
 
 std::atomic<bool> g_hijackedReadCalled;
 
-std::mutex g_readBufferMutex;
-std::string g_readBuffer;
+std::unique_ptr<SocketRelay> g_relay;
 
 bool IsConnected(void* socket) {
     if (g_hijackedReadCalled.load()) {
@@ -233,7 +238,8 @@ bool IsConnected(void* socket) {
     return true;
 }
 
-size_t Read(void* socket, std::string& buffer, bool append) {
+/// Keeps the app running until there is data to read, returns how much. Zero once the socket closed.
+size_t WaitForData() {
     if (g_hijackedReadCalled.load() == false) {
         EnterForegroundMode();
 
@@ -241,56 +247,46 @@ size_t Read(void* socket, std::string& buffer, bool append) {
     }
 
     while (true) {
-        std::string data;
-        {
-            std::unique_lock lock(g_readBufferMutex);
-
-            data = std::exchange(g_readBuffer, std::string());
+        if (auto available = g_relay->Available()) {
+            return available;
         }
-
-        if (auto read = data.size()) {
-            if (!append) {
-                buffer.clear();
-            }
-            buffer.append(std::move(data));
-            return read;
+        if (g_relay->IsClosed()) {
+            return 0;
         }
 
         SocketIdle();
     }
 }
 
-size_t Read2(void* socket, std::vector<uint8_t>& buffer, bool append) {
-    std::string staging;
-    auto nread = Read(socket, staging, true);
+size_t Read(void* socket, std::string& buffer, bool append) {
+    auto available = WaitForData();
 
     if (!append) {
         buffer.clear();
     }
-    buffer.insert(buffer.end(), staging.begin(), staging.end());
-}
 
-void ReadThread() {
-    char buffer[1024];
+    // Straight from the relay into the caller's buffer
+    auto offset = buffer.size();
 
-    while (true) {
-        auto n_read = read(g_socketFD, buffer, sizeof(buffer));
-        if (n_read == 0) {
-            continue;
-        }
+    buffer.resize_and_overwrite(offset + available, [&](char* data, size_t size) {
+        return offset + g_relay->Read(std::span(reinterpret_cast<uint8_t*>(data) + offset, size - offset));
+    });
+    return available;
+}
 
-        if (n_read == -1) {
-            std::terminate();
-        }
+size_t Read2(void* socket, std::vector<uint8_t>& buffer, bool append) {
+    auto available = WaitForData();
 
-        {
-            std::scoped_lock lock(g_readBufferMutex);
+    if (!append) {
+        buffer.clear();
+    }
 
-            g_readBuffer.append(std::string_view(buffer, n_read));
-        }
+    auto offset = buffer.size();
 
-        SocketIdleInterrupt();
-    }
+    buffer.resize(offset + available);
+    g_relay->Read(std::span(buffer).subspan(offset));
+
+    return available;
 }
 
 template<typename T>
@@ -493,7 +489,7 @@ bool Inject() {
         }
 
         // Spin-up a background thread to read the socket
-        std::thread(ReadThread).detach();
+        g_relay = std::make_unique<SocketRelay>(g_socketFD, SocketIdleInterrupt);
 
         logger.info("Overriding connection vtable");
         vtablePtr = newVTablePtr;
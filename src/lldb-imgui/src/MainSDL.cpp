@@ -1,4 +1,5 @@
 #include "App.h"
+#include "PluginHost.h"
 
 #define SDL_MAIN_USE_CALLBACKS 1
 #include "SDL3/SDL_main.h"
@@ -12,6 +13,11 @@ SDL_AppResult SDLCALL SDL_AppInit(void** appstate, int argc, char* argv[]) {
         args.push_back(argv[i]);
     }
 
+    // Plugin hosts are this executable too, they never open a window of their own
+    if (args.size() == 3 && args[1] == "--plugin-host") {
+        return lldb::imgui::RunPluginHost(args[2]) == 0 ? SDL_APP_SUCCESS : SDL_APP_FAILURE;
+    }
+
     auto* app = new lldb::imgui::App();
     *appstate = app;
 
@@ -21,6 +27,9 @@ SDL_AppResult SDLCALL SDL_AppInit(void** appstate, int argc, char* argv[]) {
 SDL_AppResult SDLCALL SDL_AppIterate(void* appstate) {
     auto* app = reinterpret_cast<lldb::imgui::App*>(appstate);
 
+    // Sleep until there is input, or the app has something to draw
+    SDL_WaitEventTimeout(nullptr, app->IdleTimeout());
+
     return app->Iterate();
 }
 
@@ -33,6 +42,10 @@ SDL_AppResult SDLCALL SDL_AppEvent(void* appstate, SDL_Event *event) {
 void SDLCALL SDL_AppQuit(void* appstate, SDL_AppResult result) {
     auto* app = reinterpret_cast<lldb::imgui::App*>(appstate);
 
+    if (!app) {
+        return;
+    }
+
     app->Quit();
     delete app;
 }
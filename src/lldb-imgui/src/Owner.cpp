@@ -0,0 +1,52 @@
+#include "Owner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace lldb::imgui {
+
+static std::atomic<OwnerID> g_nextOwner = kAppOwner + 1;
+
+static thread_local OwnerID t_owner = kAppOwner;
+
+static std::mutex g_dirtyMutex;
+static std::vector<OwnerID> g_dirtyOwners;
+
+OwnerID NewOwnerID() {
+    return g_nextOwner.fetch_add(1, std::memory_order_relaxed);
+}
+
+OwnerID CurrentOwner() {
+    return t_owner;
+}
+
+void MarkOwnerDirty(OwnerID owner) {
+    if (owner == kAppOwner) {
+        return;
+    }
+
+    std::lock_guard lock(g_dirtyMutex);
+
+    if (std::ranges::find(g_dirtyOwners, owner) == g_dirtyOwners.end()) {
+        g_dirtyOwners.push_back(owner);
+    }
+}
+
+bool TakeOwnerDirty(OwnerID owner) {
+    std::lock_guard lock(g_dirtyMutex);
+
+    return std::erase(g_dirtyOwners, owner) != 0;
+}
+
+OwnerScope::OwnerScope(OwnerID owner)
+: _previous(std::exchange(t_owner, owner))
+{}
+
+OwnerScope::~OwnerScope() {
+    t_owner = _previous;
+}
+
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstdint>
+
+namespace lldb::imgui {
+
+/// Whom code runs on behalf of, so that what it leaves behind can be traced back to it. Each
+/// loaded version of a plugin is an owner of its own.
+using OwnerID = uint64_t;
+
+/// The app itself, and threads plugins start on their own
+inline constexpr OwnerID kAppOwner = 0;
+
+/// Never returns the same owner twice
+OwnerID NewOwnerID();
+
+/// Owner of the code running on the calling thread
+OwnerID CurrentOwner();
+
+/// Marks what `owner` displays out of date, so that it runs again if it is retained. The app
+/// redraws its own output anyway, marking it does nothing.
+///
+/// Safe to call from any thread.
+void MarkOwnerDirty(OwnerID owner);
+
+/// Whether `owner` was marked dirty since the last call
+bool TakeOwnerDirty(OwnerID owner);
+
+/// Runs the calling thread on behalf of `owner` until destroyed
+class OwnerScope {
+public:
+    explicit OwnerScope(OwnerID owner);
+    ~OwnerScope();
+
+    OwnerScope(const OwnerScope&) = delete;
+
+private:
+    OwnerID _previous;
+};
+
+}
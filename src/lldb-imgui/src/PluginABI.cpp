@@ -0,0 +1,51 @@
+#include "PluginABI.h"
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <format>
+
+namespace lldb::imgui {
+
+static constexpr const char* kDescriptorSymbol = "LLDBImGuiPlugin";
+
+template<typename T>
+static void Bind(void* handle, const char* symbol, T& function) {
+    function = reinterpret_cast<T>(dlsym(handle, symbol));
+}
+
+/// Plugins exporting free functions were only ever called through these
+static void BindLegacy(void* handle, PluginDescriptor& descriptor) {
+    Bind(handle, "_Z4Drawv", descriptor.draw);
+    Bind(handle, "_Z12DrawDebuggerRN4lldb10SBDebuggerE", descriptor.drawDebugger);
+}
+
+bool BindPlugin(void* handle, PluginDescriptor& descriptor, std::string& status) {
+    descriptor = PluginDescriptor();
+
+    auto* exported = static_cast<const PluginDescriptor*>(dlsym(handle, kDescriptorSymbol));
+    if (!exported) {
+        BindLegacy(handle, descriptor);
+        return true;
+    }
+
+    if (exported->abiVersion == 0 || exported->abiVersion > kPluginABIVersion) {
+        status = std::format("Failed to load: built for plugin ABI v{}, the app supports up to v{}", exported->abiVersion, kPluginABIVersion);
+        return false;
+    }
+    if (exported->size < offsetof(PluginDescriptor, flags)) {
+        status = std::format("Failed to load: plugin descriptor is too small ({} bytes)", exported->size);
+        return false;
+    }
+
+    // Older plugins know fewer fields, the rest keep their defaults
+    std::memcpy(&descriptor, exported, std::min<size_t>(exported->size, sizeof(PluginDescriptor)));
+
+    descriptor.abiVersion = kPluginABIVersion;
+    descriptor.size = sizeof(PluginDescriptor);
+    return true;
+}
+
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "lldb-imgui/Plugin.h"
+
+#include <string>
+
+namespace lldb::imgui {
+
+/// Fills `descriptor` with the entry points of the plugin loaded as `handle`, from the descriptor
+/// it exports, or from the names of its functions if it predates descriptors. Fails, leaving
+/// `status` explaining why, for descriptors of a newer ABI than the app's.
+bool BindPlugin(void* handle, PluginDescriptor& descriptor, std::string& status);
+
+}
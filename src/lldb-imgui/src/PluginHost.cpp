@@ -0,0 +1,251 @@
+#include "PluginHost.h"
+
+#include "InputReplay.h"
+#include "PluginABI.h"
+#include "RemoteProtocol.h"
+#include "Trace.h"
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include "spdlog/spdlog.h"
+
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb::imgui {
+
+static void ApplyInput(const remote::Input& input) {
+    ImGuiIO& io = ImGui::GetIO();
+
+    io.DisplaySize = input.displaySize;
+    io.DisplayFramebufferScale = input.framebufferScale;
+    io.DeltaTime = std::max(input.deltaTime, 1e-4f);
+
+    // The atlas is built the same way as the app's, only its texture lives over there
+    io.Fonts->SetTexID(input.fontTexture);
+
+    auto numEvents = std::min<uint32_t>(input.numEvents, remote::kMaxInputEvents);
+    ReplayInputEvents(std::span(input.events, numEvents));
+}
+
+/// Writes the frame's draw lists into `slot`, grouped by the root windows they belong to. Returns
+/// the number of bytes written.
+static size_t Publish(uint8_t* slot, uint64_t frame, ImDrawData* drawData) {
+    ImGuiContext& g = *GImGui;
+
+    auto* header = new (slot) remote::Frame {
+        .frame = frame,
+        .wantCaptureMouse = g.IO.WantCaptureMouse,
+        .wantCaptureKeyboard = g.IO.WantCaptureKeyboard,
+    };
+
+    std::unordered_map<ImDrawList*, ImGuiWindow*> owners;
+
+    for (ImGuiWindow* window : g.Windows) {
+        owners.emplace(window->DrawList, window->RootWindow);
+    }
+
+    size_t offset = remote::AlignUp(sizeof(remote::Frame));
+
+    auto put = [&](const void* data, size_t size) {
+        memcpy(slot + offset, data, size);
+        offset += remote::AlignUp(size);
+    };
+
+    std::vector<ImDrawCmd> commands;
+    remote::Window* current = nullptr;
+
+    for (ImDrawList* list : drawData->CmdLists) {
+        // Callbacks point into this process
+        commands.clear();
+
+        for (const auto& command : list->CmdBuffer) {
+            if (!command.UserCallback) {
+                commands.push_back(command);
+            }
+        }
+
+        remote::List listHeader {
+            .numCommands = uint32_t(commands.size()),
+            .numVertices = uint32_t(list->VtxBuffer.Size),
+            .numIndices = uint32_t(list->IdxBuffer.Size),
+        };
+
+        auto size = remote::AlignUp(sizeof(remote::List))
+            + remote::AlignUp(commands.size() * sizeof(ImDrawCmd))
+            + remote::AlignUp(list->VtxBuffer.size_in_bytes())
+            + remote::AlignUp(list->IdxBuffer.size_in_bytes());
+
+        if (offset + size > remote::kSlotSize || header->numLists == remote::kMaxLists) {
+            spdlog::warn("Frame {} does not fit into shared memory, dropping {} draw lists", frame, drawData->CmdListsCount - header->numLists);
+            break;
+        }
+
+        // Lists which belong to no window, like the foreground list, are drawn on top of everything
+        auto it = owners.find(list);
+        auto* root = it != owners.end() ? it->second : nullptr;
+        auto id = root ? root->ID : 0;
+
+        if (!current || current->id != id) {
+            if (header->numWindows == remote::kMaxWindows) {
+                break;
+            }
+
+            current = &header->windows[header->numWindows++];
+            *current = remote::Window {
+                .id = id,
+                .min = root ? root->Pos : ImVec2(),
+                .max = root ? ImVec2(root->Pos.x + root->Size.x, root->Pos.y + root->Size.y) : ImVec2(),
+                .firstList = header->numLists,
+                .numLists = 0,
+            };
+        }
+
+        put(&listHeader, sizeof(listHeader));
+        put(commands.data(), commands.size() * sizeof(ImDrawCmd));
+        put(list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes());
+        put(list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+
+        current->numLists++;
+        header->numLists++;
+    }
+
+    return offset;
+}
+
+/// Whether two published frames of `size` bytes draw the same, whatever their frame numbers
+static bool IsSameFrame(const uint8_t* a, const uint8_t* b, size_t size) {
+    const auto& headerA = *reinterpret_cast<const remote::Frame*>(a);
+    const auto& headerB = *reinterpret_cast<const remote::Frame*>(b);
+
+    if (headerA.wantCaptureMouse != headerB.wantCaptureMouse || headerA.wantCaptureKeyboard != headerB.wantCaptureKeyboard) {
+        return false;
+    }
+    if (headerA.numWindows != headerB.numWindows || headerA.numLists != headerB.numLists) {
+        return false;
+    }
+    if (memcmp(headerA.windows, headerB.windows, headerA.numWindows * sizeof(remote::Window)) != 0) {
+        return false;
+    }
+
+    auto offset = remote::AlignUp(sizeof(remote::Frame));
+    return memcmp(a + offset, b + offset, size - offset) == 0;
+}
+
+int RunPluginHost(const std::filesystem::path& path) {
+    SetTraceThreadName("Plugin host");
+
+    void* mapping = mmap(nullptr, sizeof(remote::Shared), PROT_READ | PROT_WRITE, MAP_SHARED, remote::kSharedMemoryFd, 0);
+    if (mapping == MAP_FAILED) {
+        spdlog::error("Plugin host failed to map shared memory: {}", strerror(errno));
+        return 1;
+    }
+
+    auto* shared = static_cast<remote::Shared*>(mapping);
+    if (shared->magic != remote::kMagic) {
+        spdlog::error("Plugin host started without shared memory");
+        return 1;
+    }
+
+    ImGui::CreateContext();
+    {
+        ImGuiIO& io = ImGui::GetIO();
+
+        io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+        io.IniFilename = nullptr;
+
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    }
+    ImGui::StyleColorsDark();
+
+    auto* handle = dlopen(path.c_str(), RTLD_LOCAL | RTLD_NOW);
+    if (!handle) {
+        spdlog::error("Plugin host failed to load '{}': {}", path.string(), dlerror());
+        return 1;
+    }
+
+    PluginDescriptor descriptor;
+    std::string status;
+
+    if (!BindPlugin(handle, descriptor, status)) {
+        spdlog::error("Plugin host can't run '{}': {}", path.filename().string(), status);
+        return 1;
+    }
+
+    auto* draw = descriptor.draw;
+    if (!draw) {
+        spdlog::error("Plugin host can't run '{}', it has no Draw()", path.filename().string());
+        return 1;
+    }
+
+    uint32_t back = 0;
+    uint64_t frame = 0;
+
+    // Slot of the last frame published, which the app only ever reads
+    std::optional<uint32_t> published;
+    size_t publishedSize = 0;
+
+    while (true) {
+        uint8_t wakeup = 0;
+
+        auto result = read(remote::kSocketFd, &wakeup, 1);
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+        if (result <= 0) {
+            // The app is gone
+            break;
+        }
+
+        TRACE_ZONE("Plugin host frame");
+
+        ApplyInput(shared->input);
+
+        ImGui::NewFrame();
+        draw();
+        ImGui::Render();
+
+        // The app keeps showing unchanged frames without drawing again
+        auto size = Publish(shared->slots[back], frame++, ImGui::GetDrawData());
+
+        if (!published || size != publishedSize || !IsSameFrame(shared->slots[back], shared->slots[*published], size)) {
+            published = back;
+            publishedSize = size;
+
+            back = shared->latest.exchange(back | remote::kFresh, std::memory_order_acq_rel) & ~remote::kFresh;
+        }
+
+        // Set before answering, the app looks for it once it is answered
+        if (auto deadline = TakeRedrawDeadline()) {
+            auto ticks = deadline->time_since_epoch().count();
+            auto current = shared->redrawDeadline.load();
+
+            while ((current == 0 || ticks < current) && !shared->redrawDeadline.compare_exchange_weak(current, ticks)) {}
+        }
+
+        if (write(remote::kSocketFd, &wakeup, 1) != 1) {
+            break;
+        }
+    }
+
+    dlclose(handle);
+    ImGui::DestroyContext();
+    return 0;
+}
+
+}
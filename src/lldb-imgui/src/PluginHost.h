@@ -0,0 +1,17 @@
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+
+namespace lldb::imgui {
+
+/// Entry point of plugin host processes, started by `RemotePlugin` with `--plugin-host <path>`. Draws
+/// the plugin at `path` whenever the app asks for a frame, until the app goes away.
+int RunPluginHost(const std::filesystem::path& path);
+
+/// Takes the earliest frame requested through `RequestRedraw`, which hosts hand over to the app as
+/// they have no frame loop of their own. Lives along with the app's frame loop.
+std::optional<std::chrono::steady_clock::time_point> TakeRedrawDeadline();
+
+}
@@ -0,0 +1,494 @@
+#include "PluginLoader.h"
+
+#include "lldb-imgui/API.h"
+#include "lldb-imgui/Events.h"
+#include "lldb-imgui/State.h"
+
+#include "Owner.h"
+#include "PluginABI.h"
+#include "PluginProfile.h"
+#include "PluginSchedule.h"
+#include "QueryEngine.h"
+#include "RemotePlugin.h"
+#include "ThreadPool.h"
+#include "Trace.h"
+#include "ValueCache.h"
+
+#include "lldb/API/SBDebugger.h"
+
+#include "imgui.h"
+
+#include "spdlog/spdlog.h"
+
+#include <dlfcn.h>
+
+#include <algorithm>
+#include <atomic>
+#include <format>
+#include <optional>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// How often a reload waiting for the query thread to let go of the plugin is retried
+static constexpr auto kReloadRetryInterval = std::chrono::milliseconds(10);
+
+struct PluginLoader::Plugin {
+    PluginSpec spec;
+
+    void* handle = nullptr;
+    std::string status;
+
+    // Queries submitted by the loaded version, a new one for each version
+    OwnerID owner = kAppOwner;
+
+    // Written by the watcher, zero when no reload is pending
+    std::atomic<Clock::rep> reloadRequestedAt = 0;
+
+    std::unique_ptr<FileWatch> watch;
+
+    // Start of the change which triggered the last reload, until the first draw call reports on it
+    std::optional<Clock::time_point> reloadLatencyStart;
+
+    PluginProfile profile;
+    PluginSchedule schedule;
+
+    // Zone of the draw calls, named after the plugin
+    const TraceName* traceName = nullptr;
+
+    // Host drawing the plugin when it runs out of process
+    std::unique_ptr<RemotePlugin> remote;
+
+    // Entry points and capabilities of the DSO
+    PluginDescriptor descriptor;
+
+    // Handed over from the previous version, freed once the version it was handed to is closed.
+    // Waits for the next version while none is loaded.
+    std::unique_ptr<PluginState> state;
+
+    void ReportReloadLatency();
+};
+
+PluginLoader::PluginLoader(ThreadPool& threadPool)
+: _threadPool(threadPool)
+{}
+
+PluginLoader::~PluginLoader() = default;
+
+void PluginLoader::Update(PluginID id, PluginSpec spec) {
+    auto [it, added] = _plugins.try_emplace(id);
+    if (added) {
+        it->second = std::make_unique<Plugin>();
+        it->second->spec.isEnabled = false;
+        it->second->spec.isAutoReload = false;
+    }
+
+    auto& plugin = *it->second;
+
+    const auto old = std::exchange(plugin.spec, spec);
+
+    if (spec.path != old.path || spec.isEnabled != old.isEnabled || spec.isOutOfProcess != old.isOutOfProcess) {
+        if (spec.path != old.path || !spec.isEnabled) {
+            Unload(plugin);
+
+            // Only reloads of the same plugin hand their state over
+            plugin.state.reset();
+        }
+        if (spec.isEnabled) {
+            Load(plugin);
+        }
+    }
+    if (spec.path != old.path || spec.isAutoReload != old.isAutoReload) {
+        plugin.watch.reset();
+
+        if (spec.isAutoReload) {
+            // The plugin is heap allocated, and the watch is destroyed before it
+            auto callback = [&plugin](Clock::time_point changedAt) {
+                plugin.reloadRequestedAt.store(changedAt.time_since_epoch().count());
+
+                // Reloads are picked up by the next frame
+                RequestRedraw();
+            };
+            plugin.watch = Watch(spec.path, callback);
+        }
+    }
+}
+
+void PluginLoader::Remove(PluginID id) {
+    auto it = _plugins.find(id);
+    if (it == _plugins.end()) {
+        return;
+    }
+
+    it->second->watch.reset();
+    Unload(*it->second);
+
+    _plugins.erase(it);
+}
+
+void PluginLoader::DrawMenu(PluginID id) {
+    using namespace ImGui;
+
+    auto it = _plugins.find(id);
+    if (it == _plugins.end()) {
+        return;
+    }
+
+    const Plugin& plugin = *it->second;
+
+    if (plugin.status.size() != 0) {
+        TextDisabled("%s", plugin.status.c_str());
+    }
+    if (plugin.handle) {
+        plugin.profile.DrawMenu();
+    }
+    if (plugin.handle && plugin.schedule.Interval() > 1) {
+        TextDisabled("Throttled: runs every %d frames", plugin.schedule.Interval());
+    }
+    if (plugin.descriptor.flags & kPluginRetained) {
+        TextDisabled("Retained: runs only when its inputs change");
+    }
+}
+
+void PluginLoader::DrawBlame() {
+    std::vector<PluginProfile::BlameEntry> entries;
+
+    for (const auto& [_, plugin] : _plugins) {
+        if (plugin->handle) {
+            entries.push_back(PluginProfile::BlameEntry {
+                .name = plugin->spec.path.stem().generic_string(),
+                .profile = &plugin->profile,
+            });
+        }
+    }
+
+    PluginProfile::DrawBlame(entries);
+}
+
+void PluginLoader::SetFrameBudget(float ms) {
+    _frameBudgetMs = ms;
+}
+
+void PluginLoader::ProcessPendingReloads() {
+    for (auto& [_, plugin] : _plugins) {
+        auto requestedAt = plugin->reloadRequestedAt.exchange(0);
+        if (requestedAt == 0 || !plugin->spec.isEnabled) {
+            continue;
+        }
+
+        if (Load(*plugin)) {
+            plugin->reloadLatencyStart = Clock::time_point(Clock::duration(requestedAt));
+        }
+    }
+}
+
+void PluginLoader::DrawPlugins() {
+    CloseReleased();
+    ProcessPendingReloads();
+
+    _frame++;
+
+    auto loaded = std::count_if(_plugins.begin(), _plugins.end(), [](const auto& entry) {
+        return entry.second->handle != nullptr;
+    });
+    auto share = _frameBudgetMs / std::max<float>(loaded, 1);
+
+    for (auto& [_, entry] : _plugins) {
+        auto& plugin = *entry;
+        auto cost = plugin.profile.BeginFrame();
+
+        if (!plugin.handle) {
+            continue;
+        }
+
+        if (plugin.remote && !plugin.remote->IsRunning(plugin.status)) {
+            spdlog::error("Plugin '{}' stopped: {}", plugin.spec.path.filename().string(), plugin.status);
+            plugin.remote.reset();
+        }
+        if (plugin.remote) {
+            TraceZone zone(plugin.traceName);
+            plugin.profile.Measure([&] {
+                plugin.remote->Draw();
+            });
+        }
+
+        const auto& descriptor = plugin.descriptor;
+
+        plugin.schedule.BeginFrame(_frame, cost, share, descriptor.updateRate, descriptor.flags & kPluginRetained);
+
+        if (descriptor.draw && plugin.schedule.IsRunning()) {
+            plugin.ReportReloadLatency();
+
+            OwnerScope owner(plugin.owner);
+            TraceZone zone(plugin.traceName);
+            plugin.profile.Measure([&] {
+                plugin.schedule.Track(descriptor.draw);
+            });
+        }
+    }
+}
+
+void PluginLoader::PrepareDebuggers(std::span<lldb::SBDebugger> debuggers) {
+    // A plugin prepares one debugger after the other, only plugins run alongside each other
+    struct Job {
+        Plugin* plugin;
+
+        float ms = 0;
+    };
+    std::vector<Job> jobs;
+
+    for (auto& [_, entry] : _plugins) {
+        auto& plugin = *entry;
+
+        if (!plugin.descriptor.prepare || !plugin.schedule.IsRunning()) {
+            continue;
+        }
+
+        // Retained output of prepared state goes out of date with the debugger's
+        if (plugin.descriptor.flags & kPluginRetained) {
+            for (auto& debugger : debuggers) {
+                WatchDebugger(debugger, plugin.owner);
+            }
+        }
+
+        if (plugin.descriptor.flags & kPluginThreadSafe) {
+            jobs.push_back(Job { .plugin = &plugin });
+            continue;
+        }
+
+        OwnerScope owner(plugin.owner);
+        TraceZone zone(plugin.traceName);
+        plugin.profile.Measure([&] {
+            for (auto& debugger : debuggers) {
+                plugin.descriptor.prepare(debugger);
+            }
+        });
+    }
+
+    // Profiles count draw output through ImGui, so workers only time their calls
+    _threadPool.ParallelFor(jobs.size(), [&](size_t i) {
+        auto& job = jobs[i];
+        auto start = Clock::now();
+        {
+            OwnerScope owner(job.plugin->owner);
+            TraceZone zone(job.plugin->traceName);
+
+            for (auto& debugger : debuggers) {
+                job.plugin->descriptor.prepare(debugger);
+            }
+        }
+        job.ms = std::chrono::duration<float, std::milli>(Clock::now() - start).count();
+    });
+
+    for (const auto& job : jobs) {
+        job.plugin->profile.Add(job.ms);
+    }
+}
+
+void PluginLoader::DrawDebugger(lldb::SBDebugger& debugger) {
+    for (auto& [_, entry] : _plugins) {
+        auto& plugin = *entry;
+
+        if (plugin.descriptor.drawDebugger && plugin.schedule.IsRunning()) {
+            plugin.ReportReloadLatency();
+
+            if (plugin.descriptor.flags & kPluginRetained) {
+                WatchDebugger(debugger, plugin.owner);
+            }
+
+            OwnerScope owner(plugin.owner);
+            TraceZone zone(plugin.traceName);
+            plugin.profile.Measure([&] {
+                plugin.schedule.Track([&] {
+                    plugin.descriptor.drawDebugger(debugger);
+                });
+            });
+        }
+    }
+}
+
+// Throttled plugins get their events all the same, they would miss them otherwise
+void PluginLoader::DeliverEvents(lldb::SBDebugger& debugger, const DebuggerEvents& events) {
+    for (auto& [_, entry] : _plugins) {
+        auto& plugin = *entry;
+
+        if (!plugin.handle || !(events.Kinds() & plugin.descriptor.events)) {
+            continue;
+        }
+
+        plugin.schedule.MarkOutOfDate();
+
+        if (plugin.descriptor.onDebuggerEvents) {
+            OwnerScope owner(plugin.owner);
+            TraceZone zone(plugin.traceName);
+            plugin.profile.Measure([&] {
+                plugin.descriptor.onDebuggerEvents(debugger, events);
+            });
+        }
+    }
+}
+
+void PluginLoader::EndFrame(ImDrawData* drawData) {
+    _schedules.clear();
+
+    for (auto& [_, plugin] : _plugins) {
+        if (plugin->handle) {
+            _schedules.push_back(&plugin->schedule);
+        }
+        if (plugin->remote) {
+            plugin->remote->EndFrame(drawData);
+        }
+    }
+
+    PluginSchedule::EndFrame(_schedules);
+}
+
+bool PluginLoader::Load(Plugin& plugin) {
+    TRACE_ZONE("Load plugin");
+
+    // Reset status
+    plugin.status = "";
+
+    if (!Preflight(plugin.spec.path, plugin.status)) {
+        return false;
+    }
+
+    // Neither version can be loaded while the query thread still runs code of the current one, and
+    // dlopen would hand a version which is yet to be closed back
+    if ((plugin.handle && IsQueryRunning(plugin.owner)) || IsClosing(plugin.spec.path)) {
+        CancelQueries(plugin.owner);
+
+        Clock::rep expected = 0;
+        plugin.reloadRequestedAt.compare_exchange_strong(expected, Clock::now().time_since_epoch().count());
+        plugin.status = "Reloading once its queries finished";
+
+        RequestRedraw(kReloadRetryInterval);
+        return false;
+    }
+
+    // Preflights passed, let the current version hand its state over, and displace it. A state no
+    // version took yet waits for this one.
+    std::unique_ptr<PluginState> state;
+
+    if (!plugin.handle) {
+        state = std::move(plugin.state);
+    } else if (plugin.descriptor.saveState) {
+        TRACE_ZONE("Save plugin state");
+
+        OwnerScope owner(plugin.owner);
+
+        state = std::make_unique<PluginState>();
+        plugin.descriptor.saveState(*state);
+    }
+    Unload(plugin);
+
+    plugin.handle = dlopen(plugin.spec.path.c_str(), RTLD_LOCAL | RTLD_NOW);
+
+    if (!plugin.handle) {
+        plugin.status = std::format("Failed to load: {}", dlerror());
+        plugin.state = std::move(state);
+        return false;
+    }
+
+    if (!BindPlugin(plugin.handle, plugin.descriptor, plugin.status)) {
+        Unload(plugin);
+        plugin.state = std::move(state);
+        return false;
+    }
+
+    plugin.state = std::move(state);
+
+    plugin.owner = NewOwnerID();
+    plugin.profile.Reset();
+    plugin.schedule.Reset(plugin.owner);
+    plugin.traceName = InternTraceName(plugin.spec.path.stem().string());
+    plugin.status = "Loaded";
+
+    if (plugin.state && plugin.descriptor.restoreState) {
+        TRACE_ZONE("Restore plugin state");
+
+        OwnerScope owner(plugin.owner);
+        plugin.descriptor.restoreState(*plugin.state);
+        spdlog::info("Handed {} KiB of state over to the new version of '{}'", plugin.state->Size() / 1024, plugin.spec.path.filename().string());
+    } else {
+        plugin.state.reset();
+    }
+
+    // The host takes over `Draw()`, the rest stays where the debuggers are
+    if (plugin.spec.isOutOfProcess && plugin.descriptor.draw) {
+        plugin.remote = RemotePlugin::Spawn(plugin.spec.path, plugin.status);
+
+        if (plugin.remote) {
+            plugin.descriptor.draw = nullptr;
+            plugin.status = std::format("Loaded, drawing in process {}", plugin.remote->Pid());
+        }
+    }
+    return true;
+}
+
+void PluginLoader::Unload(Plugin& plugin) {
+    TRACE_ZONE("Unload plugin");
+
+    plugin.descriptor = PluginDescriptor();
+
+    plugin.schedule.Reset();
+    plugin.remote.reset();
+
+    plugin.reloadLatencyStart.reset();
+
+    if (plugin.handle) {
+        // Queued queries reference the plugin's code, and the query thread may be running one
+        CancelQueries(plugin.owner);
+        ForgetValues(plugin.owner);
+
+        auto handle = std::exchange(plugin.handle, nullptr);
+
+        // The state handed to this version may be in use until its code is gone
+        if (IsQueryRunning(plugin.owner)) {
+            _closing.push_back(Closing { .owner = plugin.owner, .handle = handle, .state = std::move(plugin.state) });
+        } else {
+            dlclose(handle);
+            plugin.state.reset();
+        }
+    }
+}
+
+void PluginLoader::CloseReleased() {
+    std::erase_if(_closing, [](const Closing& closing) {
+        if (IsQueryRunning(closing.owner)) {
+            RequestRedraw(kReloadRetryInterval);
+            return false;
+        }
+
+        dlclose(closing.handle);
+        return true;
+    });
+}
+
+bool PluginLoader::IsClosing(const std::filesystem::path& path) {
+    if (_closing.empty()) {
+        return false;
+    }
+
+    void* handle = dlopen(path.c_str(), RTLD_LAZY | RTLD_NOLOAD);
+    if (!handle) {
+        return false;
+    }
+    dlclose(handle);
+
+    return std::ranges::find(_closing, handle, &Closing::handle) != _closing.end();
+}
+
+void PluginLoader::Plugin::ReportReloadLatency() {
+    if (!reloadLatencyStart) {
+        return;
+    }
+
+    auto latency = std::chrono::duration<double, std::milli>(Clock::now() - *reloadLatencyStart);
+    reloadLatencyStart.reset();
+
+    status = std::format("Loaded, reloaded in {:.1f} ms", latency.count());
+    spdlog::info("Reloaded '{}' in {:.1f} ms", spec.path.filename().string(), latency.count());
+}
+
+}
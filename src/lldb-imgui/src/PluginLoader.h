@@ -1,7 +1,18 @@
 #pragma once
 
+#include "Owner.h"
+
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct ImDrawData;
 
 namespace lldb {
 class SBDebugger;
@@ -9,6 +20,11 @@ class SBDebugger;
 
 namespace lldb::imgui {
 
+struct DebuggerEvents;
+class PluginSchedule;
+class PluginState;
+class ThreadPool;
+
 /// Unique identifier of a plugin instance
 using PluginID = uint32_t;
 
@@ -18,23 +34,99 @@ struct PluginSpec {
 
     bool isEnabled = true;
     bool isAutoReload = false;
+
+    /// Draws the plugin in a plugin host process, where it can't take the app down with it
+    bool isOutOfProcess = false;
 };
 
-/// Platform specific plugin loader implementation
+/// Loads plugins, and calls them each frame. Validating and watching plugin files is up to the
+/// platform specific subclass.
 class PluginLoader {
 public:
-    static std::unique_ptr<PluginLoader> Create();
+    using Clock = std::chrono::steady_clock;
+
+    /// Thread safe plugins prepare on `threadPool`, which has to outlive the loader
+    static std::unique_ptr<PluginLoader> Create(ThreadPool& threadPool);
+
+    virtual ~PluginLoader();
+
+    PluginLoader(const PluginLoader&) = delete;
 
-    virtual ~PluginLoader() = default;
+    void Update(PluginID, PluginSpec);
+    void Remove(PluginID);
 
-    virtual void Update(PluginID, PluginSpec) = 0;
-    virtual void Remove(PluginID) = 0;
+    void DrawMenu(PluginID);
 
-    virtual void DrawMenu(PluginID) = 0;
+    /// Frame time statistics of all loaded plugins, worst first
+    void DrawBlame();
+
+    /// Total time plugins may take per frame before the slowest ones get throttled, zero to disable
+    void SetFrameBudget(float ms);
 
     // TODO: Create a proper extension manager
-    virtual void DrawPlugins() = 0;
-    virtual void DrawDebugger(lldb::SBDebugger&) = 0;
+    void DrawPlugins();
+
+    /// Runs the `prepare` entry points of the plugins running this frame, in parallel where they
+    /// allow it. Each plugin prepares the debuggers one after the other. Returns once all of them
+    /// finished, before anything draws the debuggers.
+    void PrepareDebuggers(std::span<lldb::SBDebugger>);
+    void DrawDebugger(lldb::SBDebugger&);
+
+    /// Hands the events since the last frame to the plugins which take them, before they draw
+    void DeliverEvents(lldb::SBDebugger&, const DebuggerEvents&);
+
+    /// Called with the frame's final draw data, before it is rendered
+    void EndFrame(ImDrawData*);
+
+    /// Watch over a plugin file, stops watching once destroyed
+    class FileWatch {
+    public:
+        virtual ~FileWatch() = default;
+    };
+
+protected:
+    explicit PluginLoader(ThreadPool& threadPool);
+
+    /// Checks whether the file at `path` can be loaded, without running any of its code
+    virtual bool Preflight(const std::filesystem::path& path, std::string& status) = 0;
+
+    /// Calls `callback` with the time of the change whenever the file at `path` changes, from any
+    /// thread
+    virtual std::unique_ptr<FileWatch> Watch(const std::filesystem::path& path, std::function<void(Clock::time_point)> callback) = 0;
+
+private:
+    struct Plugin;
+
+    bool Load(Plugin& plugin);
+    void Unload(Plugin& plugin);
+
+    void ProcessPendingReloads();
+
+    /// Closes the unloaded plugins the query thread let go of
+    void CloseReleased();
+
+    /// Whether the file at `path` is an unloaded plugin yet to be closed
+    bool IsClosing(const std::filesystem::path& path);
+
+    std::unordered_map<PluginID, std::unique_ptr<Plugin>> _plugins;
+
+    // Unloaded plugins whose code the query thread still runs
+    struct Closing {
+        OwnerID owner;
+        void* handle;
+
+        // Handed to the unloaded version, freed after it is closed
+        std::unique_ptr<PluginState> state;
+    };
+    std::vector<Closing> _closing;
+
+    // Schedules of the loaded plugins, kept around for each frame's end
+    std::vector<PluginSchedule*> _schedules;
+
+    ThreadPool& _threadPool;
+
+    uint64_t _frame = 0;
+    float _frameBudgetMs = 0;
 };
 
 }
@@ -0,0 +1,197 @@
+#include "PluginLoader.h"
+
+#include "ElfFile.h"
+#include "Expose.h"
+#include "Trace.h"
+
+#include "spdlog/spdlog.h"
+
+#include <sys/inotify.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <chrono>
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <functional>
+#include <optional>
+#include <thread>
+
+namespace lldb::imgui {
+
+using Clock = std::chrono::steady_clock;
+
+/// Watches a single file through an inotify watch on its parent directory
+///
+/// Linkers tend to produce a burst of create/write/rename events for a single output, so the callback
+/// is only fired once the file has been quiet for `kDebounce`. The callback receives the time of the
+/// first event in the burst, and is invoked on the watcher's own thread.
+class FileSystemWatcher final : public PluginLoader::FileWatch {
+public:
+    static constexpr auto kDebounce = std::chrono::milliseconds(50);
+
+    FileSystemWatcher(std::filesystem::path fsPath, std::function<void(Clock::time_point)> callback)
+    : _fileName(fsPath.filename())
+    , _callback(std::move(callback)) {
+        _inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        _wakeup = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+        // Watching the file itself would lose track of it once the linker renames a new one over it
+        auto directory = fsPath.parent_path();
+        auto mask = IN_CLOSE_WRITE | IN_MODIFY | IN_CREATE | IN_MOVED_TO | IN_ATTRIB;
+
+        if (_inotify == -1 || _wakeup == -1 || inotify_add_watch(_inotify, directory.c_str(), mask) == -1) {
+            spdlog::error("Failed to watch '{}' for changes: {}", directory.string(), strerror(errno));
+            return;
+        }
+
+        _thread = std::thread([this] {
+            Run();
+        });
+    }
+
+    ~FileSystemWatcher() {
+        if (_thread.joinable()) {
+            uint64_t value = 1;
+            write(_wakeup, &value, sizeof(value));
+
+            _thread.join();
+        }
+
+        if (_inotify != -1) {
+            close(_inotify);
+        }
+        if (_wakeup != -1) {
+            close(_wakeup);
+        }
+    }
+
+private:
+    /// Consumes all pending inotify events, returns whether any of them concerned our file
+    bool Drain() {
+        alignas(inotify_event) char buffer[4096];
+
+        bool relevant = false;
+
+        while (true) {
+            auto length = read(_inotify, buffer, sizeof(buffer));
+            if (length <= 0) {
+                return relevant;
+            }
+
+            for (char* ptr = buffer; ptr < buffer + length; ) {
+                auto* event = reinterpret_cast<inotify_event*>(ptr);
+
+                if (event->len != 0 && _fileName == event->name) {
+                    relevant = true;
+                }
+
+                ptr += sizeof(inotify_event) + event->len;
+            }
+        }
+    }
+
+    void Run() {
+        std::optional<Clock::time_point> burstStart;
+        Clock::time_point deadline;
+
+        while (true) {
+            int timeout = -1;
+
+            if (burstStart) {
+                auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - Clock::now());
+
+                timeout = std::max<int>(0, remaining.count());
+            }
+
+            pollfd fds[] = {
+                { .fd = _inotify, .events = POLLIN },
+                { .fd = _wakeup, .events = POLLIN },
+            };
+            if (poll(fds, std::size(fds), timeout) == -1 && errno != EINTR) {
+                spdlog::error("Failed to poll for changes of '{}': {}", _fileName.string(), strerror(errno));
+                return;
+            }
+
+            if (fds[1].revents & POLLIN) {
+                return;
+            }
+
+            auto now = Clock::now();
+
+            if ((fds[0].revents & POLLIN) && Drain()) {
+                if (!burstStart) {
+                    burstStart = now;
+                }
+                deadline = now + kDebounce;
+            }
+
+            if (burstStart && now >= deadline) {
+                _callback(*std::exchange(burstStart, std::nullopt));
+            }
+        }
+    }
+
+    std::filesystem::path _fileName;
+    std::function<void(Clock::time_point)> _callback;
+
+    int _inotify = -1;
+    int _wakeup = -1;
+
+    std::thread _thread;
+};
+
+class PluginLoaderLinux final : public PluginLoader {
+public:
+    explicit PluginLoaderLinux(ThreadPool& threadPool)
+    : PluginLoader(threadPool)
+    {}
+
+protected:
+    bool Preflight(const std::filesystem::path& path, std::string& status) override;
+
+    std::unique_ptr<FileWatch> Watch(const std::filesystem::path& path, std::function<void(Clock::time_point)> callback) override {
+        return std::make_unique<FileSystemWatcher>(path, std::move(callback));
+    }
+};
+
+bool PluginLoaderLinux::Preflight(const std::filesystem::path& path, std::string& status) {
+    TRACE_ZONE("Preflight plugin");
+
+    // There is no `dlopen_preflight` here, validate the file by hand instead
+    auto elf = ElfFile::Open(path, status);
+    if (!elf) {
+        return false;
+    }
+
+    const auto& header = elf->Header();
+
+    if (header.e_type != ET_DYN) {
+        status = "Failed to load: not a shared object";
+        return false;
+    }
+    if (header.e_machine != ElfFile::kHostMachine) {
+        status = std::format("Failed to load: built for a different architecture ({})", header.e_machine);
+        return false;
+    }
+
+    // Check whether all EXPOSE'd symbols are available
+    if (auto* section = elf->FindSection("exposed_symbols")) {
+        for (auto symbol : ExposeSection(elf->SectionArray<char>(*section))) {
+            if (status.empty()) {
+                status = "Failed to load: EXPOSE'd symbol(s) missing:";
+            }
+            status.append(std::format("\n - {}", symbol));
+        }
+    }
+    return status.empty();
+}
+
+std::unique_ptr<PluginLoader> PluginLoader::Create(ThreadPool& threadPool) {
+    return std::make_unique<PluginLoaderLinux>(threadPool);
+}
+
+}
@@ -1,8 +1,7 @@
 #include "PluginLoader.h"
 
 #include "Expose.h"
-
-#include "imgui.h"
+#include "Trace.h"
 
 #include <Foundation/Foundation.h>
 #include <CoreServices/CoreServices.h>
@@ -11,13 +10,14 @@
 #include <mach-o/utils.h>
 #include <mach-o/getsect.h>
 
-#include <print>
+#include <format>
 #include <filesystem>
 #include <functional>
+#include <span>
 
 namespace lldb::imgui {
 
-class FileSystemWatcher {
+class FileSystemWatcher final : public PluginLoader::FileWatch {
 public:
     FileSystemWatcher(std::filesystem::path fsPath, bool isDirectory, std::function<void()> callback)
     : _callback(std::move(callback)) {
@@ -71,168 +71,53 @@ private:
 
 class PluginLoaderMacOS final : public PluginLoader {
 public:
-    void Update(PluginID, PluginSpec) override;
-    void Remove(PluginID) override;
-
-    void DrawMenu(PluginID) override;
-
-    void DrawPlugins() override;
-    void DrawDebugger(lldb::SBDebugger&) override;
-
-private:
-    struct Plugin {
-        PluginSpec spec;
-
-        void* handle = nullptr;
-        std::string status;
-
-        std::optional<FileSystemWatcher> watcher;
-
-        // DSO
-        void (*draw)() = nullptr;
-        void (*drawDebugger)(lldb::SBDebugger&) = nullptr;
-
-        void Load();
-        void Unload();
-    };
-
-    std::unordered_map<PluginID, Plugin> _plugins;
-};
-
-void PluginLoaderMacOS::Update(PluginID id, PluginSpec spec) {
-    auto [it, added] = _plugins.try_emplace(id);
-    auto& plugin = it->second;
-
-    if (added) {
-        plugin.spec.isEnabled = false;
-        plugin.spec.isAutoReload = false;
-    }
-
-    const auto old = std::exchange(plugin.spec, spec);
-
-    if (spec.path != old.path || spec.isEnabled != old.isEnabled) {
-        if (spec.isEnabled) {
-            plugin.Load();
-        } else {
-            plugin.Unload();
-        }
-    }
-    if (spec.path != old.path || spec.isAutoReload != old.isAutoReload) {
-        if (spec.isAutoReload) {
-            auto callback = [this, id] {
-                auto it = _plugins.find(id);
-                if (it == _plugins.end()) {
-                    return;
-                }
-
-                if (it->second.spec.isEnabled) {
-                    it->second.Load();
-                }
-            };
-            plugin.watcher.emplace(spec.path, false, callback);
-        } else {
-            plugin.watcher.reset();
-        }
-    }
-
-    return true;
-}
-
-void PluginLoaderMacOS::Remove(PluginID id) {
-    _plugins.erase(id);
-}
-
-void PluginLoaderMacOS::DrawMenu(PluginID id) {
-    using namespace ImGui;
-
-    auto it = _plugins.find(id);
-    if (it == _plugins.end()) {
-        return;
+    explicit PluginLoaderMacOS(ThreadPool& threadPool)
+    : PluginLoader(threadPool)
+    {}
+
+protected:
+    bool Preflight(const std::filesystem::path& path, std::string& status) override;
+
+    // FSEvents coalesces changes on its own, and only reports them after its latency passed
+    std::unique_ptr<FileWatch> Watch(const std::filesystem::path& path, std::function<void(Clock::time_point)> callback) override {
+        return std::make_unique<FileSystemWatcher>(path, false, [callback = std::move(callback)] {
+            callback(Clock::now());
+        });
     }
+};
 
-    const Plugin& plugin = it->second;
-
-    if (plugin.status.size() != 0) {
-        TextDisabled("%s", plugin.status.c_str());
-    }
-}
-
-void PluginLoaderMacOS::DrawPlugins() {
-    for (auto& [_, plugin] : _plugins) {
-        if (plugin.draw) {
-            plugin.draw();
-        }
-    }
-}
-
-void PluginLoaderMacOS::DrawDebugger(lldb::SBDebugger& debugger) {
-    for (auto& [_, plugin] : _plugins) {
-        if (plugin.drawDebugger) {
-            plugin.drawDebugger(debugger);
-        }
-    }
-}
-
-void PluginLoaderMacOS::Plugin::Load() {
-    std::string path = spec.path.string();
+bool PluginLoaderMacOS::Preflight(const std::filesystem::path& fsPath, std::string& status) {
+    TRACE_ZONE("Preflight plugin");
 
-    // Reset status
-    status = "";
+    std::string path = fsPath.string();
 
     // Normal dyld preflight
     if (!dlopen_preflight(path.c_str())) {
         status = dlerror();
-        return;
+        return false;
     }
 
-    // Check whether all EXPOSE'd symbols are available
+    // Check whether all EXPOSE'd symbols are available, blocks capture the status by value otherwise
+    std::string* missing = &status;
+
     macho_best_slice(path.c_str(), ^(const struct mach_header* slice, uint64_t sliceOffset, size_t sliceSize) {
         auto* header = reinterpret_cast<const struct mach_header_64*>(slice);
 
         unsigned long size = 0;
-        auto symbol = (const char*) getsectiondata(header, "__CONST", "exposed_symbols", &size);
-        auto end = symbol + size;
-
-        for (; symbol < end; symbol += strlen(symbol) + 1) {
-            if (Expose(symbol)) {
-                continue;
-            }
+        auto data = (const char*) getsectiondata(header, "__CONST", "exposed_symbols", &size);
 
-            if (status.empty()) {
-                status = "Failed to load: EXPOSE'd symbol(s) missing:";
+        for (auto symbol : ExposeSection(std::span(data, size))) {
+            if (missing->empty()) {
+                *missing = "Failed to load: EXPOSE'd symbol(s) missing:";
             }
-            status.append(std::format("\n - {}", symbol));
+            missing->append(std::format("\n - {}", symbol));
         }
     });
-    if (!status.empty()) {
-        return;
-    }
-
-    // Preflights passed, displace current version
-    Unload();
-
-    handle = dlopen(spec.path.c_str(), RTLD_LOCAL | RTLD_NOW);
-
-    if (!handle) {
-        status = std::format("Failed to load: {}", dlerror());
-        return;
-    }
-
-    draw = reinterpret_cast<decltype(draw)>(dlsym(handle, "_Z4Drawv"));
-    drawDebugger = reinterpret_cast<decltype(drawDebugger)>(dlsym(handle, "_Z12DrawDebuggerRN4lldb10SBDebuggerE"));
-
-    status = "Loaded";
-}
-
-void PluginLoaderMacOS::Plugin::Unload() {
-    draw = nullptr;
-    drawDebugger = nullptr;
-
-    dlclose(std::exchange(handle, nullptr));
+    return status.empty();
 }
 
-std::unique_ptr<PluginLoader> PluginLoader::Create() {
-    return std::make_unique<PluginLoaderMacOS>();
+std::unique_ptr<PluginLoader> PluginLoader::Create(ThreadPool& threadPool) {
+    return std::make_unique<PluginLoaderMacOS>(threadPool);
 }
 
 }
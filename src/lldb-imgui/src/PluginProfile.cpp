@@ -0,0 +1,167 @@
+#include "PluginProfile.h"
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Plugins above this are highlighted in the blame table
+static constexpr float kLagThresholdMs = 8.0f;
+
+std::optional<float> PluginProfile::BeginFrame() {
+    if (!std::exchange(_hasCurrent, false)) {
+        return std::nullopt;
+    }
+
+    auto& sample = _samples[_head];
+
+    sample = std::exchange(_current, Sample());
+    _head = (_head + 1) % kCapacity;
+    _count = std::min(_count + 1, kCapacity);
+
+    return sample.ms;
+}
+
+void PluginProfile::Reset() {
+    _head = 0;
+    _count = 0;
+
+    _current = Sample();
+    _hasCurrent = false;
+}
+
+PluginProfile::Summary PluginProfile::Summarize() const {
+    if (_count == 0) {
+        return {};
+    }
+
+    std::array<float, kCapacity> times;
+
+    int drawCommands = 0;
+    int vertices = 0;
+
+    for (size_t i = 0; i < _count; i++) {
+        times[i] = _samples[i].ms;
+
+        drawCommands += _samples[i].drawCommands;
+        vertices += _samples[i].vertices;
+    }
+    std::sort(times.begin(), times.begin() + _count);
+
+    return Summary {
+        .p50 = times[_count / 2],
+        .p99 = times[std::min(_count * 99 / 100, _count - 1)],
+        .max = times[_count - 1],
+
+        .drawCommands = drawCommands / int(_count),
+        .vertices = vertices / int(_count),
+    };
+}
+
+void PluginProfile::DrawMenu() const {
+    using namespace ImGui;
+
+    if (_count == 0) {
+        TextDisabled("No frames drawn yet");
+        return;
+    }
+
+    auto summary = Summarize();
+
+    TextDisabled("Frame: p50 %.2f ms, p99 %.2f ms, max %.2f ms", summary.p50, summary.p99, summary.max);
+    TextDisabled("Draws: %d commands, %d vertices per frame", summary.drawCommands, summary.vertices);
+
+    // Oldest to newest
+    auto getter = [](void* data, int index) -> float {
+        auto* profile = reinterpret_cast<const PluginProfile*>(data);
+
+        auto start = (profile->_head + kCapacity - profile->_count) % kCapacity;
+        return profile->_samples[(start + index) % kCapacity].ms;
+    };
+    PlotHistogram("##FrameTimes", getter, const_cast<PluginProfile*>(this), int(_count), 0, nullptr, 0.0f, std::max(summary.max, 1.0f), ImVec2(0, 40));
+}
+
+void PluginProfile::DrawBlame(std::span<BlameEntry> entries) {
+    using namespace ImGui;
+
+    if (entries.empty()) {
+        TextDisabled("None");
+        return;
+    }
+
+    struct Row {
+        const BlameEntry* entry;
+        Summary summary;
+    };
+    std::vector<Row> rows;
+
+    for (const auto& entry : entries) {
+        rows.push_back(Row {
+            .entry = &entry,
+            .summary = entry.profile->Summarize(),
+        });
+    }
+    std::sort(rows.begin(), rows.end(), [](const Row& lhs, const Row& rhs) {
+        return lhs.summary.p99 > rhs.summary.p99;
+    });
+
+    if (!BeginTable("Blame", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        return;
+    }
+
+    TableSetupColumn("Plugin");
+    TableSetupColumn("p50 [ms]");
+    TableSetupColumn("p99 [ms]");
+    TableSetupColumn("max [ms]");
+    TableSetupColumn("Commands");
+    TableHeadersRow();
+
+    for (const auto& row : rows) {
+        TableNextRow();
+
+        if (row.summary.p99 > kLagThresholdMs) {
+            TableSetBgColor(ImGuiTableBgTarget_RowBg1, IM_COL32(160, 40, 40, 120));
+        }
+
+        TableNextColumn();
+        TextUnformatted(row.entry->name.c_str());
+
+        TableNextColumn();
+        Text("%.2f", row.summary.p50);
+
+        TableNextColumn();
+        Text("%.2f", row.summary.p99);
+
+        TableNextColumn();
+        Text("%.2f", row.summary.max);
+
+        TableNextColumn();
+        Text("%d", row.summary.drawCommands);
+    }
+
+    EndTable();
+}
+
+PluginProfile::Sample PluginProfile::CountDrawOutput() {
+    ImGuiContext& g = *GImGui;
+
+    Sample sample;
+
+    for (ImGuiWindow* window : g.Windows) {
+        // Windows which haven't been begun this frame still hold the last frame's output
+        if (window->LastFrameActive != g.FrameCount) {
+            continue;
+        }
+
+        sample.drawCommands += window->DrawList->CmdBuffer.Size;
+        sample.vertices += window->DrawList->VtxBuffer.Size;
+    }
+
+    return sample;
+}
+
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <optional>
+#include <span>
+#include <string>
+
+namespace lldb::imgui {
+
+/// Rolling record of how long a plugin's entry points take each frame, and how much they draw
+class PluginProfile {
+public:
+    static constexpr size_t kCapacity = 240;
+
+    struct Summary {
+        float p50 = 0;
+        float p99 = 0;
+        float max = 0;
+
+        int drawCommands = 0;
+        int vertices = 0;
+    };
+
+    struct BlameEntry {
+        std::string name;
+        const PluginProfile* profile;
+    };
+
+    /// Commits the calls measured since the last frame as a single sample, and returns its duration
+    std::optional<float> BeginFrame();
+
+    template<typename F>
+    void Measure(F&& call) {
+        auto before = CountDrawOutput();
+        auto start = std::chrono::steady_clock::now();
+
+        call();
+
+        auto end = std::chrono::steady_clock::now();
+        auto after = CountDrawOutput();
+
+        _current.ms += std::chrono::duration<float, std::milli>(end - start).count();
+        _current.drawCommands += after.drawCommands - before.drawCommands;
+        _current.vertices += after.vertices - before.vertices;
+        _hasCurrent = true;
+    }
+
+    /// Accounts for a call measured elsewhere, like on a worker thread
+    void Add(float ms) {
+        _current.ms += ms;
+        _hasCurrent = true;
+    }
+
+    void Reset();
+
+    Summary Summarize() const;
+
+    /// Frame time statistics, for the plugin's menu
+    void DrawMenu() const;
+
+    /// Table of plugins ordered by their worst frames
+    static void DrawBlame(std::span<BlameEntry> entries);
+
+private:
+    struct Sample {
+        float ms = 0;
+        int drawCommands = 0;
+        int vertices = 0;
+    };
+
+    /// Output of all windows which have been submitted to in the current frame
+    static Sample CountDrawOutput();
+
+    std::array<Sample, kCapacity> _samples;
+    size_t _head = 0;
+    size_t _count = 0;
+
+    Sample _current;
+    bool _hasCurrent = false;
+};
+
+}
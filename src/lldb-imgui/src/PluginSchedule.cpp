@@ -0,0 +1,298 @@
+#include "PluginSchedule.h"
+
+#include "lldb-imgui/API.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+namespace lldb::imgui {
+
+/// Number of consecutive frames over budget before a plugin gets throttled
+static constexpr int kPatienceFrames = 10;
+
+/// Smoothing factor of the running average cost
+static constexpr float kAverageWeight = 0.1f;
+
+/// Bumped whenever the output of all retained plugins goes out of date
+static std::atomic<uint64_t> g_epoch = 1;
+
+/// Windows which only stay open while they are submitted every frame
+static constexpr ImGuiWindowFlags kTransientFlags = ImGuiWindowFlags_Popup | ImGuiWindowFlags_Tooltip;
+
+/// Copies `source` into `target`, reusing its memory
+template<typename T>
+static void CopyInto(ImVector<T>& target, const ImVector<T>& source) {
+    target.resize(source.Size);
+
+    if (!source.empty()) {
+        memcpy(target.Data, source.Data, source.size_in_bytes());
+    }
+}
+
+void MarkDirty() {
+    // Threads the plugin started on its own can't be told apart from the app's
+    if (auto owner = CurrentOwner(); owner != kAppOwner) {
+        MarkOwnerDirty(owner);
+    } else {
+        PluginSchedule::Invalidate();
+    }
+    RequestRedraw();
+}
+
+void PluginSchedule::Invalidate() {
+    g_epoch.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PluginSchedule::BeginFrame(uint64_t frame, std::optional<float> costMs, float shareMs, double updateRate, bool isRetained) {
+    auto now = std::chrono::steady_clock::now();
+
+    if (costMs) {
+        _averageMs += (*costMs - _averageMs) * kAverageWeight;
+
+        if (shareMs > 0 && _averageMs > shareMs) {
+            _overBudgetFrames++;
+        } else {
+            _overBudgetFrames = 0;
+        }
+
+        if (shareMs <= 0) {
+            _interval = 1;
+        } else if (_overBudgetFrames >= kPatienceFrames) {
+            _interval = std::clamp<int>(std::ceil(_averageMs / shareMs), 1, kMaxInterval);
+        } else if (_interval > 1 && _averageMs * _interval < shareMs * (_interval - 1)) {
+            // Cheap enough to run more often again
+            _interval--;
+        }
+    }
+
+    if (TakeOwnerDirty(_owner)) {
+        _isMarkedOutOfDate = true;
+    }
+
+    bool isDue = (frame - _lastRunFrame) >= uint64_t(_interval);
+
+    if (updateRate > 0) {
+        isDue &= (now - _lastRunTime) >= std::chrono::duration<double>(1.0 / updateRate);
+    }
+
+    // Runs once more after the last interaction, so hover effects go away
+    if (isRetained) {
+        isDue &= IsOutOfDate() || _wasInteractedWith;
+    }
+
+    // Windows of a skipped plugin don't take input, which is unacceptable while someone is using them
+    bool isInteractedWith = IsInteractedWith();
+
+    _isRunning = isDue || !_hasRun || isInteractedWith;
+    _wasInteractedWith = isInteractedWith;
+
+    if (_isRunning) {
+        _hasRun = true;
+        _lastRunFrame = frame;
+        _lastRunTime = now;
+
+        // Read before running, changes made while the plugin runs make it run again
+        _lastRunEpoch = g_epoch.load(std::memory_order_relaxed);
+        _isMarkedOutOfDate = false;
+        _runNavWindow = GImGui->NavWindow;
+    } else {
+        KeepAlive();
+    }
+
+    _calls.clear();
+}
+
+void PluginSchedule::EndFrame(std::span<PluginSchedule* const> schedules) {
+    ImGuiContext& g = *GImGui;
+
+    bool isAnyCalled = false;
+
+    for (auto* schedule : schedules) {
+        if (schedule->_isRunning) {
+            schedule->_lastRunWindows.clear();
+            isAnyCalled |= !schedule->_calls.empty();
+        }
+    }
+    if (!isAnyCalled) {
+        return;
+    }
+
+    // Rendered by now, so the draw lists hold all there is to the windows
+    for (ImGuiWindow* window : g.Windows) {
+        // Windows not begun this frame have the begin order of an earlier one
+        if (window->LastFrameActive != g.FrameCount || window->BeginCount == 0) {
+            continue;
+        }
+
+        for (auto* schedule : schedules) {
+            if (schedule->_isRunning && schedule->IsCalledIn(window)) {
+                auto contentSize = ImVec2(window->DC.CursorMaxPos.x - window->DC.CursorStartPos.x, window->DC.CursorMaxPos.y - window->DC.CursorStartPos.y);
+
+                schedule->_lastRunWindows.push_back(Window {
+                    .window = window,
+                    .parent = window->ParentWindow,
+                    .pos = window->Pos,
+                    .size = window->Size,
+                    .contentSize = contentSize,
+                    .isFocused = IsFocusedBy(window, schedule->_runNavWindow),
+                    .commands = window->DrawList->CmdBuffer,
+                    .indices = window->DrawList->IdxBuffer,
+                    .vertices = window->DrawList->VtxBuffer,
+                });
+                break;
+            }
+        }
+    }
+}
+
+void PluginSchedule::KeepAlive() {
+    // Without being submitted ImGui takes a window for closed at the next frame: it would move
+    // focus away from it, and have it appear anew once it is submitted again. Children are begun
+    // inside their parents, those in the windows of others are dropped along with their output.
+    for (const auto& entry : _lastRunWindows) {
+        if (!(entry.window->Flags & ImGuiWindowFlags_ChildWindow)) {
+            Resubmit(entry);
+        }
+    }
+}
+
+void PluginSchedule::Resubmit(const Window& entry) {
+    auto* window = entry.window;
+
+    // Children are placed by the layout of their parent, which isn't repeated
+    if (window->Flags & ImGuiWindowFlags_ChildWindow) {
+        ImGui::SetNextWindowPos(window->Pos);
+        ImGui::SetNextWindowSize(window->SizeFull);
+    }
+
+    if (ImGui::Begin(window->Name, nullptr, window->Flags)) {
+        // Auto resizing and scrolling go by the content of the previous frame
+        ImGui::ItemSize(entry.contentSize);
+
+        for (const auto& child : _lastRunWindows) {
+            if (child.parent == window) {
+                Resubmit(child);
+            }
+        }
+    }
+    ImGui::End();
+
+    Restore(entry);
+}
+
+void PluginSchedule::Restore(const Window& entry) {
+    auto& drawList = *entry.window->DrawList;
+
+    CopyInto(drawList.CmdBuffer, entry.commands);
+    CopyInto(drawList.IdxBuffer, entry.indices);
+    CopyInto(drawList.VtxBuffer, entry.vertices);
+
+    drawList._IdxWritePtr = drawList.IdxBuffer.Data + drawList.IdxBuffer.Size;
+    drawList._VtxWritePtr = drawList.VtxBuffer.Data + drawList.VtxBuffer.Size;
+
+    // Anything drawn into the window later on goes into a command of its own, which rendering drops
+    // if it stays empty
+    drawList._CmdHeader.VtxOffset = drawList.VtxBuffer.Size;
+    drawList._VtxCurrentIdx = 0;
+    drawList.AddDrawCmd();
+}
+
+void PluginSchedule::Reset(OwnerID owner) {
+    TakeOwnerDirty(std::exchange(_owner, owner));
+
+    _calls.clear();
+    _lastRunWindows.clear();
+
+    _isRunning = true;
+    _hasRun = false;
+    _interval = 1;
+    _overBudgetFrames = 0;
+    _averageMs = 0;
+
+    _lastRunEpoch = 0;
+    _isMarkedOutOfDate = false;
+    _wasInteractedWith = false;
+    _runNavWindow = nullptr;
+}
+
+void PluginSchedule::AddCall(int begin, int end) {
+    if (begin == end) {
+        return;
+    }
+
+    // Calls in a row, with nothing else beginning windows in between
+    if (!_calls.empty() && _calls.back().end == begin) {
+        _calls.back().end = end;
+    } else {
+        _calls.push_back(Call { .begin = begin, .end = end });
+    }
+}
+
+bool PluginSchedule::IsCalledIn(const ImGuiWindow* window) const {
+    int order = window->BeginOrderWithinContext;
+
+    return std::ranges::any_of(_calls, [&](const Call& call) {
+        return order >= call.begin && order < call.end;
+    });
+}
+
+bool PluginSchedule::IsFocusedBy(const ImGuiWindow* window, const ImGuiWindow* navWindow) {
+    // Child windows look the same either way
+    return navWindow && window->RootWindow == window && navWindow->RootWindow == window;
+}
+
+bool PluginSchedule::IsInteractedWith() const {
+    const ImGuiContext& g = *GImGui;
+
+    for (const auto& entry : _lastRunWindows) {
+        if (entry.window->Rect().Contains(g.IO.MousePos)) {
+            return true;
+        }
+
+        // Open popups of a skipped plugin would close
+        if (entry.window->Flags & kTransientFlags) {
+            return true;
+        }
+    }
+
+    // Typing into, or dragging something of the plugin's
+    if (g.ActiveIdWindow && std::ranges::find(_lastRunWindows, g.ActiveIdWindow, &Window::window) != _lastRunWindows.end()) {
+        return true;
+    }
+    return IsFocused() && !g.InputEventsTrail.empty();
+}
+
+bool PluginSchedule::IsFocused() const {
+    const ImGuiContext& g = *GImGui;
+
+    return g.NavWindow && std::ranges::find(_lastRunWindows, g.NavWindow->RootWindow, &Window::window) != _lastRunWindows.end();
+}
+
+bool PluginSchedule::IsOutOfDate() const {
+    const ImGuiContext& g = *GImGui;
+
+    if (_isMarkedOutOfDate || g_epoch.load(std::memory_order_relaxed) != _lastRunEpoch) {
+        return true;
+    }
+
+    // The output is drawn in place, moving the window moves none of it
+    for (const auto& entry : _lastRunWindows) {
+        auto* window = entry.window;
+
+        if (window->Pos.x != entry.pos.x || window->Pos.y != entry.pos.y) {
+            return true;
+        }
+        if (window->Size.x != entry.size.x || window->Size.y != entry.size.y) {
+            return true;
+        }
+        if (IsFocusedBy(window, g.NavWindow) != entry.isFocused) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
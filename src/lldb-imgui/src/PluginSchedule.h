@@ -0,0 +1,144 @@
+#pragma once
+
+#include "Owner.h"
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Decides which frames a plugin gets to run in. Plugins which keep exceeding their share of the
+/// frame budget are moved to every Nth frame, and plugins may ask for a fixed update rate.
+///
+/// In the frames a plugin is skipped in, its windows are begun again without any content, and their
+/// draw lists refilled with the output of the last run. ImGui keeps them open, focused and in their
+/// usual place in the z-order. Only windows the plugin began first are kept this way, anything it
+/// draws into the windows of others is gone until it runs again.
+///
+/// Retained plugins are only run once something they may depend on changed: the state of a debugger
+/// they asked about, one of their queries, the size or focus of one of their windows, input over
+/// them, or the plugin marking itself dirty. Their output is kept otherwise.
+class PluginSchedule {
+public:
+    static constexpr int kMaxInterval = 30;
+
+    PluginSchedule() = default;
+    PluginSchedule(const PluginSchedule&) = delete;
+
+    /// Decides whether the plugin runs this frame. `costMs` is the duration of the previous frame's
+    /// calls if the plugin ran in it. A zero `shareMs` disables throttling, a zero `updateRate`
+    /// means every frame.
+    void BeginFrame(uint64_t frame, std::optional<float> costMs, float shareMs, double updateRate, bool isRetained);
+
+    /// Marks the output of all retained plugins out of date, for when it is unknown whose changed.
+    ///
+    /// Safe to call from any thread.
+    static void Invalidate();
+
+    /// Marks the output of this plugin out of date, if it is retained
+    void MarkOutOfDate() {
+        _isMarkedOutOfDate = true;
+    }
+
+    bool IsRunning() const {
+        return _isRunning;
+    }
+    int Interval() const {
+        return _interval;
+    }
+
+    /// Tracks the windows submitted by the plugin during `call`. Windows are told apart by the order
+    /// they first begin in, so a window some other code began before only belongs to its author.
+    template<typename F>
+    void Track(F&& call) {
+        int begin = GImGui->WindowsActiveCount;
+
+        call();
+
+        AddCall(begin, GImGui->WindowsActiveCount);
+    }
+
+    /// Remembers the windows of the plugins which ran this frame, once all of their calls did. Goes
+    /// over ImGui's windows once for all of them.
+    static void EndFrame(std::span<PluginSchedule* const> schedules);
+
+    /// Starts over for a newly loaded plugin, whose output depends on whatever `owner` is marked
+    /// dirty for
+    void Reset(OwnerID owner = kAppOwner);
+
+private:
+    struct Window {
+        ImGuiWindow* window;
+        ImGuiWindow* parent;
+
+        // As drawn by the last run
+        ImVec2 pos;
+        ImVec2 size;
+        ImVec2 contentSize;
+        bool isFocused;
+
+        // Output of the last run, drawn again while the plugin is skipped
+        ImVector<ImDrawCmd> commands;
+        ImVector<ImDrawIdx> indices;
+        ImVector<ImDrawVert> vertices;
+    };
+
+    // Range of `BeginOrderWithinContext` of the windows a call began
+    struct Call {
+        int begin;
+        int end;
+    };
+
+    void AddCall(int begin, int end);
+    bool IsCalledIn(const ImGuiWindow* window) const;
+
+    /// Whether `window` shows as focused while `navWindow` has focus
+    static bool IsFocusedBy(const ImGuiWindow* window, const ImGuiWindow* navWindow);
+
+    /// Keeps the windows of the last run active through a frame the plugin is skipped in
+    void KeepAlive();
+
+    /// Begins `entry` and its children again, with the output of the last run
+    void Resubmit(const Window& entry);
+
+    /// Replaces what was drawn into `entry` this frame with the output of the last run
+    static void Restore(const Window& entry);
+
+    bool IsInteractedWith() const;
+    bool IsFocused() const;
+    bool IsOutOfDate() const;
+
+    bool _isRunning = true;
+    bool _hasRun = false;
+
+    int _interval = 1;
+    int _overBudgetFrames = 0;
+    float _averageMs = 0;
+
+    OwnerID _owner = kAppOwner;
+
+    uint64_t _lastRunFrame = 0;
+    std::chrono::steady_clock::time_point _lastRunTime;
+
+    // What the output of the last run depended on
+    uint64_t _lastRunEpoch = 0;
+    bool _isMarkedOutOfDate = false;
+    bool _wasInteractedWith = false;
+
+    // Focused window when the plugin ran
+    const ImGuiWindow* _runNavWindow = nullptr;
+
+    // Calls of the current frame
+    std::vector<Call> _calls;
+
+    // Submitted by the last run, kept active while the plugin is skipped
+    std::vector<Window> _lastRunWindows;
+};
+
+}
@@ -0,0 +1,65 @@
+#include "lldb-imgui/State.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace lldb::imgui {
+
+static constexpr size_t kChunkSize = 1024 * 1024;
+
+/// Allocations larger than this get a chunk of their own, rather than wasting the rest of one
+static constexpr size_t kMaxSharedSize = kChunkSize / 4;
+
+static constexpr size_t kAlignment = alignof(std::max_align_t);
+
+PluginState::PluginState() = default;
+PluginState::~PluginState() = default;
+
+std::span<std::byte> PluginState::Allocate(std::string_view key, size_t size) {
+    auto aligned = (size + kAlignment - 1) & ~(kAlignment - 1);
+
+    std::byte* data = nullptr;
+
+    if (aligned > kMaxSharedSize) {
+        // Keeps the current chunk at the back
+        auto chunk = std::make_unique_for_overwrite<std::byte[]>(aligned);
+        data = chunk.get();
+
+        _chunks.insert(_chunks.empty() ? _chunks.end() : _chunks.end() - 1, std::move(chunk));
+    } else {
+        if (_chunks.empty() || _chunkUsed + aligned > kChunkSize) {
+            _chunks.push_back(std::make_unique_for_overwrite<std::byte[]>(kChunkSize));
+            _chunkUsed = 0;
+        }
+
+        data = _chunks.back().get() + _chunkUsed;
+        _chunkUsed += aligned;
+    }
+
+    auto& entry = _entries[std::string(key)];
+    entry = std::span(data, size);
+
+    return entry;
+}
+
+void PluginState::Store(std::string_view key, std::span<const std::byte> bytes) {
+    std::ranges::copy(bytes, Allocate(key, bytes.size()).begin());
+}
+
+std::span<const std::byte> PluginState::Find(std::string_view key) const {
+    if (auto it = _entries.find(std::string(key)); it != _entries.end()) {
+        return it->second;
+    }
+    return {};
+}
+
+size_t PluginState::Size() const {
+    size_t size = 0;
+
+    for (const auto& [_, entry] : _entries) {
+        size += entry.size();
+    }
+    return size;
+}
+
+}
@@ -0,0 +1,409 @@
+#include "QueryEngine.h"
+
+#include "lldb-imgui/API.h"
+#include "EventBus.h"
+#include "Trace.h"
+
+#include "lldb/API/LLDB.h"
+
+#include <algorithm>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// How often the state of idle debuggers is polled. Only a fallback, as the `EventBus` wakes the
+/// engine whenever a debugger broadcasts a change.
+static constexpr auto kPollInterval = std::chrono::seconds(1);
+
+/// How often the state is polled while a process runs. The `EventBus` only hears about processes it
+/// shadows, stops of the others are up to polling.
+static constexpr auto kRunningPollInterval = std::chrono::milliseconds(50);
+
+// Read from threads plugins start on their own. The app unloads its plugins before the engine
+// goes away, which only leaves their threads racing the shutdown.
+static std::atomic<QueryEngine*> g_engine = nullptr;
+
+uint64_t GetDebuggerGeneration(SBDebugger& debugger) {
+    auto* engine = g_engine.load(std::memory_order_acquire);
+
+    return engine ? engine->Generation(debugger) : 0;
+}
+
+void SubmitQuery(SBDebugger& debugger, std::shared_ptr<QueryTask> task) {
+    auto* engine = g_engine.load(std::memory_order_acquire);
+
+    if (!engine) {
+        task->Cancel();
+        return;
+    }
+    engine->Submit(debugger, std::move(task), CurrentOwner());
+}
+
+void CancelQueries(OwnerID owner) {
+    if (auto* engine = g_engine.load(std::memory_order_acquire)) {
+        engine->Cancel(owner);
+    }
+}
+
+void WatchDebugger(SBDebugger& debugger, OwnerID owner) {
+    if (auto* engine = g_engine.load(std::memory_order_acquire)) {
+        engine->Watch(debugger, owner);
+    }
+}
+
+bool IsQueryRunning(OwnerID owner) {
+    auto* engine = g_engine.load(std::memory_order_acquire);
+
+    return engine && engine->IsRunning(owner);
+}
+
+QueryEngine::QueryEngine() {
+    g_engine.store(this, std::memory_order_release);
+
+    _thread = std::jthread([this](std::stop_token stop) {
+        Run(stop);
+    });
+}
+
+QueryEngine::~QueryEngine() {
+    g_engine.store(nullptr, std::memory_order_release);
+
+    _thread.request_stop();
+    _thread.join();
+
+    for (auto& pending : _queue) {
+        pending.task->Cancel();
+    }
+}
+
+void QueryEngine::AddDebugger(SBDebugger& debugger) {
+    std::lock_guard lock(_mutex);
+
+    FindOrAdd(debugger);
+}
+
+uint64_t QueryEngine::Generation(SBDebugger& debugger) {
+    std::lock_guard lock(_mutex);
+
+    auto& entry = FindOrAdd(debugger);
+    AddWatcher(entry, CurrentOwner());
+
+    return entry.generation.load();
+}
+
+void QueryEngine::Watch(SBDebugger& debugger, OwnerID owner) {
+    std::lock_guard lock(_mutex);
+
+    AddWatcher(FindOrAdd(debugger), owner);
+}
+
+void QueryEngine::Submit(SBDebugger& debugger, std::shared_ptr<QueryTask> task, OwnerID owner) {
+    {
+        std::lock_guard lock(_mutex);
+
+        auto& entry = FindOrAdd(debugger);
+        AddWatcher(entry, owner);
+
+        _queue.push_back(Pending {
+            .debugger = &entry,
+            .generation = entry.generation.load(),
+            .owner = owner,
+            .task = std::move(task),
+        });
+    }
+    _wakeup.notify_one();
+}
+
+void QueryEngine::Cancel(OwnerID owner) {
+    std::vector<Pending> cancelled;
+    {
+        std::lock_guard lock(_mutex);
+
+        for (auto it = _queue.begin(); it != _queue.end();) {
+            if (it->owner == owner) {
+                cancelled.push_back(std::move(*it));
+                it = _queue.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        for (auto& [_, entry] : _debuggers) {
+            std::erase(entry->watchers, owner);
+        }
+    }
+
+    for (auto& pending : cancelled) {
+        pending.task->Cancel();
+    }
+}
+
+bool QueryEngine::IsRunning(OwnerID owner) {
+    std::lock_guard lock(_mutex);
+
+    return std::ranges::find(_busyOwners, owner) != _busyOwners.end();
+}
+
+void QueryEngine::Wake() {
+    {
+        std::lock_guard lock(_mutex);
+        _isRefreshRequested = true;
+    }
+    _wakeup.notify_one();
+}
+
+QueryEngine::Debugger& QueryEngine::FindOrAdd(SBDebugger& debugger) {
+    auto& entry = _debuggers[debugger.GetID()];
+
+    if (!entry) {
+        entry = std::make_unique<Debugger>();
+        entry->debugger = debugger;
+    }
+
+    return *entry;
+}
+
+void QueryEngine::AddWatcher(Debugger& entry, OwnerID owner) {
+    // The app redraws whenever anything changed
+    if (owner != kAppOwner && std::ranges::find(entry.watchers, owner) == entry.watchers.end()) {
+        entry.watchers.push_back(owner);
+    }
+}
+
+void QueryEngine::Run(std::stop_token stop) {
+    SetTraceThreadName("Queries");
+
+    // All debuggers are polled when woken up, when the poll interval passed, and on start. A task only
+    // has the debugger it ran against polled again.
+    bool isRefreshDue = true;
+    auto lastRefreshTime = std::chrono::steady_clock::now();
+
+    while (!stop.stop_requested()) {
+        auto now = std::chrono::steady_clock::now();
+
+        std::unordered_set<Debugger*> destroyed;
+
+        if (isRefreshDue || now - lastRefreshTime >= PollInterval()) {
+            destroyed = FindDestroyedDebuggers();
+
+            if (Refresh()) {
+                RequestRedraw();
+            }
+
+            isRefreshDue = false;
+            lastRefreshTime = now;
+        }
+
+        std::unique_lock lock(_mutex);
+
+        std::vector<Pending> stale;
+
+        for (auto it = _queue.begin(); it != _queue.end();) {
+            if (destroyed.contains(it->debugger) || IsStale(*it)) {
+                stale.push_back(std::move(*it));
+                it = _queue.erase(it);
+            } else {
+                it++;
+            }
+        }
+
+        std::erase_if(_debuggers, [&](const auto& entry) {
+            return destroyed.contains(entry.second.get());
+        });
+
+        std::optional<Pending> next;
+
+        if (!_queue.empty()) {
+            next = std::move(_queue.front());
+            _queue.pop_front();
+        }
+
+        // Owners may only unload their code once the tasks held on to here are gone
+        for (const auto& pending : stale) {
+            _busyOwners.push_back(pending.owner);
+        }
+        if (next) {
+            _busyOwners.push_back(next->owner);
+        }
+
+        lock.unlock();
+
+        // Their owners submit again once they run
+        for (auto& pending : stale) {
+            OwnerScope owner(pending.owner);
+
+            pending.task->Cancel();
+            MarkOwnerDirty(pending.owner);
+        }
+        stale.clear();
+
+        bool hasRun = next.has_value();
+
+        if (next) {
+            OwnerScope owner(next->owner);
+
+            {
+                TRACE_ZONE("Query");
+                next->task->Run(next->debugger->debugger);
+            }
+
+            // The process may have been resumed while the task ran, which invalidates its result
+            RefreshDebugger(*next->debugger);
+
+            if (IsStale(*next)) {
+                next->task->Cancel();
+            } else {
+                next->task->Complete();
+            }
+            MarkOwnerDirty(next->owner);
+            next.reset();
+
+            RequestRedraw();
+        }
+
+        lock.lock();
+        _busyOwners.clear();
+
+        if (!hasRun) {
+            bool isWoken = _wakeup.wait_for(lock, stop, PollInterval(), [&] {
+                return !_queue.empty() || _isRefreshRequested;
+            });
+
+            // Tasks alone don't change the state, they run against what was polled last
+            isRefreshDue = !isWoken;
+        }
+        isRefreshDue |= std::exchange(_isRefreshRequested, false);
+    }
+}
+
+std::unordered_set<QueryEngine::Debugger*> QueryEngine::FindDestroyedDebuggers() {
+    std::vector<std::pair<lldb::user_id_t, Debugger*>> debuggers;
+    {
+        std::lock_guard lock(_mutex);
+
+        for (auto& [id, entry] : _debuggers) {
+            debuggers.emplace_back(id, entry.get());
+        }
+    }
+
+    // Copies of a destroyed debugger stay valid, only the debugger list forgets about it
+    std::unordered_set<Debugger*> destroyed;
+
+    for (auto [id, entry] : debuggers) {
+        if (!SBDebugger::FindDebuggerWithID(int(id)).IsValid()) {
+            destroyed.insert(entry);
+        }
+    }
+
+    return destroyed;
+}
+
+bool QueryEngine::Refresh() {
+    TRACE_ZONE("Poll debuggers");
+
+    std::vector<Debugger*> debuggers;
+    {
+        std::lock_guard lock(_mutex);
+
+        for (auto& [_, entry] : _debuggers) {
+            debuggers.push_back(entry.get());
+        }
+    }
+
+    bool changed = false;
+    _isAnyRunning = false;
+
+    for (auto* entry : debuggers) {
+        changed |= RefreshDebugger(*entry);
+        _isAnyRunning |= entry->isRunning;
+    }
+
+    return changed;
+}
+
+bool QueryEngine::RefreshDebugger(Debugger& entry) {
+    auto& debugger = entry.debugger;
+
+    size_t hash = debugger.GetNumTargets();
+    bool isRunning = false;
+
+    DebuggerEvents polled;
+    decltype(entry.processes) processes;
+
+    auto combine = [&](size_t value) {
+        hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+    };
+
+    for (uint32_t i = 0; i < debugger.GetNumTargets(); i++) {
+        auto process = debugger.GetTargetAtIndex(i).GetProcess();
+
+        if (!process.IsValid()) {
+            continue;
+        }
+
+        auto uniqueID = process.GetUniqueID();
+        auto stopID = process.GetStopID();
+        auto state = process.GetState();
+
+        combine(uniqueID);
+        combine(stopID);
+        combine(state);
+
+        isRunning |= state == eStateRunning || state == eStateStepping;
+
+        // Unless a shadow listener hears of it, a stop of this process reaches plugins from here alone
+        auto it = entry.processes.find(uniqueID);
+        bool isChanged = it == entry.processes.end() || it->second != std::pair(stopID, state);
+
+        if (isChanged && !IsProcessShadowed(uniqueID)) {
+            polled.Merge(DebuggerEvents {
+                .numStateChanges = 1,
+                .lastState = uint32_t(state),
+            });
+        }
+        processes.emplace(uniqueID, std::pair(stopID, state));
+
+        auto thread = process.GetSelectedThread();
+        combine(thread.GetThreadID());
+        combine(thread.GetSelectedFrame().GetFrameID());
+    }
+
+    entry.isRunning = isRunning;
+    entry.processes = std::move(processes);
+
+    bool isFirst = entry.generation == 0;
+
+    // What the first refresh finds was there before the app
+    if (polled.numStateChanges && !isFirst) {
+        PostPolledEvents(debugger.GetID(), polled);
+    }
+
+    if (std::exchange(entry.stateHash, hash) == hash && !isFirst) {
+        return false;
+    }
+
+    entry.generation++;
+
+    std::lock_guard lock(_mutex);
+
+    for (auto owner : entry.watchers) {
+        MarkOwnerDirty(owner);
+    }
+    return !isFirst;
+}
+
+std::chrono::milliseconds QueryEngine::PollInterval() const {
+    return _isAnyRunning ? kRunningPollInterval : kPollInterval;
+}
+
+bool QueryEngine::IsStale(const Pending& pending) {
+    // Submitted before the debugger was first polled
+    if (pending.generation == 0) {
+        return false;
+    }
+    return pending.generation != pending.debugger->generation;
+}
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "lldb-imgui/Query.h"
+
+#include "Owner.h"
+
+#include "lldb/API/SBDebugger.h"
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Runs the tasks submitted through `SubmitQuery` on a single worker thread, and keeps track of
+/// the state of each debugger's processes so the UI thread never has to ask the debugger itself.
+class QueryEngine {
+public:
+    QueryEngine();
+    ~QueryEngine();
+
+    QueryEngine(const QueryEngine&) = delete;
+
+    void AddDebugger(SBDebugger& debugger);
+
+    /// Generation of the state of `debugger`, which the calling owner depends on from now on
+    uint64_t Generation(SBDebugger& debugger);
+
+    /// Marks `owner` dirty whenever the state of `debugger` changes, until its queries are cancelled
+    void Watch(SBDebugger& debugger, OwnerID owner);
+
+    /// Queues `task` on behalf of `owner`
+    void Submit(SBDebugger& debugger, std::shared_ptr<QueryTask> task, OwnerID owner);
+
+    /// Cancels the queued tasks of `owner`, without waiting for its running one, and stops watching
+    /// debuggers for it
+    void Cancel(OwnerID owner);
+
+    /// Whether the query thread holds on to a task of `owner`, to run or cancel it. The owner's code
+    /// can't be unloaded before.
+    bool IsRunning(OwnerID owner);
+
+    /// Refreshes the state of the debuggers right away, rather than at the next poll
+    void Wake();
+
+private:
+    struct Debugger {
+        SBDebugger debugger;
+
+        size_t stateHash = 0;
+        std::atomic<uint64_t> generation = 0;
+
+        // Whether the last refresh found a process running
+        bool isRunning = false;
+
+        // Stop ID and state of each process by unique ID, as of the last refresh
+        std::unordered_map<uint32_t, std::pair<uint32_t, StateType>> processes;
+
+        // Owners depending on the state
+        std::vector<OwnerID> watchers;
+    };
+
+    struct Pending {
+        Debugger* debugger;
+        uint64_t generation;
+        OwnerID owner;
+
+        std::shared_ptr<QueryTask> task;
+    };
+
+    Debugger& FindOrAdd(SBDebugger& debugger);
+    static void AddWatcher(Debugger& entry, OwnerID owner);
+
+    void Run(std::stop_token stop);
+
+    /// Entries of the debuggers destroyed since they were added, which are removed along with
+    /// their queued tasks
+    std::unordered_set<Debugger*> FindDestroyedDebuggers();
+
+    /// Polls the state of each debugger's processes, marking the watchers of those which changed
+    /// dirty. Returns whether any of them did.
+    bool Refresh();
+
+    /// Polls the state of a single debugger, see `Refresh`. Posts the state changes of processes the
+    /// `EventBus` doesn't hear about.
+    bool RefreshDebugger(Debugger& entry);
+
+    std::chrono::milliseconds PollInterval() const;
+
+    static bool IsStale(const Pending& pending);
+
+    std::mutex _mutex;
+    std::condition_variable_any _wakeup;
+    bool _isRefreshRequested = false;
+
+    // Whether the last refresh found a process running, only touched by the query thread
+    bool _isAnyRunning = false;
+
+    std::unordered_map<lldb::user_id_t, std::unique_ptr<Debugger>> _debuggers;
+    std::deque<Pending> _queue;
+
+    // Owners of the tasks the query thread took out of the queue
+    std::vector<OwnerID> _busyOwners;
+
+    std::jthread _thread;
+};
+
+/// Cancels the queued queries of `owner`, see `QueryEngine::Cancel`
+void CancelQueries(OwnerID owner);
+
+/// See `QueryEngine::Watch`
+void WatchDebugger(SBDebugger& debugger, OwnerID owner);
+
+/// See `QueryEngine::IsRunning`
+bool IsQueryRunning(OwnerID owner);
+
+}
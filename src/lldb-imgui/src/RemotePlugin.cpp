@@ -0,0 +1,440 @@
+#include "RemotePlugin.h"
+
+#include "PluginHost.h"
+#include "lldb-imgui/API.h"
+
+#include "spdlog/spdlog.h"
+
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <spawn.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cstring>
+#include <format>
+
+extern char** environ;
+
+namespace lldb::imgui {
+
+/// Points `vector` at memory it doesn't own, or detaches it with a null `data`
+template<typename T>
+static void Borrow(ImVector<T>& vector, const void* data, uint32_t size) {
+    vector.Data = static_cast<T*>(const_cast<void*>(data));
+    vector.Size = int(size);
+    vector.Capacity = int(size);
+}
+
+std::unique_ptr<RemotePlugin> RemotePlugin::Spawn(const std::filesystem::path& path, std::string& status) {
+    static std::atomic<int> counter = 0;
+
+    // The host is this very executable, which is not necessarily the process' main executable
+    Dl_info info;
+    if (!dladdr(reinterpret_cast<void*>(&RunPluginHost), &info) || !info.dli_fname) {
+        status = "Failed to start plugin host: executable not found";
+        return nullptr;
+    }
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+        status = std::format("Failed to start plugin host: {}", strerror(errno));
+        return nullptr;
+    }
+    for (auto fd : sockets) {
+        fcntl(fd, F_SETFD, FD_CLOEXEC);
+    }
+
+    // Only ever reachable through the descriptor
+    auto name = std::format("/lldb-imgui-{}-{}", getpid(), counter++);
+
+    int memory = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (memory != -1) {
+        shm_unlink(name.c_str());
+    }
+
+    void* mapping = MAP_FAILED;
+
+    if (memory != -1 && ftruncate(memory, sizeof(remote::Shared)) == 0) {
+        mapping = mmap(nullptr, sizeof(remote::Shared), PROT_READ | PROT_WRITE, MAP_SHARED, memory, 0);
+    }
+    if (mapping == MAP_FAILED) {
+        status = std::format("Failed to start plugin host: {}", strerror(errno));
+
+        if (memory != -1) {
+            close(memory);
+        }
+        close(sockets[0]);
+        close(sockets[1]);
+        return nullptr;
+    }
+
+    // Fresh shared memory is zeroed, and the rest is written before it is read
+    auto* shared = static_cast<remote::Shared*>(mapping);
+    shared->magic = remote::kMagic;
+    shared->latest.store(1);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, memory, remote::kSharedMemoryFd);
+    posix_spawn_file_actions_adddup2(&actions, sockets[1], remote::kSocketFd);
+
+    auto pluginPath = path.string();
+
+    char* argv[] = {
+        const_cast<char*>(info.dli_fname),
+        const_cast<char*>("--plugin-host"),
+        pluginPath.data(),
+        nullptr,
+    };
+
+    pid_t pid = 0;
+    int error = posix_spawn(&pid, info.dli_fname, &actions, nullptr, argv, environ);
+
+    posix_spawn_file_actions_destroy(&actions);
+    close(memory);
+    close(sockets[1]);
+
+    if (error != 0) {
+        status = std::format("Failed to start plugin host: {}", strerror(error));
+
+        munmap(mapping, sizeof(remote::Shared));
+        close(sockets[0]);
+        return nullptr;
+    }
+
+    spdlog::info("Started plugin host {} for '{}'", pid, path.filename().string());
+
+    return std::unique_ptr<RemotePlugin>(new RemotePlugin(pid, sockets[0], shared, path.stem().string()));
+}
+
+RemotePlugin::RemotePlugin(pid_t pid, int socket, remote::Shared* shared, std::string name)
+: _pid(pid)
+, _socket(socket)
+, _shared(shared)
+, _name(std::move(name))
+, _relay(std::make_unique<SocketRelay>(socket, [this] {
+    OnHostAnswered();
+}))
+{}
+
+RemotePlugin::~RemotePlugin() {
+    // Hosts keep no state worth saving, and may well be stuck in the plugin
+    if (_pid > 0) {
+        kill(_pid, SIGKILL);
+        waitpid(_pid, nullptr, 0);
+    }
+
+    // Stops reading before the socket is closed
+    _relay.reset();
+    close(_socket);
+
+    for (auto* list : _lists) {
+        Borrow(list->VtxBuffer, nullptr, 0);
+
+        IM_DELETE(list);
+    }
+
+    munmap(_shared, sizeof(remote::Shared));
+}
+
+bool RemotePlugin::IsRunning(std::string& status) {
+    int result = 0;
+
+    if (waitpid(_pid, &result, WNOHANG) != _pid) {
+        return true;
+    }
+
+    if (WIFSIGNALED(result)) {
+        status = std::format("Plugin host crashed: {}", strsignal(WTERMSIG(result)));
+    } else {
+        status = std::format("Plugin host exited with code {}", WEXITSTATUS(result));
+    }
+
+    // Reaped already
+    _pid = -1;
+    return false;
+}
+
+void RemotePlugin::Draw() {
+    using namespace ImGui;
+
+    AcquireFrame();
+    ForwardInput();
+
+    _standIns.clear();
+
+    if (!_frame) {
+        return;
+    }
+
+    auto flags = ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing;
+
+    for (uint32_t i = 0; i < std::min<uint32_t>(_frame->numWindows, remote::kMaxWindows); i++) {
+        const auto& window = _frame->windows[i];
+
+        // Lists of no window in particular take no input
+        if (window.id == 0) {
+            _standIns.push_back(nullptr);
+            continue;
+        }
+
+        auto name = std::format("##{}/{:08x}", _name, window.id);
+
+        SetNextWindowPos(window.min);
+        SetNextWindowSize(ImVec2(window.max.x - window.min.x, window.max.y - window.min.y));
+
+        Begin(name.c_str(), nullptr, flags);
+        _standIns.push_back(GetCurrentWindow());
+        End();
+    }
+}
+
+void RemotePlugin::AcquireFrame() {
+    if (!(_shared->latest.load(std::memory_order_acquire) & remote::kFresh)) {
+        return;
+    }
+
+    _front = _shared->latest.exchange(_front, std::memory_order_acq_rel) & ~remote::kFresh;
+
+    const auto* slot = _shared->slots[_front];
+    _frame = reinterpret_cast<const remote::Frame*>(slot);
+
+    size_t offset = remote::AlignUp(sizeof(remote::Frame));
+
+    // Fully written before it was published, but not trusted to stay within its slot
+    auto take = [&](size_t size) -> const uint8_t* {
+        if (offset + size > remote::kSlotSize) {
+            return nullptr;
+        }
+
+        auto* data = slot + offset;
+        offset += remote::AlignUp(size);
+        return data;
+    };
+
+    // Only textures of the app's own can be drawn with
+    auto fontTexture = ImGui::GetIO().Fonts->TexID;
+
+    _numLists = 0;
+
+    auto numLists = std::min<uint32_t>(_frame->numLists, remote::kMaxLists);
+
+    for (uint32_t i = 0; i < numLists; i++) {
+        if (i == _lists.size()) {
+            _lists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+        }
+
+        auto* header = reinterpret_cast<const remote::List*>(take(sizeof(remote::List)));
+        if (!header) {
+            _frame = nullptr;
+            return;
+        }
+
+        // Read once, the host may be scribbling over the slot all along
+        auto numCommands = header->numCommands;
+        auto numVertices = header->numVertices;
+        auto numIndices = header->numIndices;
+
+        auto* commands = take(size_t(numCommands) * sizeof(ImDrawCmd));
+        auto* vertices = commands ? take(size_t(numVertices) * sizeof(ImDrawVert)) : nullptr;
+        auto* indices = vertices ? take(size_t(numIndices) * sizeof(ImDrawIdx)) : nullptr;
+
+        if (!indices) {
+            _frame = nullptr;
+            return;
+        }
+
+        auto* list = _lists[i];
+
+        // Any vertex draws somewhere on screen at worst, so those are read in place. Commands and
+        // indices are copied first, and checked to stay within the list's vertices.
+        Borrow(list->VtxBuffer, vertices, numVertices);
+
+        list->IdxBuffer.resize(int(numIndices));
+        memcpy(list->IdxBuffer.Data, indices, size_t(numIndices) * sizeof(ImDrawIdx));
+
+        list->CmdBuffer.resize(0);
+
+        for (uint32_t j = 0; j < numCommands; j++) {
+            ImDrawCmd command;
+            memcpy(&command, commands + j * sizeof(ImDrawCmd), sizeof(ImDrawCmd));
+
+            if (IsValidCommand(command, list->IdxBuffer, numVertices, fontTexture)) {
+                list->CmdBuffer.push_back(command);
+            }
+        }
+
+        _numLists = i + 1;
+    }
+}
+
+bool RemotePlugin::IsValidCommand(const ImDrawCmd& command, const ImVector<ImDrawIdx>& indices, uint32_t numVertices, ImTextureID fontTexture) {
+    // Callbacks and textures would point into the host
+    if (command.UserCallback || command.TextureId != fontTexture) {
+        return false;
+    }
+    if (uint64_t(command.IdxOffset) + command.ElemCount > uint64_t(indices.Size)) {
+        return false;
+    }
+
+    for (uint32_t i = command.IdxOffset; i < command.IdxOffset + command.ElemCount; i++) {
+        if (uint64_t(command.VtxOffset) + indices[int(i)] >= numVertices) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void RemotePlugin::OnHostAnswered() {
+    bool isFresh = _shared->latest.load(std::memory_order_acquire) & remote::kFresh;
+
+    // Unchanged frames aren't published, and need no redraw unless input is waiting for the host
+    if (isFresh || _hasPendingInput.load()) {
+        RequestRedraw();
+    }
+
+    if (auto deadline = _shared->redrawDeadline.exchange(0)) {
+        auto delay = Clock::time_point(Clock::duration(deadline)) - Clock::now();
+
+        RequestRedraw(std::max(std::chrono::ceil<std::chrono::milliseconds>(delay), std::chrono::milliseconds(0)));
+    }
+}
+
+void RemotePlugin::ForwardInput() {
+    ImGuiContext& g = *GImGui;
+    ImGuiIO& io = g.IO;
+
+    bool isHovered = IsStandIn(g.HoveredWindow) || (_frame && _frame->wantCaptureMouse);
+    bool isFocused = IsStandIn(g.NavWindow);
+
+    for (const auto& event : g.InputEventsTrail) {
+        auto forwarded = event;
+
+        switch (event.Type) {
+            case ImGuiInputEventType_MousePos: {
+                if (!isHovered) {
+                    forwarded.MousePos.PosX = -FLT_MAX;
+                    forwarded.MousePos.PosY = -FLT_MAX;
+                }
+                break;
+            }
+            case ImGuiInputEventType_MouseWheel: {
+                if (!isHovered) {
+                    continue;
+                }
+                break;
+            }
+            case ImGuiInputEventType_MouseButton: {
+                // Releases always go through, nothing gets stuck pressed
+                if (!isHovered && event.MouseButton.Down) {
+                    continue;
+                }
+                break;
+            }
+            case ImGuiInputEventType_Key: {
+                if (!isFocused && event.Key.Down) {
+                    continue;
+                }
+                break;
+            }
+            case ImGuiInputEventType_Text: {
+                if (!isFocused) {
+                    continue;
+                }
+                break;
+            }
+            default: {
+                break;
+            }
+        }
+
+        if (_pendingEvents.size() < remote::kMaxInputEvents) {
+            _pendingEvents.push_back(forwarded);
+        }
+    }
+
+    _pendingTime += io.DeltaTime;
+
+    // Flagged before looking for answers, whichever answer comes after asks for another frame
+    _hasPendingInput.store(!_pendingEvents.empty());
+
+    // Frames drawn by the host since, any of them means it is waiting for input
+    uint8_t acks[64];
+    while (_relay->Read(acks) > 0) {
+        _isHostDrawing = false;
+    }
+
+    if (_isHostDrawing) {
+        return;
+    }
+
+    auto& input = _shared->input;
+
+    input.displaySize = io.DisplaySize;
+    input.framebufferScale = io.DisplayFramebufferScale;
+    input.deltaTime = std::exchange(_pendingTime, 0.0f);
+    input.fontTexture = io.Fonts->TexID;
+
+    input.numEvents = uint32_t(_pendingEvents.size());
+    std::ranges::copy(_pendingEvents, input.events);
+    _pendingEvents.clear();
+
+    uint8_t wakeup = 0;
+
+    if (write(_socket, &wakeup, 1) == 1) {
+        _isHostDrawing = true;
+    }
+    _hasPendingInput.store(false);
+}
+
+bool RemotePlugin::IsStandIn(ImGuiWindow* window) const {
+    return window && std::ranges::find(_standIns, window->RootWindow) != _standIns.end();
+}
+
+void RemotePlugin::EndFrame(ImDrawData* drawData) {
+    ImGuiContext& g = *GImGui;
+
+    if (!_frame) {
+        return;
+    }
+
+    for (uint32_t i = 0; i < std::min<uint32_t>(_frame->numWindows, remote::kMaxWindows); i++) {
+        const auto& window = _frame->windows[i];
+
+        // Below the first of the app's windows drawn above the stand-in
+        auto position = drawData->CmdLists.Size;
+
+        if (i < _standIns.size() && _standIns[i]) {
+            auto it = std::ranges::find(g.Windows, _standIns[i]);
+
+            for (it = it != g.Windows.end() ? it + 1 : it; it != g.Windows.end(); ++it) {
+                auto found = std::ranges::find(drawData->CmdLists, (*it)->DrawList);
+
+                if (found != drawData->CmdLists.end()) {
+                    position = int(found - drawData->CmdLists.begin());
+                    break;
+                }
+            }
+        }
+
+        for (uint64_t j = 0; j < window.numLists && window.firstList + j < _numLists; j++) {
+            auto* list = _lists[window.firstList + j];
+
+            drawData->CmdLists.insert(drawData->CmdLists.begin() + position + j, list);
+            drawData->CmdListsCount++;
+
+            drawData->TotalVtxCount += list->VtxBuffer.Size;
+            drawData->TotalIdxCount += list->IdxBuffer.Size;
+        }
+    }
+}
+
+}
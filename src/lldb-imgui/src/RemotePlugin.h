@@ -0,0 +1,96 @@
+#pragma once
+
+#include "RemoteProtocol.h"
+#include "SocketRelay.h"
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// A plugin running in a plugin host process of its own, so that it can neither crash, nor stall
+/// the app. The host draws in parallel with the app, the app shows the latest frame it published.
+///
+/// The host's draw lists are read out of shared memory, vertices in place, and spliced into the
+/// app's draw data at the depth of invisible stand-in windows, which take the place of the host's windows in the
+/// app's z-order, hover and focus handling. Input is forwarded only to the host the mouse is over,
+/// or the one which has keyboard focus.
+///
+/// Debuggers live in the app's process, so only the plugin's `Draw()` is called out of process.
+class RemotePlugin {
+public:
+    /// Starts a plugin host for the plugin at `path`, null with `status` set on failure
+    static std::unique_ptr<RemotePlugin> Spawn(const std::filesystem::path& path, std::string& status);
+
+    ~RemotePlugin();
+
+    RemotePlugin(const RemotePlugin&) = delete;
+
+    pid_t Pid() const {
+        return _pid;
+    }
+
+    /// Whether the host process is still alive, `status` describes how it ended otherwise
+    bool IsRunning(std::string& status);
+
+    /// Forwards the frame's input to the host, and submits the stand-in windows
+    void Draw();
+
+    /// Splices the host's latest frame into `drawData`
+    void EndFrame(ImDrawData* drawData);
+
+private:
+    RemotePlugin(pid_t pid, int socket, remote::Shared* shared, std::string name);
+
+    using Clock = std::chrono::steady_clock;
+
+    void AcquireFrame();
+    void ForwardInput();
+
+    /// Called on the relay's thread whenever the host finished a frame
+    void OnHostAnswered();
+
+    /// Whether `command` only draws vertices of its list, with a texture of the app's
+    static bool IsValidCommand(const ImDrawCmd& command, const ImVector<ImDrawIdx>& indices, uint32_t numVertices, ImTextureID fontTexture);
+
+    bool IsStandIn(ImGuiWindow* window) const;
+
+    pid_t _pid;
+    int _socket;
+    remote::Shared* _shared;
+
+    // Prefix of the stand-in windows
+    std::string _name;
+
+    // Acknowledgements of the host, one per frame drawn
+    std::unique_ptr<SocketRelay> _relay;
+    bool _isHostDrawing = false;
+
+    // Input which has yet to be handed to the host
+    std::atomic<bool> _hasPendingInput = false;
+
+    std::vector<ImGuiInputEvent> _pendingEvents;
+    float _pendingTime = 0;
+
+    // Slot of the frame the app is showing
+    uint32_t _front = 2;
+    const remote::Frame* _frame = nullptr;
+
+    // Vertices point into the shared memory, the rest is owned. Only the first `_numLists` are part
+    // of the frame.
+    std::vector<ImDrawList*> _lists;
+    uint32_t _numLists = 0;
+
+    std::vector<ImGuiWindow*> _standIns;
+};
+
+}
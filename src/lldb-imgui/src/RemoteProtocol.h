@@ -0,0 +1,101 @@
+#pragma once
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/// Layout of the shared memory between the app, and a plugin host process running a plugin out of
+/// process. Both sides are the same executable, so ImGui structures are shared as they are.
+///
+/// Frames are exchanged over a socket pair, one byte each way. The app writes the input of a frame,
+/// then wakes the host. The host draws the frame, publishes its draw lists if they changed, and
+/// answers with a byte of its own, after which the app may write the input of the next frame. The
+/// app only draws again for a published frame, or once the plugin asked for one.
+namespace lldb::imgui::remote {
+
+static constexpr uint32_t kMagic = 0x4c49524d;
+
+static constexpr size_t kMaxInputEvents = 512;
+static constexpr size_t kMaxWindows = 64;
+static constexpr size_t kMaxLists = 4096;
+
+/// Published frames are triple buffered, so neither side ever waits for the other to be done with one
+static constexpr uint32_t kNumSlots = 3;
+static constexpr size_t kSlotSize = 16 * 1024 * 1024;
+
+/// Set on `Shared::latest` while it holds a frame the app didn't pick up yet
+static constexpr uint32_t kFresh = 0x80000000;
+
+/// File descriptors of the shared memory and the socket in the host process
+static constexpr int kSharedMemoryFd = 3;
+static constexpr int kSocketFd = 4;
+
+/// Written by the app before each wakeup
+struct Input {
+    ImVec2 displaySize;
+    ImVec2 framebufferScale;
+    float deltaTime;
+
+    ImTextureID fontTexture;
+
+    uint32_t numEvents;
+    ImGuiInputEvent events[kMaxInputEvents];
+};
+
+/// A root window of the host, with the draw lists of it and its child windows
+struct Window {
+    ImGuiID id;
+
+    ImVec2 min;
+    ImVec2 max;
+
+    uint32_t firstList;
+    uint32_t numLists;
+};
+
+/// Start of a published frame. Lists follow the header, each as a `List`, then its commands,
+/// vertices and indices, each 16 byte aligned.
+struct Frame {
+    uint64_t frame;
+
+    bool wantCaptureMouse;
+    bool wantCaptureKeyboard;
+
+    uint32_t numWindows;
+    Window windows[kMaxWindows];
+
+    uint32_t numLists;
+};
+
+struct List {
+    uint32_t numCommands;
+    uint32_t numVertices;
+    uint32_t numIndices;
+};
+
+struct Shared {
+    uint32_t magic;
+
+    /// Slot of the most recently published frame, owned by neither side
+    std::atomic<uint32_t> latest;
+
+    /// Earliest frame the plugin asked for through `RequestRedraw`, in steady clock ticks, zero if
+    /// none. Set by the host, taken by the app.
+    std::atomic<int64_t> redrawDeadline;
+
+    Input input;
+
+    alignas(64) uint8_t slots[kNumSlots][kSlotSize];
+};
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Shared between processes");
+static_assert(std::atomic<int64_t>::is_always_lock_free, "Shared between processes");
+
+constexpr size_t AlignUp(size_t offset) {
+    return (offset + 15) & ~size_t(15);
+}
+
+}
@@ -0,0 +1,164 @@
+#include "SocketRelay.h"
+
+#include <poll.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+namespace lldb::imgui {
+
+SocketRelay::SocketRelay(int fd, std::function<void()> onData)
+: _fd(fd)
+, _onData(std::move(onData))
+{
+    _head = _tail = new Block();
+
+    if (pipe(_stopPipe) != 0) {
+        _stopPipe[0] = _stopPipe[1] = -1;
+    }
+
+    _thread = std::thread([this] {
+        Run();
+    });
+}
+
+SocketRelay::~SocketRelay() {
+    if (_stopPipe[1] != -1) {
+        char stop = 0;
+        (void) write(_stopPipe[1], &stop, 1);
+    }
+    _thread.join();
+
+    for (auto fd : _stopPipe) {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    while (_head) {
+        delete std::exchange(_head, _head->next.load());
+    }
+    delete _spare.load();
+}
+
+size_t SocketRelay::Available() const {
+    return _produced.load(std::memory_order_acquire) - _consumed;
+}
+
+size_t SocketRelay::Read(std::span<uint8_t> buffer) {
+    size_t total = 0;
+
+    while (total < buffer.size()) {
+        auto written = _head->written.load(std::memory_order_acquire);
+
+        if (_readOffset == written) {
+            // Caught up with the producer
+            if (written < kBlockSize) {
+                break;
+            }
+
+            auto* next = _head->next.load(std::memory_order_acquire);
+            if (!next) {
+                break;
+            }
+
+            RecycleBlock(std::exchange(_head, next));
+            _readOffset = 0;
+            continue;
+        }
+
+        auto size = std::min(written - _readOffset, buffer.size() - total);
+        memcpy(buffer.data() + total, _head->data + _readOffset, size);
+
+        _readOffset += size;
+        total += size;
+    }
+
+    _consumed += total;
+    return total;
+}
+
+void SocketRelay::Wait() {
+    auto signal = _signal.load(std::memory_order_acquire);
+
+    while (Available() == 0 && !IsClosed()) {
+        _signal.wait(signal, std::memory_order_acquire);
+        signal = _signal.load(std::memory_order_acquire);
+    }
+}
+
+void SocketRelay::Run() {
+    auto notify = [&] {
+        _signal.fetch_add(1, std::memory_order_release);
+        _signal.notify_all();
+
+        if (_onData) {
+            _onData();
+        }
+    };
+
+    while (true) {
+        auto offset = _tail->written.load(std::memory_order_relaxed);
+
+        if (offset == kBlockSize) {
+            auto* block = AllocateBlock();
+
+            _tail->next.store(block, std::memory_order_release);
+            _tail = block;
+            offset = 0;
+        }
+
+        pollfd fds[] = {
+            { .fd = _fd, .events = POLLIN, .revents = 0 },
+            { .fd = _stopPipe[0], .events = POLLIN, .revents = 0 },
+        };
+
+        if (poll(fds, _stopPipe[0] != -1 ? 2 : 1, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents) {
+            break;
+        }
+
+        // As much as fits into the block, which is usually everything the socket has
+        auto size = read(_fd, _tail->data + offset, kBlockSize - offset);
+
+        if (size == -1 && (errno == EINTR || errno == EAGAIN)) {
+            continue;
+        }
+        if (size <= 0) {
+            break;
+        }
+
+        _tail->written.store(offset + size, std::memory_order_release);
+        _produced.fetch_add(size, std::memory_order_release);
+
+        notify();
+    }
+
+    _isClosed.store(true, std::memory_order_release);
+
+    notify();
+}
+
+SocketRelay::Block* SocketRelay::AllocateBlock() {
+    if (auto* block = _spare.exchange(nullptr, std::memory_order_acquire)) {
+        return block;
+    }
+    return new Block();
+}
+
+void SocketRelay::RecycleBlock(Block* block) {
+    block->written.store(0, std::memory_order_relaxed);
+    block->next.store(nullptr, std::memory_order_relaxed);
+
+    delete _spare.exchange(block, std::memory_order_release);
+}
+
+}
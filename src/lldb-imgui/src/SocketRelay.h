@@ -0,0 +1,79 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <thread>
+
+namespace lldb::imgui {
+
+/// Reads a socket on a background thread, into an unbounded single producer, single consumer queue
+/// of large blocks. The socket is read straight into the blocks, and the consumer copies out of them
+/// straight into its own buffer, without any locks in between.
+class SocketRelay {
+public:
+    static constexpr size_t kBlockSize = 64 * 1024;
+
+    /// `onData` is called on the reading thread after new data arrived, or the socket closed
+    SocketRelay(int fd, std::function<void()> onData = {});
+    ~SocketRelay();
+
+    SocketRelay(const SocketRelay&) = delete;
+
+    /// Bytes `Read` could return right now. Consumer only.
+    size_t Available() const;
+
+    /// Copies up to `buffer.size()` bytes into `buffer` without blocking. Consumer only.
+    size_t Read(std::span<uint8_t> buffer);
+
+    /// Blocks until there is data to read, or the socket closed. Consumer only.
+    void Wait();
+
+    /// Whether the peer closed the socket, or reading it failed. Data queued before that is still
+    /// available.
+    bool IsClosed() const {
+        return _isClosed.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Block {
+        std::atomic<size_t> written = 0;
+        std::atomic<Block*> next = nullptr;
+
+        uint8_t data[kBlockSize];
+    };
+
+    void Run();
+
+    Block* AllocateBlock();
+    void RecycleBlock(Block* block);
+
+    int _fd;
+    std::function<void()> _onData;
+
+    // Wakes the reading thread when stopping
+    int _stopPipe[2] = { -1, -1 };
+
+    // Producer side
+    Block* _tail = nullptr;
+
+    // Consumer side
+    Block* _head = nullptr;
+    size_t _readOffset = 0;
+    uint64_t _consumed = 0;
+
+    // A consumed block for the producer to reuse
+    std::atomic<Block*> _spare = nullptr;
+
+    std::atomic<uint64_t> _produced = 0;
+    std::atomic<bool> _isClosed = false;
+
+    // Bumped on every change the consumer may wait for
+    std::atomic<uint32_t> _signal = 0;
+
+    std::thread _thread;
+};
+
+}
@@ -0,0 +1,219 @@
+#include "StreamServer.h"
+
+#include "InputReplay.h"
+#include "lldb-imgui/API.h"
+
+#include "spdlog/spdlog.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace lldb::imgui {
+
+/// Whether `extent` is a size or scale ImGui can lay windows out in
+static bool IsValidExtent(ImVec2 extent) {
+    return std::isfinite(extent.x) && std::isfinite(extent.y) && extent.x >= 0 && extent.y >= 0;
+}
+
+std::unique_ptr<StreamServer> StreamServer::Listen(std::string_view address) {
+    std::string error;
+
+    int listener = stream::OpenSocket(address, true, error);
+    if (listener == -1) {
+        spdlog::error("Failed to serve on '{}': {}", address, error);
+        return nullptr;
+    }
+
+    // Polled for viewers between frames
+    fcntl(listener, F_SETFL, fcntl(listener, F_GETFL) | O_NONBLOCK);
+
+    spdlog::info("Serving the UI on '{}'", address);
+
+    return std::unique_ptr<StreamServer>(new StreamServer(listener));
+}
+
+StreamServer::StreamServer(int listener)
+: _listener(listener)
+{}
+
+StreamServer::~StreamServer() {
+    Disconnect();
+    close(_listener);
+}
+
+bool StreamServer::Update() {
+    Accept();
+
+    if (_viewer == -1) {
+        return false;
+    }
+
+    return Flush() && std::exchange(_isBehind, false);
+}
+
+bool StreamServer::ApplyInput() {
+    ImGuiIO& io = ImGui::GetIO();
+
+    // Frames are far apart while idle, and double clicks shouldn't be made of clicks seconds apart
+    auto now = Clock::now();
+
+    io.DeltaTime = std::max(std::chrono::duration<float>(now - _lastFrame).count(), 1e-4f);
+    _lastFrame = now;
+
+    bool hasInput = false;
+
+    if (_relay) {
+        _reader.Receive(*_relay);
+
+        bool isRejected = false;
+
+        while (auto message = _reader.Next()) {
+            if (message->type != stream::MessageType::Input) {
+                continue;
+            }
+
+            stream::InputHeader header;
+            if (message->payload.size() < sizeof(header)) {
+                isRejected = true;
+                break;
+            }
+            memcpy(&header, message->payload.data(), sizeof(header));
+
+            auto events = message->payload.subspan(sizeof(header));
+            if (events.size() != header.numEvents * sizeof(ImGuiInputEvent)) {
+                isRejected = true;
+                break;
+            }
+            if (!IsValidExtent(header.displaySize) || !IsValidExtent(header.framebufferScale)) {
+                isRejected = true;
+                break;
+            }
+
+            _events.resize(header.numEvents);
+            memcpy(_events.data(), events.data(), events.size());
+
+            if (!ReplayInputEvents(_events)) {
+                isRejected = true;
+                break;
+            }
+
+            _displaySize = header.displaySize;
+            _framebufferScale = header.framebufferScale;
+
+            hasInput |= !_events.empty();
+        }
+
+        // Whatever sent it is broken or hostile, and nothing it sends after can be trusted either
+        if (isRejected) {
+            spdlog::warn("Viewer sent invalid input");
+        }
+        if (isRejected || _reader.IsCorrupt() || (_relay->IsClosed() && _relay->Available() == 0)) {
+            Disconnect();
+        }
+    }
+
+    io.DisplaySize = _displaySize;
+    io.DisplayFramebufferScale = _framebufferScale;
+
+    return hasInput;
+}
+
+void StreamServer::SendFrame(const ImDrawData* drawData) {
+    if (_viewer == -1) {
+        return;
+    }
+
+    // The viewer gets the latest frame once it caught up
+    if (!Flush()) {
+        _isBehind = true;
+        return;
+    }
+
+    if (!_encoder.Encode(drawData, ImGui::GetIO().Fonts->TexID, _payload)) {
+        _framesUnchanged++;
+        return;
+    }
+
+    stream::AppendMessage(_outgoing, stream::MessageType::Frame, _payload);
+    _framesSent++;
+
+    Flush();
+}
+
+void StreamServer::Accept() {
+    int fd = stream::AcceptSocket(_listener);
+    if (fd == -1) {
+        return;
+    }
+
+    // The newest viewer wins
+    Disconnect();
+
+    _viewer = fd;
+    _relay = std::make_unique<SocketRelay>(fd, [] {
+        RequestRedraw();
+    });
+
+    _encoder.Reset();
+
+    stream::Hello hello {
+        .magic = stream::kMagic,
+        .imguiVersion = IMGUI_VERSION_NUM,
+        .vertexSize = sizeof(ImDrawVert),
+        .indexSize = sizeof(ImDrawIdx),
+        .inputEventSize = sizeof(ImGuiInputEvent),
+    };
+    stream::AppendMessage(_outgoing, stream::MessageType::Hello, std::span(reinterpret_cast<const uint8_t*>(&hello), sizeof(hello)));
+
+    // Draws a frame for the viewer right away
+    _isBehind = true;
+
+    spdlog::info("Viewer connected");
+}
+
+void StreamServer::Disconnect() {
+    if (_viewer == -1) {
+        return;
+    }
+
+    spdlog::info("Viewer disconnected after {} frames sent, {} unchanged ones skipped, {} KiB", _framesSent, _framesUnchanged, _bytesSent / 1024);
+
+    // Stops reading before the socket is closed
+    _relay.reset();
+    close(std::exchange(_viewer, -1));
+
+    _reader = {};
+    _outgoing.clear();
+    _sent = 0;
+
+    _framesSent = 0;
+    _framesUnchanged = 0;
+    _bytesSent = 0;
+}
+
+bool StreamServer::Flush() {
+    while (_sent < _outgoing.size()) {
+        auto sent = stream::SendSome(_viewer, std::span(_outgoing).subspan(_sent));
+
+        if (sent < 0) {
+            Disconnect();
+            return false;
+        }
+        if (sent == 0) {
+            return false;
+        }
+
+        _sent += sent;
+        _bytesSent += sent;
+    }
+
+    _outgoing.clear();
+    _sent = 0;
+    return true;
+}
+
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include "DrawStream.h"
+#include "SocketRelay.h"
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Serves the UI of a headless app to a single viewer at a time. Each frame's draw data is sent as
+/// the difference to the last frame the viewer got, and not at all if nothing changed, so a static
+/// screen costs no bandwidth. The viewer's input is replayed as if it was local.
+///
+/// Frames are never queued up for a viewer which can't keep up, they are skipped, and the latest one
+/// is drawn and sent once it caught up.
+class StreamServer {
+public:
+    /// Listens on `address`, given as `[host:]port`, only on the loopback interface unless a host
+    /// is given. Null on failure.
+    static std::unique_ptr<StreamServer> Listen(std::string_view address);
+
+    ~StreamServer();
+
+    StreamServer(const StreamServer&) = delete;
+
+    /// Accepts new viewers, and sends what's left of the last frame. Returns whether a frame should
+    /// be drawn for the viewer.
+    bool Update();
+
+    /// Sets up the frame's display and timing, and replays the viewer's input. Returns whether there
+    /// was any input.
+    bool ApplyInput();
+
+    void SendFrame(const ImDrawData* drawData);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    explicit StreamServer(int listener);
+
+    void Accept();
+    void Disconnect();
+
+    /// Sends as much of the outgoing buffer as the socket takes, true once all of it is sent
+    bool Flush();
+
+    int _listener;
+
+    int _viewer = -1;
+    std::unique_ptr<SocketRelay> _relay;
+    stream::MessageReader _reader;
+    std::vector<ImGuiInputEvent> _events;
+
+    stream::DrawStreamEncoder _encoder;
+    std::vector<uint8_t> _payload;
+
+    std::vector<uint8_t> _outgoing;
+    size_t _sent = 0;
+
+    // Set when a frame was skipped, because the viewer was still receiving the one before
+    bool _isBehind = false;
+
+    ImVec2 _displaySize = ImVec2(1280, 720);
+    ImVec2 _framebufferScale = ImVec2(1, 1);
+
+    Clock::time_point _lastFrame = Clock::now();
+
+    // Of the current viewer
+    uint64_t _framesSent = 0;
+    uint64_t _framesUnchanged = 0;
+    uint64_t _bytesSent = 0;
+};
+
+}
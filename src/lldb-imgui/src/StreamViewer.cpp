@@ -0,0 +1,148 @@
+#include "StreamViewer.h"
+
+#include "lldb-imgui/API.h"
+
+#include "spdlog/spdlog.h"
+
+#include <unistd.h>
+
+#include <cstring>
+#include <format>
+
+namespace lldb::imgui {
+
+std::unique_ptr<StreamViewer> StreamViewer::Connect(std::string_view address) {
+    std::string error;
+
+    int socket = stream::OpenSocket(address, false, error);
+    if (socket == -1) {
+        spdlog::error("Failed to connect to '{}': {}", address, error);
+        return nullptr;
+    }
+
+    spdlog::info("Connected to '{}'", address);
+
+    return std::unique_ptr<StreamViewer>(new StreamViewer(socket, std::string(address)));
+}
+
+StreamViewer::StreamViewer(int socket, std::string address)
+: _socket(socket)
+, _address(std::move(address))
+, _relay(std::make_unique<SocketRelay>(socket, [] {
+    RequestRedraw();
+}))
+{}
+
+StreamViewer::~StreamViewer() {
+    if (IsConnected()) {
+        _relay.reset();
+        close(_socket);
+    }
+}
+
+void StreamViewer::Draw() {
+    Receive();
+    SendInput();
+
+    if (!_decoder.HasFrame()) {
+        auto text = std::format("Waiting for '{}'...", _address);
+
+        ImGui::GetBackgroundDrawList()->AddText(ImVec2(8, 8), IM_COL32_WHITE, text.c_str());
+    }
+}
+
+void StreamViewer::EndFrame(ImDrawData* drawData) {
+    _decoder.EndFrame(drawData);
+}
+
+void StreamViewer::Receive() {
+    if (!IsConnected()) {
+        return;
+    }
+
+    _reader.Receive(*_relay);
+
+    while (auto message = _reader.Next()) {
+        if (message->type == stream::MessageType::Hello) {
+            stream::Hello hello;
+
+            if (message->payload.size() != sizeof(hello)) {
+                Disconnect("not an lldb-imgui server");
+                return;
+            }
+            memcpy(&hello, message->payload.data(), sizeof(hello));
+
+            bool isCompatible = hello.magic == stream::kMagic
+                && hello.imguiVersion == IMGUI_VERSION_NUM
+                && hello.vertexSize == sizeof(ImDrawVert)
+                && hello.indexSize == sizeof(ImDrawIdx)
+                && hello.inputEventSize == sizeof(ImGuiInputEvent);
+
+            if (!isCompatible) {
+                Disconnect("the server is a different build");
+                return;
+            }
+
+            _isHelloReceived = true;
+        } else if (message->type == stream::MessageType::Frame) {
+            if (!_isHelloReceived || !_decoder.Decode(message->payload, ImGui::GetIO().Fonts->TexID)) {
+                Disconnect("received a corrupt frame");
+                return;
+            }
+        }
+    }
+
+    if (_reader.IsCorrupt()) {
+        Disconnect("the stream is corrupt");
+    } else if (_relay->IsClosed() && _relay->Available() == 0) {
+        Disconnect("the server closed the connection");
+    }
+}
+
+void StreamViewer::SendInput() {
+    if (!IsConnected() || !_isHelloReceived) {
+        return;
+    }
+
+    ImGuiContext& g = *GImGui;
+    ImGuiIO& io = g.IO;
+
+    bool isDisplayChanged = io.DisplaySize.x != _sentDisplaySize.x || io.DisplaySize.y != _sentDisplaySize.y
+        || io.DisplayFramebufferScale.x != _sentFramebufferScale.x || io.DisplayFramebufferScale.y != _sentFramebufferScale.y;
+
+    if (g.InputEventsTrail.empty() && !isDisplayChanged) {
+        return;
+    }
+
+    stream::InputHeader header {
+        .displaySize = io.DisplaySize,
+        .framebufferScale = io.DisplayFramebufferScale,
+        .numEvents = uint32_t(g.InputEventsTrail.Size),
+        .reserved = 0,
+    };
+
+    _payload.clear();
+    _payload.insert(_payload.end(), reinterpret_cast<const uint8_t*>(&header), reinterpret_cast<const uint8_t*>(&header + 1));
+    _payload.insert(_payload.end(), reinterpret_cast<const uint8_t*>(g.InputEventsTrail.begin()), reinterpret_cast<const uint8_t*>(g.InputEventsTrail.end()));
+
+    _outgoing.clear();
+    stream::AppendMessage(_outgoing, stream::MessageType::Input, _payload);
+
+    if (!stream::SendAll(_socket, _outgoing)) {
+        Disconnect("failed to send input");
+        return;
+    }
+
+    _sentDisplaySize = io.DisplaySize;
+    _sentFramebufferScale = io.DisplayFramebufferScale;
+}
+
+void StreamViewer::Disconnect(std::string_view reason) {
+    spdlog::info("Disconnected from '{}': {}", _address, reason);
+
+    // Stops reading before the socket is closed
+    _relay.reset();
+    close(std::exchange(_socket, -1));
+}
+
+}
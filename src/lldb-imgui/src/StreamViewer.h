@@ -0,0 +1,61 @@
+#pragma once
+
+#include "DrawStream.h"
+#include "SocketRelay.h"
+
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Shows the UI served by another app's `StreamServer`, and sends the input of this one back
+class StreamViewer {
+public:
+    /// Connects to `address`, given as `[host:]port`. Null on failure.
+    static std::unique_ptr<StreamViewer> Connect(std::string_view address);
+
+    ~StreamViewer();
+
+    StreamViewer(const StreamViewer&) = delete;
+
+    bool IsConnected() const {
+        return _socket != -1;
+    }
+
+    /// Takes the frames which arrived, and sends the frame's input. Has to be called between
+    /// `ImGui::NewFrame()` and `ImGui::Render()`.
+    void Draw();
+
+    /// Adds the latest frame of the server to `drawData`
+    void EndFrame(ImDrawData* drawData);
+
+private:
+    StreamViewer(int socket, std::string address);
+
+    void Receive();
+    void SendInput();
+
+    void Disconnect(std::string_view reason);
+
+    int _socket;
+    std::string _address;
+
+    std::unique_ptr<SocketRelay> _relay;
+    stream::MessageReader _reader;
+
+    bool _isHelloReceived = false;
+    stream::DrawStreamDecoder _decoder;
+
+    ImVec2 _sentDisplaySize;
+    ImVec2 _sentFramebufferScale;
+
+    std::vector<uint8_t> _payload;
+    std::vector<uint8_t> _outgoing;
+};
+
+}
@@ -0,0 +1,233 @@
+#include "SymbolCache.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <utility>
+#include <vector>
+
+namespace lldb::imgui {
+namespace {
+
+constexpr uint64_t kMagic = 0x4d59534955474d49; // "IMGUISYM"
+constexpr uint32_t kVersion = 1;
+
+struct FileHeader {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint64_t entryCount;
+    uint64_t stringsSize;
+};
+
+/// Empty slots have a zero `nameLength`
+struct Slot {
+    uint64_t hash;
+    uint32_t nameOffset;
+    uint32_t nameLength;
+    uint64_t offset;
+};
+
+uint64_t Hash(std::string_view name) {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (char c : name) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+}
+
+std::filesystem::path SymbolCache::PathFor(std::string_view uuid) {
+    std::filesystem::path root;
+
+#if defined(__APPLE__)
+    if (auto* home = getenv("HOME")) {
+        root = std::filesystem::path(home) / "Library" / "Caches";
+    }
+#else
+    if (auto* cache = getenv("XDG_CACHE_HOME")) {
+        root = cache;
+    } else if (auto* home = getenv("HOME")) {
+        root = std::filesystem::path(home) / ".cache";
+    }
+#endif
+
+    if (root.empty()) {
+        root = std::filesystem::temp_directory_path();
+    }
+
+    return root / "lldb-imgui" / "symbols" / std::format("{}.bin", uuid);
+}
+
+std::optional<SymbolCache> SymbolCache::Open(const std::filesystem::path& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd == -1) {
+        return std::nullopt;
+    }
+
+    struct stat stat;
+    if (fstat(fd, &stat) != 0 || static_cast<size_t>(stat.st_size) < sizeof(FileHeader)) {
+        close(fd);
+        return std::nullopt;
+    }
+
+    void* data = mmap(nullptr, stat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        return std::nullopt;
+    }
+
+    SymbolCache cache(reinterpret_cast<const std::byte*>(data), stat.st_size);
+
+    auto* header = reinterpret_cast<const FileHeader*>(cache._data);
+
+    if (header->magic != kMagic || header->version != kVersion) {
+        return std::nullopt;
+    }
+    // A full table would leave misses probing forever
+    if (!std::has_single_bit(header->slotCount) || header->entryCount >= header->slotCount) {
+        return std::nullopt;
+    }
+    if (header->stringsSize > cache._size || sizeof(FileHeader) + header->slotCount * sizeof(Slot) + header->stringsSize != cache._size) {
+        return std::nullopt;
+    }
+
+    return cache;
+}
+
+bool SymbolCache::Write(const std::filesystem::path& path, std::span<const Entry> entries) {
+    // Keep the load factor at or below 50% so misses terminate quickly
+    uint32_t slotCount = std::bit_ceil(std::max<size_t>(entries.size() * 2, 16));
+
+    std::vector<Slot> slots(slotCount);
+    std::string strings;
+
+    uint64_t entryCount = 0;
+
+    for (const auto& entry : entries) {
+        if (entry.name.empty()) {
+            continue;
+        }
+
+        auto hash = Hash(entry.name);
+
+        for (uint32_t i = hash & (slotCount - 1); ; i = (i + 1) & (slotCount - 1)) {
+            auto& slot = slots[i];
+
+            if (slot.nameLength == 0) {
+                slot = Slot {
+                    .hash = hash,
+                    .nameOffset = static_cast<uint32_t>(strings.size()),
+                    .nameLength = static_cast<uint32_t>(entry.name.size()),
+                    .offset = entry.offset,
+                };
+                strings.append(entry.name);
+                entryCount++;
+                break;
+            }
+
+            // First entry wins, just like in the live index
+            if (slot.hash == hash && std::string_view(strings).substr(slot.nameOffset, slot.nameLength) == entry.name) {
+                break;
+            }
+        }
+    }
+
+    FileHeader header {
+        .magic = kMagic,
+        .version = kVersion,
+        .slotCount = slotCount,
+        .entryCount = entryCount,
+        .stringsSize = strings.size(),
+    };
+
+    std::error_code error;
+    std::filesystem::create_directories(path.parent_path(), error);
+
+    // Write to a temporary first so concurrent starts never map a partial file
+    auto staging = path;
+    staging += std::format(".{}", getpid());
+
+    {
+        std::ofstream file(staging, std::ios::binary | std::ios::trunc);
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(slots.data()), slots.size() * sizeof(Slot));
+        file.write(strings.data(), strings.size());
+
+        if (!file) {
+            std::filesystem::remove(staging, error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(staging, path, error);
+    return !error;
+}
+
+SymbolCache::SymbolCache(const std::byte* data, size_t size)
+: _data(data)
+, _size(size)
+{}
+
+SymbolCache::SymbolCache(SymbolCache&& other)
+: _data(std::exchange(other._data, nullptr))
+, _size(std::exchange(other._size, 0))
+{}
+
+SymbolCache& SymbolCache::operator=(SymbolCache&& other) {
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+    return *this;
+}
+
+SymbolCache::~SymbolCache() {
+    if (_data) {
+        munmap(const_cast<std::byte*>(_data), _size);
+    }
+}
+
+std::optional<uint64_t> SymbolCache::Find(std::string_view name) const {
+    auto* header = reinterpret_cast<const FileHeader*>(_data);
+    auto* slots = reinterpret_cast<const Slot*>(_data + sizeof(FileHeader));
+
+    auto strings = std::string_view(reinterpret_cast<const char*>(slots + header->slotCount), header->stringsSize);
+
+    auto hash = Hash(name);
+    auto mask = header->slotCount - 1;
+
+    // Bounded, in case the file lies about how full the table is
+    for (uint32_t i = hash & mask, probes = 0; probes < header->slotCount; i = (i + 1) & mask, probes++) {
+        const auto& slot = slots[i];
+
+        if (slot.nameLength == 0) {
+            return std::nullopt;
+        }
+        if (slot.hash != hash || slot.nameOffset + uint64_t(slot.nameLength) > strings.size()) {
+            continue;
+        }
+        if (strings.substr(slot.nameOffset, slot.nameLength) == name) {
+            return slot.offset;
+        }
+    }
+    return std::nullopt;
+}
+
+size_t SymbolCache::Size() const {
+    return reinterpret_cast<const FileHeader*>(_data)->entryCount;
+}
+
+}
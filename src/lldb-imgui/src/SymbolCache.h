@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <span>
+
+namespace lldb::imgui {
+
+/// Compact on-disk snapshot of the symbols of an image, mapping names to offsets relative to the
+/// image's load address. Files are keyed by the image's UUID/build-id, and are mapped directly
+/// instead of being parsed, so a lookup is a single probe into an open addressed hash table.
+class SymbolCache {
+public:
+    struct Entry {
+        std::string_view name;
+        uint64_t offset;
+    };
+
+    /// Location of the cache file for the image with the given UUID/build-id
+    static std::filesystem::path PathFor(std::string_view uuid);
+
+    static std::optional<SymbolCache> Open(const std::filesystem::path& path);
+    static bool Write(const std::filesystem::path& path, std::span<const Entry> entries);
+
+    SymbolCache(SymbolCache&& other);
+    SymbolCache& operator=(SymbolCache&& other);
+    ~SymbolCache();
+
+    std::optional<uint64_t> Find(std::string_view name) const;
+
+    size_t Size() const;
+
+private:
+    SymbolCache(const std::byte* data, size_t size);
+
+    const std::byte* _data = nullptr;
+    size_t _size = 0;
+};
+
+}
@@ -0,0 +1,574 @@
+#include "SymbolIndex.h"
+
+#include "Trace.h"
+
+#include "lldb/API/LLDB.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <climits>
+#include <cstring>
+#include <future>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Size of the index cache before it is first swept for unused indexes
+static constexpr size_t kMinSweepSize = 64;
+
+/// Bytes of a name compared to a character at once, and padding after the last name
+static constexpr size_t kWindowSize = 64;
+
+static char Fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? char(c - 'A' + 'a') : c;
+}
+
+static bool IsLower(char c) {
+    return c >= 'a' && c <= 'z';
+}
+
+static bool IsUpper(char c) {
+    return c >= 'A' && c <= 'Z';
+}
+
+static bool IsAlphanumeric(char c) {
+    return IsLower(c) || IsUpper(c) || (c >= '0' && c <= '9');
+}
+
+/// Bit of a lowercase character in the character masks. Letters get their own bit, the rest share
+/// the remaining ones.
+static uint32_t CharacterBit(char c) {
+    auto byte = uint8_t(c);
+
+    if (byte >= 'a' && byte <= 'z') {
+        return uint32_t(1) << (byte - 'a');
+    }
+    if (byte >= '0' && byte <= '9') {
+        return uint32_t(1) << 26;
+    }
+    switch (byte) {
+        case '_': return uint32_t(1) << 27;
+        case ':': return uint32_t(1) << 28;
+        case '.': return uint32_t(1) << 29;
+    }
+    return uint32_t(1) << (30 + byte % 2);
+}
+
+/// Bit of a pair of adjacent lowercase characters in the pair masks
+static uint64_t PairBit(char first, char second) {
+    auto hash = (uint32_t(uint8_t(first)) * 0x9e3779b1 ^ uint8_t(second)) * 0x9e3779b1;
+    return uint64_t(1) << (hash >> 26);
+}
+
+static bool IsWordStart(std::string_view name, size_t i) {
+    if (i == 0) {
+        return true;
+    }
+
+    auto previous = name[i - 1];
+    return !IsAlphanumeric(previous) || (IsLower(previous) && IsUpper(name[i]));
+}
+
+/// Bit `i` is set if the `i`th of the `kWindowSize` bytes at `data` is `c`
+static uint64_t EqualBits(const char* data, char c) {
+    uint64_t bits = 0;
+
+#if defined(__SSE2__)
+    auto needle = _mm_set1_epi8(c);
+
+    for (size_t i = 0; i < kWindowSize; i += 16) {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        bits |= uint64_t(uint32_t(_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle)))) << i;
+    }
+#elif defined(__ARM_NEON)
+    // NEON has no movemask, bytes are weighted by their bit and summed instead
+    static constexpr uint8_t kByteBits[] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+
+    auto needle = vdupq_n_u8(uint8_t(c));
+    auto weights = vld1q_u8(kByteBits);
+
+    for (size_t i = 0; i < kWindowSize; i += 16) {
+        auto equal = vandq_u8(vceqq_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(data + i)), needle), weights);
+        bits |= (uint64_t(vaddv_u8(vget_low_u8(equal))) | uint64_t(vaddv_u8(vget_high_u8(equal))) << 8) << i;
+    }
+#else
+    for (size_t i = 0; i < kWindowSize; i++) {
+        bits |= uint64_t(data[i] == c) << i;
+    }
+#endif
+
+    return bits;
+}
+
+/// Bits of the positions in a window, counted from `begin`, which are in `[begin, end)`
+static uint64_t WindowBits(size_t begin, size_t end) {
+    uint64_t bits = ~uint64_t(0);
+
+    if (end - begin < kWindowSize) {
+        bits = (uint64_t(1) << (end - begin)) - 1;
+    }
+    return bits;
+}
+
+/// Position of the first `c` in `folded` at or after `position`, or its size if there is none.
+/// Compares a window at a time, so up to `kWindowSize - 1` bytes past the end of `folded` have to
+/// be readable.
+static size_t FindByte(std::string_view folded, size_t position, char c) {
+    for (size_t window = position; window < folded.size(); window += kWindowSize) {
+        auto bits = EqualBits(folded.data() + window, c) & WindowBits(window, folded.size());
+
+        if (bits) {
+            return window + std::countr_zero(bits);
+        }
+    }
+    return folded.size();
+}
+
+/// Position of `query` in `folded`, see `FindByte`
+static size_t Find(std::string_view folded, std::string_view query) {
+    // Within a single window, every character of the query narrows down where it may start
+    if (folded.size() <= kWindowSize) {
+        auto starts = WindowBits(0, folded.size() - query.size() + 1);
+
+        for (size_t i = 0; i < query.size() && starts; i++) {
+            starts &= EqualBits(folded.data(), query[i]) >> i;
+        }
+        return starts ? std::countr_zero(starts) : std::string_view::npos;
+    }
+
+    for (size_t i = FindByte(folded, 0, query[0]); i + query.size() <= folded.size(); i = FindByte(folded, i + 1, query[0])) {
+        if (memcmp(folded.data() + i, query.data(), query.size()) == 0) {
+            return i;
+        }
+    }
+    return std::string_view::npos;
+}
+
+/// What the masks of a name tell about how it may match a query
+enum class MatchBound {
+    Scattered,
+    Contiguous,
+    ContiguousWordStart,
+};
+
+/// Upper bound of `Score` for a name of `size` characters. Scattered characters are assumed to
+/// start words, contiguous ones to start the name if they may start a word.
+static int MaxScore(size_t size, size_t querySize, MatchBound bound) {
+    int scattered = 45 * int(querySize);
+    int contiguous = 0;
+
+    switch (bound) {
+        case MatchBound::Scattered: break;
+        case MatchBound::Contiguous: contiguous = 1000; break;
+        case MatchBound::ContiguousWordStart: contiguous = size == querySize ? 2400 : 1400; break;
+    }
+
+    return std::max(contiguous, scattered) - int(size);
+}
+
+/// Higher is better, none if `folded` doesn't contain the characters of `query` in order. `folded`
+/// has to be followed by padding, see `FindByte`. `wordStarts` has the bits of the words starting
+/// in the first window of `name` set.
+static std::optional<int> Score(std::string_view folded, std::string_view name, uint64_t wordStarts, std::string_view query, bool mayBeContiguous) {
+    auto isWordStart = [&](size_t i) {
+        return i < kWindowSize ? (wordStarts >> i & 1) != 0 : IsWordStart(name, i);
+    };
+
+    // Contiguous occurrences beat any scattered ones
+    if (auto i = mayBeContiguous && query.size() <= folded.size() ? Find(folded, query) : std::string_view::npos; i != std::string_view::npos) {
+        int score = 1000;
+
+        if (folded.size() == query.size()) {
+            score += 1000;
+        }
+        if (i == 0) {
+            score += 200;
+        }
+        if (isWordStart(i)) {
+            score += 200;
+        }
+        return score - int(folded.size());
+    }
+
+    int score = 0;
+
+    size_t position = 0;
+    size_t previous = std::string_view::npos;
+
+    for (auto c : query) {
+        auto i = FindByte(folded, position, c);
+        if (i == folded.size()) {
+            return std::nullopt;
+        }
+
+        if (previous != std::string_view::npos && i == previous + 1) {
+            score += 15;
+        }
+        if (isWordStart(i)) {
+            score += 30;
+        }
+
+        previous = i;
+        position = i + 1;
+    }
+
+    return score - int(folded.size());
+}
+
+/// Moves the `count` best matches to the front, in no particular order, and drops the rest
+template<typename T>
+static void KeepBest(std::vector<T>& matches, size_t count) {
+    if (matches.size() <= count) {
+        return;
+    }
+
+    std::ranges::nth_element(matches, matches.begin() + count, std::ranges::greater(), &T::score);
+    matches.resize(count);
+}
+
+std::shared_ptr<const ModuleSymbolIndex> ModuleSymbolIndex::Get(SBModule module) {
+    using Future = std::shared_future<std::shared_ptr<const ModuleSymbolIndex>>;
+
+    static std::mutex mutex;
+    static std::unordered_map<std::string, Future> cache;
+    static size_t sweepAt = kMinSweepSize;
+
+    std::string key;
+
+    if (auto* uuid = module.GetUUIDString()) {
+        key = uuid;
+    } else {
+        char path[PATH_MAX];
+        module.GetFileSpec().GetPath(path, sizeof(path));
+
+        key = path;
+    }
+
+    std::promise<std::shared_ptr<const ModuleSymbolIndex>> promise;
+    Future future;
+    bool isBuilding = false;
+    {
+        std::scoped_lock lock(mutex);
+
+        // Indexes only the cache holds on to belong to modules no search uses anymore. Swept
+        // whenever the cache doubled in size, so sweeps take constant time per module on average.
+        if (cache.size() >= sweepAt) {
+            std::erase_if(cache, [](const auto& entry) {
+                const auto& future = entry.second;
+
+                return future.wait_for(std::chrono::seconds(0)) == std::future_status::ready && future.get().use_count() == 1;
+            });
+            sweepAt = std::max(kMinSweepSize, cache.size() * 2);
+        }
+
+        auto [it, isAdded] = cache.try_emplace(key);
+        if (isAdded) {
+            it->second = promise.get_future().share();
+            isBuilding = true;
+        }
+        future = it->second;
+    }
+
+    if (isBuilding) {
+        try {
+            promise.set_value(Build(module));
+        } catch (...) {
+            // Worth another try the next time the module shows up, sweeps only see built indexes
+            {
+                std::scoped_lock lock(mutex);
+                cache.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    return future.get();
+}
+
+std::shared_ptr<const ModuleSymbolIndex> ModuleSymbolIndex::Build(SBModule& module) {
+    TRACE_ZONE("Index symbols");
+
+    auto numSymbols = module.GetNumSymbols();
+
+    // Names are owned by the debugger's string pool, which never frees them
+    std::vector<Symbol> symbols;
+    symbols.reserve(numSymbols);
+
+    for (size_t i = 0; i < numSymbols; i++) {
+        auto symbol = module.GetSymbolAtIndex(i);
+
+        if (auto* name = symbol.GetName()) {
+            symbols.push_back(Symbol {
+                .name = name,
+                .fileAddress = symbol.GetStartAddress().GetFileAddress(),
+            });
+        }
+    }
+
+    auto* name = module.GetFileSpec().GetFilename();
+    return Create(name ? name : "", symbols);
+}
+
+std::shared_ptr<const ModuleSymbolIndex> ModuleSymbolIndex::Create(std::string moduleName, std::span<const Symbol> symbols) {
+    auto index = std::make_shared<ModuleSymbolIndex>();
+    index->_moduleName = std::move(moduleName);
+
+    // Shortest names first, which score the highest. Searches find good matches early on, and skip
+    // most of the longer names without looking at them.
+    std::vector<const Symbol*> sorted;
+    sorted.reserve(symbols.size());
+
+    for (const auto& symbol : symbols) {
+        if (!symbol.name.empty()) {
+            sorted.push_back(&symbol);
+        }
+    }
+
+    std::ranges::stable_sort(sorted, std::ranges::less(), [](const Symbol* symbol) {
+        return symbol->name.size();
+    });
+
+    index->_offsets.reserve(sorted.size() + 1);
+    index->_masks.reserve(sorted.size());
+    index->_wordMasks.reserve(sorted.size());
+    index->_pairMasks.reserve(sorted.size());
+    index->_wordStarts.reserve(sorted.size());
+    index->_addresses.reserve(sorted.size());
+
+    for (const auto* symbol : sorted) {
+        index->_offsets.push_back(uint32_t(index->_names.size()));
+        index->_names.append(symbol->name);
+
+        uint32_t mask = 0;
+        uint32_t wordMask = 0;
+        uint64_t pairMask = 0;
+        uint64_t wordStarts = 0;
+
+        for (size_t i = 0; i < symbol->name.size(); i++) {
+            auto folded = Fold(symbol->name[i]);
+
+            index->_folded.push_back(folded);
+            mask |= CharacterBit(folded);
+
+            if (IsWordStart(symbol->name, i)) {
+                wordMask |= CharacterBit(folded);
+
+                if (i < kWindowSize) {
+                    wordStarts |= uint64_t(1) << i;
+                }
+            }
+            if (i > 0) {
+                pairMask |= PairBit(index->_folded[index->_folded.size() - 2], folded);
+            }
+        }
+
+        index->_masks.push_back(mask);
+        index->_wordMasks.push_back(wordMask);
+        index->_pairMasks.push_back(pairMask);
+        index->_wordStarts.push_back(wordStarts);
+        index->_addresses.push_back(symbol->fileAddress);
+    }
+
+    index->_offsets.push_back(uint32_t(index->_names.size()));
+    index->_folded.append(kWindowSize, '\0');
+
+    return index;
+}
+
+void ModuleSymbolIndex::Search(std::string_view query, size_t begin, size_t end, size_t limit, std::vector<Match>& matches) const {
+    uint32_t queryMask = 0;
+    uint64_t queryPairMask = 0;
+
+    for (size_t i = 0; i < query.size(); i++) {
+        queryMask |= CharacterBit(query[i]);
+
+        if (i > 0) {
+            queryPairMask |= PairBit(query[i - 1], query[i]);
+        }
+    }
+
+    // Most names lack some character of the query, and are rejected a block of masks at a time
+    thread_local std::vector<uint32_t> candidates;
+    candidates.resize(end - begin);
+
+    size_t numCandidates = 0;
+    size_t symbol = begin;
+
+    auto addCandidates = [&](size_t first, uint32_t bits) {
+        for (; bits; bits &= bits - 1) {
+            candidates[numCandidates++] = uint32_t(first + std::countr_zero(bits));
+        }
+    };
+
+#if defined(__SSE2__)
+    auto required = _mm_set1_epi32(int(queryMask));
+
+    for (; symbol + 8 <= end; symbol += 8) {
+        auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_masks.data() + symbol));
+        auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(_masks.data() + symbol + 4));
+
+        auto lowBits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(low, required), required)));
+        auto highBits = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(high, required), required)));
+
+        addCandidates(symbol, uint32_t(lowBits | highBits << 4));
+    }
+#elif defined(__ARM_NEON)
+    auto required = vdupq_n_u32(queryMask);
+
+    for (; symbol + 8 <= end; symbol += 8) {
+        auto low = vceqq_u32(vandq_u32(vld1q_u32(_masks.data() + symbol), required), required);
+        auto high = vceqq_u32(vandq_u32(vld1q_u32(_masks.data() + symbol + 4), required), required);
+
+        // NEON has no movemask, lanes are weighted by their bit and summed instead
+        static constexpr uint16_t kLaneBits[] = { 1, 2, 4, 8, 16, 32, 64, 128 };
+
+        auto equal = vcombine_u16(vmovn_u32(low), vmovn_u32(high));
+        addCandidates(symbol, vaddvq_u16(vandq_u16(equal, vld1q_u16(kLaneBits))));
+    }
+#endif
+
+    for (; symbol < end; symbol++) {
+        addCandidates(symbol, (_masks[symbol] & queryMask) == queryMask);
+    }
+
+    // Min-heap of the best matches so far, anything worse than its top is skipped
+    auto isBetter = [](const Match& a, const Match& b) {
+        return a.score > b.score;
+    };
+
+    for (size_t candidate = 0; candidate < numCandidates; candidate++) {
+        auto i = candidates[candidate];
+
+        auto offset = _offsets[i];
+        auto size = _offsets[i + 1] - offset;
+
+        bool mayBeContiguous = (_pairMasks[i] & queryPairMask) == queryPairMask;
+
+        // Once there are enough matches, most names are too long to beat the worst of them
+        if (matches.size() == limit) {
+            auto worst = matches.front().score;
+
+            // Names only get longer from here on
+            if (size >= query.size() && MaxScore(size, query.size(), MatchBound::ContiguousWordStart) <= worst) {
+                break;
+            }
+
+            auto bound = MatchBound::Scattered;
+
+            if (mayBeContiguous) {
+                bool mayStartWord = _wordMasks[i] & CharacterBit(query[0]);
+                bound = mayStartWord ? MatchBound::ContiguousWordStart : MatchBound::Contiguous;
+            }
+
+            if (MaxScore(size, query.size(), bound) <= worst) {
+                continue;
+            }
+        }
+
+        auto folded = std::string_view(_folded).substr(offset, size);
+        auto name = std::string_view(_names).substr(offset, size);
+
+        auto score = Score(folded, name, _wordStarts[i], query, mayBeContiguous);
+        if (!score) {
+            continue;
+        }
+
+        Match match {
+            .symbol = i,
+            .score = *score,
+        };
+
+        if (matches.size() < limit) {
+            matches.push_back(match);
+            std::ranges::push_heap(matches, isBetter);
+        } else if (match.score > matches.front().score) {
+            std::ranges::pop_heap(matches, isBetter);
+            matches.back() = match;
+            std::ranges::push_heap(matches, isBetter);
+        }
+    }
+}
+
+SymbolSearch::SymbolSearch(ThreadPool& pool)
+: _pool(pool)
+{}
+
+void SymbolSearch::SetModules(std::vector<std::shared_ptr<const ModuleSymbolIndex>> modules) {
+    _modules = std::move(modules);
+    _chunks.clear();
+    _numSymbols = 0;
+
+    for (auto& module : _modules) {
+        for (size_t begin = 0; begin < module->Size(); begin += kChunkSize) {
+            _chunks.push_back(Chunk {
+                .module = module.get(),
+                .begin = begin,
+                .end = std::min(begin + kChunkSize, module->Size()),
+            });
+        }
+        _numSymbols += module->Size();
+    }
+}
+
+std::vector<SymbolSearch::Result> SymbolSearch::Search(std::string_view query) const {
+    TRACE_ZONE("Search symbols");
+
+    std::string folded;
+    std::ranges::transform(query, std::back_inserter(folded), Fold);
+
+    if (folded.empty()) {
+        return {};
+    }
+
+    std::vector<std::vector<Result>> chunkResults(_chunks.size());
+
+    _pool.ParallelFor(_chunks.size(), [&](size_t i) {
+        const auto& chunk = _chunks[i];
+
+        thread_local std::vector<ModuleSymbolIndex::Match> matches;
+        matches.clear();
+
+        chunk.module->Search(folded, chunk.begin, chunk.end, kMaxResults, matches);
+
+        auto& results = chunkResults[i];
+        results.reserve(matches.size());
+
+        for (auto& match : matches) {
+            results.push_back(Result {
+                .module = chunk.module,
+                .symbol = match.symbol,
+                .score = match.score,
+            });
+        }
+    });
+
+    std::vector<Result> results;
+
+    for (auto& chunk : chunkResults) {
+        results.insert(results.end(), chunk.begin(), chunk.end());
+    }
+
+    KeepBest(results, kMaxResults);
+
+    std::ranges::sort(results, [](const Result& a, const Result& b) {
+        if (a.score != b.score) {
+            return a.score > b.score;
+        }
+        return a.module->Name(a.symbol) < b.module->Name(b.symbol);
+    });
+
+    return results;
+}
+
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include "ThreadPool.h"
+
+#include "lldb/API/SBModule.h"
+
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Symbol names of a single module, laid out for matching: one buffer of names, one of their
+/// lowercase versions, and masks of the characters in each name to reject most of them without
+/// looking at the name at all. Symbols are ordered by the length of their names.
+class ModuleSymbolIndex {
+public:
+    /// Index of `module`, shared by every module with the same UUID, or path if it has none. Blocks
+    /// while the index is being built, which may happen on any thread, and throws if building it
+    /// failed. Indexes are dropped once nothing but the cache holds on to them.
+    static std::shared_ptr<const ModuleSymbolIndex> Get(SBModule module);
+
+    struct Symbol {
+        std::string_view name;
+        uint64_t fileAddress;
+    };
+
+    /// Index of `symbols`, skipping the ones without a name. How `Get` indexes modules, and what
+    /// benchmarks index instead of a module.
+    static std::shared_ptr<const ModuleSymbolIndex> Create(std::string moduleName, std::span<const Symbol> symbols);
+
+    std::string_view ModuleName() const {
+        return _moduleName;
+    }
+
+    size_t Size() const {
+        return _addresses.size();
+    }
+
+    std::string_view Name(size_t symbol) const {
+        return std::string_view(_names).substr(_offsets[symbol], _offsets[symbol + 1] - _offsets[symbol]);
+    }
+
+    uint64_t FileAddress(size_t symbol) const {
+        return _addresses[symbol];
+    }
+
+    struct Match {
+        uint32_t symbol;
+        int score;
+    };
+
+    /// Collects up to `limit` of the best matching symbols in `[begin, end)` into `matches`, which
+    /// have to contain the characters of `query` in order. `query` has to be lowercase.
+    void Search(std::string_view query, size_t begin, size_t end, size_t limit, std::vector<Match>& matches) const;
+
+private:
+    static std::shared_ptr<const ModuleSymbolIndex> Build(SBModule& module);
+
+    std::string _moduleName;
+
+    std::string _names;
+
+    // Followed by padding, so matching may read whole windows past the end of the last name
+    std::string _folded;
+    std::vector<uint32_t> _offsets;
+
+    std::vector<uint32_t> _masks;
+
+    // Characters which start words, and pairs of adjacent characters. They rule out containing most
+    // queries as is, and in the places which score the highest.
+    std::vector<uint32_t> _wordMasks;
+    std::vector<uint64_t> _pairMasks;
+
+    // Positions of the words starting in the first window of each name, which matching compares at once
+    std::vector<uint64_t> _wordStarts;
+
+    std::vector<uint64_t> _addresses;
+};
+
+/// Searches the symbols of a set of modules, in parallel, for the best fuzzy matches
+class SymbolSearch {
+public:
+    static constexpr size_t kMaxResults = 256;
+
+    struct Result {
+        const ModuleSymbolIndex* module;
+        uint32_t symbol;
+        int score;
+    };
+
+    explicit SymbolSearch(ThreadPool& pool);
+
+    void SetModules(std::vector<std::shared_ptr<const ModuleSymbolIndex>> modules);
+
+    size_t NumModules() const {
+        return _modules.size();
+    }
+    const ModuleSymbolIndex* Module(size_t index) const {
+        return _modules[index].get();
+    }
+
+    size_t NumSymbols() const {
+        return _numSymbols;
+    }
+
+    /// The best matches first
+    std::vector<Result> Search(std::string_view query) const;
+
+private:
+    // Slices of modules, so large ones are split across threads
+    struct Chunk {
+        const ModuleSymbolIndex* module;
+        size_t begin;
+        size_t end;
+    };
+
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    ThreadPool& _pool;
+
+    std::vector<std::shared_ptr<const ModuleSymbolIndex>> _modules;
+    std::vector<Chunk> _chunks;
+    size_t _numSymbols = 0;
+};
+
+}
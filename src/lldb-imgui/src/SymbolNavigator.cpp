@@ -0,0 +1,182 @@
+#include "SymbolNavigator.h"
+
+#include "lldb-imgui/API.h"
+#include "lldb-imgui/Query.h"
+
+#include "lldb/API/LLDB.h"
+
+#include "imgui.h"
+
+#include "spdlog/spdlog.h"
+
+#include <cfloat>
+#include <chrono>
+
+namespace lldb::imgui {
+
+SymbolNavigator::SymbolNavigator(ThreadPool& pool)
+: _pool(pool)
+, _search(std::make_shared<SymbolSearch>(pool))
+{}
+
+void SymbolNavigator::UpdateModules(SBDebugger& debugger) {
+    // Targets load and unload modules as their processes run, which only shows while stopped
+    auto generation = GetDebuggerGeneration(debugger);
+
+    if (std::exchange(_generation, generation) != generation) {
+        _modulesQuery = Submit(debugger, [](SBDebugger& debugger) {
+            std::vector<SBModule> modules;
+
+            for (uint32_t i = 0; i < debugger.GetNumTargets(); i++) {
+                auto target = debugger.GetTargetAtIndex(i);
+
+                for (uint32_t j = 0; j < target.GetNumModules(); j++) {
+                    modules.push_back(target.GetModuleAtIndex(j));
+                }
+            }
+            return modules;
+        });
+    }
+
+    if (_modulesQuery && _modulesQuery->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        try {
+            auto modules = _modulesQuery->get();
+
+            _build = std::make_shared<Build>();
+            _build->modules.resize(modules.size());
+            _build->numPending = modules.size();
+
+            for (size_t i = 0; i < modules.size(); i++) {
+                _pool.Submit([build = _build, module = modules[i], i] {
+                    try {
+                        build->modules[i] = ModuleSymbolIndex::Get(module);
+                    } catch (const std::exception& e) {
+                        spdlog::error("Failed to index the symbols of a module: {}", e.what());
+                    }
+
+                    if (--build->numPending == 0) {
+                        RequestRedraw();
+                    }
+                });
+            }
+        } catch (const QueryCancelled&) {
+            // Try again next frame
+            _generation = 0;
+        }
+        _modulesQuery.reset();
+    }
+
+    if (_build && _build->numPending == 0) {
+        // Modules only change once in a while, the same set is usually indexed already
+        std::vector<const ModuleSymbolIndex*> previous;
+        std::vector<const ModuleSymbolIndex*> current;
+
+        // Modules which failed to index are left out
+        std::erase(_build->modules, nullptr);
+
+        for (size_t i = 0; i < _search->NumModules(); i++) {
+            previous.push_back(_search->Module(i));
+        }
+        for (auto& module : _build->modules) {
+            current.push_back(module.get());
+        }
+
+        if (previous != current) {
+            auto search = std::make_shared<SymbolSearch>(_pool);
+            search->SetModules(std::move(_build->modules));
+
+            _search = std::move(search);
+            _isSearchStale = true;
+        }
+        _build.reset();
+    }
+}
+
+void SymbolNavigator::Draw(SBDebugger& debugger) {
+    using namespace ImGui;
+
+    UpdateModules(debugger);
+
+    SetNextItemWidth(-FLT_MIN);
+    if (IsWindowAppearing()) {
+        SetKeyboardFocusHere();
+    }
+    InputTextWithHint("##Query", "Search symbols", _query.data(), _query.size());
+
+    std::string_view query(_query.data());
+
+    // A search of a few million symbols takes longer than a frame, so one runs at a time, and the
+    // latest query goes next
+    if (_searching && _searching->isDone.load(std::memory_order_acquire)) {
+        _results = std::move(_searching->results);
+        _resultsSearch = std::move(_searching->search);
+        _searchMs = _searching->ms;
+
+        _searching.reset();
+    }
+
+    if (!_searching && (query != _searchedQuery || _isSearchStale)) {
+        _searching = std::make_shared<Searching>();
+        _searching->search = _search;
+
+        _searchedQuery = query;
+        _isSearchStale = false;
+
+        _pool.Submit([searching = _searching, query = _searchedQuery] {
+            auto start = std::chrono::steady_clock::now();
+
+            searching->results = searching->search->Search(query);
+            searching->ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            searching->isDone.store(true, std::memory_order_release);
+
+            RequestRedraw();
+        });
+    }
+
+    if (_build) {
+        TextDisabled("Indexing %zu of %zu modules...", _build->modules.size() - _build->numPending, _build->modules.size());
+    } else if (_searching) {
+        TextDisabled("Searching %zu symbols...", _search->NumSymbols());
+    } else if (query.empty()) {
+        TextDisabled("%zu symbols in %zu modules", _search->NumSymbols(), _search->NumModules());
+    } else {
+        TextDisabled("%zu best matches of %zu symbols, in %.1f ms", _results.size(), _search->NumSymbols(), _searchMs);
+    }
+
+    auto flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+
+    if (!BeginTable("Symbols", 3, flags)) {
+        return;
+    }
+
+    TableSetupScrollFreeze(0, 1);
+    TableSetupColumn("Name", ImGuiTableColumnFlags_WidthStretch);
+    TableSetupColumn("Module", ImGuiTableColumnFlags_WidthFixed);
+    TableSetupColumn("File address", ImGuiTableColumnFlags_WidthFixed);
+    TableHeadersRow();
+
+    ImGuiListClipper clipper;
+    clipper.Begin(int(_results.size()));
+
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            const auto& result = _results[row];
+            auto name = result.module->Name(result.symbol);
+            auto moduleName = result.module->ModuleName();
+
+            TableNextRow();
+            TableNextColumn();
+            TextUnformatted(name.data(), name.data() + name.size());
+
+            TableNextColumn();
+            TextUnformatted(moduleName.data(), moduleName.data() + moduleName.size());
+
+            TableNextColumn();
+            Text("0x%llx", (unsigned long long) result.module->FileAddress(result.symbol));
+        }
+    }
+
+    EndTable();
+}
+
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "SymbolIndex.h"
+#include "ThreadPool.h"
+
+#include "lldb/API/SBDebugger.h"
+
+#include <array>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Fuzzy search over the symbols of all modules of a debugger's targets. Modules are indexed on the
+/// thread pool the first time they show up, and searched there on every keystroke, while the last
+/// results stay on screen.
+class SymbolNavigator {
+public:
+    explicit SymbolNavigator(ThreadPool& pool);
+
+    void Draw(SBDebugger& debugger);
+
+private:
+    /// Modules being indexed
+    struct Build {
+        std::vector<std::shared_ptr<const ModuleSymbolIndex>> modules;
+        std::atomic<size_t> numPending = 0;
+    };
+
+    /// Search running on the pool
+    struct Searching {
+        std::shared_ptr<const SymbolSearch> search;
+
+        std::vector<SymbolSearch::Result> results;
+        double ms = 0;
+
+        std::atomic<bool> isDone = false;
+    };
+
+    void UpdateModules(SBDebugger& debugger);
+
+    ThreadPool& _pool;
+
+    // Replaced rather than changed, searches still running hold on to theirs
+    std::shared_ptr<const SymbolSearch> _search;
+
+    uint64_t _generation = 0;
+    std::optional<std::shared_future<std::vector<SBModule>>> _modulesQuery;
+    std::shared_ptr<Build> _build;
+
+    std::array<char, 256> _query {};
+    std::string _searchedQuery;
+    bool _isSearchStale = false;
+
+    std::shared_ptr<Searching> _searching;
+
+    // Along with the search holding on to the modules they point into
+    std::shared_ptr<const SymbolSearch> _resultsSearch;
+    std::vector<SymbolSearch::Result> _results;
+    double _searchMs = 0;
+};
+
+}
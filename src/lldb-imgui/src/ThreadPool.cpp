@@ -0,0 +1,104 @@
+#include "ThreadPool.h"
+
+#include "Trace.h"
+
+#include <atomic>
+#include <format>
+#include <memory>
+
+namespace lldb::imgui {
+
+ThreadPool::ThreadPool(size_t numThreads) {
+    for (size_t i = 0; i < numThreads; i++) {
+        _threads.emplace_back([this, i](std::stop_token stop) {
+            SetTraceThreadName(std::format("Pool {}", i));
+            Run(stop);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    for (auto& thread : _threads) {
+        thread.request_stop();
+    }
+    _wakeup.notify_all();
+
+    _threads.clear();
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    {
+        std::scoped_lock lock(_mutex);
+        _tasks.push_back(std::move(task));
+    }
+    _wakeup.notify_one();
+}
+
+void ThreadPool::ParallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Outlives the call, in case helpers only get to run once the work is done
+    struct State {
+        size_t count;
+        const std::function<void(size_t)>* body;
+
+        std::atomic<size_t> next = 0;
+        std::atomic<size_t> done = 0;
+
+        void Work() {
+            for (auto i = next++; i < count; i = next++) {
+                (*body)(i);
+
+                if (++done == count) {
+                    done.notify_all();
+                }
+            }
+        }
+    };
+
+    auto state = std::make_shared<State>();
+    state->count = count;
+    state->body = &body;
+
+    auto helpers = std::min(count, _threads.size() + 1) - 1;
+
+    {
+        // Ahead of queued tasks, the caller is waiting for these
+        std::scoped_lock lock(_mutex);
+
+        for (size_t i = 0; i < helpers; i++) {
+            _tasks.push_front([state] {
+                state->Work();
+            });
+        }
+    }
+    _wakeup.notify_all();
+
+    state->Work();
+
+    for (auto done = state->done.load(); done < count; done = state->done.load()) {
+        state->done.wait(done);
+    }
+}
+
+void ThreadPool::Run(std::stop_token stop) {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock lock(_mutex);
+
+            if (!_wakeup.wait(lock, stop, [&] { return !_tasks.empty(); })) {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Fixed set of worker threads for CPU bound work, which doesn't touch the debugger's locks for long
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t numThreads = std::max(std::thread::hardware_concurrency(), 2u) - 1);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+
+    size_t Size() const {
+        return _threads.size();
+    }
+
+    /// Safe to call from any thread.
+    void Submit(std::function<void()> task);
+
+    /// Runs `body(i)` for every `i` in `[0, count)` on the workers and the calling thread, and
+    /// returns once all of them finished
+    void ParallelFor(size_t count, const std::function<void(size_t)>& body);
+
+private:
+    void Run(std::stop_token stop);
+
+    std::mutex _mutex;
+    std::condition_variable_any _wakeup;
+    std::deque<std::function<void()>> _tasks;
+
+    std::vector<std::jthread> _threads;
+};
+
+}
@@ -0,0 +1,209 @@
+#include "Trace.h"
+
+#include <spdlog/spdlog.h>
+
+#include <atomic>
+#include <format>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb::imgui {
+
+struct TraceName {
+    std::string name;
+};
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct TraceEvent {
+    const TraceName* name;
+    Clock::time_point start;
+    Clock::time_point end;
+};
+
+/// Zones recorded by a single thread, the oldest are overwritten once full. Kept after the thread
+/// exits, so its zones still make it into the trace.
+struct ThreadBuffer {
+    static constexpr size_t kCapacity = 64 * 1024;
+
+    uint32_t tid = 0;
+    std::string threadName;
+
+    std::unique_ptr<TraceEvent[]> events = std::make_unique<TraceEvent[]>(kCapacity);
+    std::atomic<uint64_t> count = 0;
+};
+
+struct TraceState {
+    std::mutex mutex;
+
+    // Only grow, as interned names and thread buffers are referenced without holding the lock
+    std::unordered_map<std::string, std::unique_ptr<TraceName>> names;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    std::atomic<bool> isTracing = false;
+    std::atomic<Clock::rep> startTime = 0;
+};
+
+// Zones may be recorded during static initialization, or while plugins resolve exposed symbols
+TraceState& GetState() {
+    static TraceState state;
+    return state;
+}
+
+thread_local ThreadBuffer* t_buffer = nullptr;
+
+ThreadBuffer& GetThreadBuffer() {
+    if (!t_buffer) {
+        auto& state = GetState();
+        std::scoped_lock lock(state.mutex);
+
+        auto& buffer = state.buffers.emplace_back(std::make_unique<ThreadBuffer>());
+        buffer->tid = uint32_t(state.buffers.size());
+        buffer->threadName = std::format("Thread {}", buffer->tid);
+
+        t_buffer = buffer.get();
+    }
+    return *t_buffer;
+}
+
+void AppendEscaped(std::string& output, std::string_view string) {
+    for (auto c : string) {
+        switch (c) {
+        case '"': output += "\\\""; break;
+        case '\\': output += "\\\\"; break;
+        case '\n': output += "\\n"; break;
+        case '\t': output += "\\t"; break;
+        default:
+            if (uint8_t(c) < 0x20) {
+                output += std::format("\\u{:04x}", c);
+            } else {
+                output += c;
+            }
+            break;
+        }
+    }
+}
+
+double Microseconds(Clock::duration duration) {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+}
+
+const TraceName* InternTraceName(std::string_view name) {
+    auto& state = GetState();
+    std::scoped_lock lock(state.mutex);
+
+    auto& interned = state.names[std::string(name)];
+    if (!interned) {
+        interned = std::make_unique<TraceName>(TraceName { .name = std::string(name) });
+    }
+    return interned.get();
+}
+
+bool IsTracing() {
+    return GetState().isTracing.load(std::memory_order_relaxed);
+}
+
+void RecordTraceZone(const TraceName* name, Clock::time_point start, Clock::time_point end) {
+    if (!IsTracing()) {
+        return;
+    }
+
+    auto& buffer = GetThreadBuffer();
+
+    // Only this thread writes the buffer, the count publishes the event to `WriteTrace`
+    auto index = buffer.count.load(std::memory_order_relaxed);
+    buffer.events[index % ThreadBuffer::kCapacity] = {
+        .name = name,
+        .start = start,
+        .end = end,
+    };
+    buffer.count.store(index + 1, std::memory_order_release);
+}
+
+void StartTracing() {
+    auto& state = GetState();
+
+    state.startTime.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    state.isTracing.store(true, std::memory_order_relaxed);
+}
+
+void StopTracing() {
+    GetState().isTracing.store(false, std::memory_order_relaxed);
+}
+
+bool WriteTrace(const std::filesystem::path& path) {
+    auto& state = GetState();
+
+    auto startTime = Clock::time_point(Clock::duration(state.startTime.load(std::memory_order_relaxed)));
+
+    std::string output = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool isFirst = true;
+    size_t numEvents = 0;
+
+    auto beginEvent = [&] {
+        if (!isFirst) {
+            output += ",\n";
+        }
+        isFirst = false;
+    };
+
+    {
+        std::scoped_lock lock(state.mutex);
+
+        for (auto& buffer : state.buffers) {
+            beginEvent();
+            output += std::format(R"({{"name":"thread_name","ph":"M","pid":1,"tid":{},"args":{{"name":")", buffer->tid);
+            AppendEscaped(output, buffer->threadName);
+            output += "\"}}";
+
+            // Events which are overwritten while copying are torn, which only costs a bogus zone
+            // while recording continues
+            auto count = buffer->count.load(std::memory_order_acquire);
+            auto first = count > ThreadBuffer::kCapacity ? count - ThreadBuffer::kCapacity : 0;
+
+            for (auto i = first; i < count; i++) {
+                auto event = buffer->events[i % ThreadBuffer::kCapacity];
+                if (event.start < startTime) {
+                    continue;
+                }
+
+                beginEvent();
+                output += R"({"name":")";
+                AppendEscaped(output, event.name->name);
+                output += std::format(R"(","ph":"X","pid":1,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+                    buffer->tid, Microseconds(event.start - startTime), Microseconds(event.end - event.start));
+                numEvents++;
+            }
+        }
+    }
+
+    output += "\n]}\n";
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(output.data(), output.size());
+
+    if (!file) {
+        spdlog::error("Failed to write trace to {}", path.string());
+        return false;
+    }
+
+    spdlog::info("Wrote {} trace zones to {}", numEvents, path.string());
+    return true;
+}
+
+void SetTraceThreadName(std::string_view name) {
+    auto& buffer = GetThreadBuffer();
+
+    std::scoped_lock lock(GetState().mutex);
+    buffer.threadName = name;
+}
+
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "lldb-imgui/Trace.h"
+
+#include <filesystem>
+#include <string_view>
+
+namespace lldb::imgui {
+
+/// Starts recording zones, those recorded before are left out of the next trace
+void StartTracing();
+void StopTracing();
+
+/// Writes the zones recorded since tracing last started as Chrome trace JSON
+bool WriteTrace(const std::filesystem::path& path);
+
+/// Names the calling thread in traces
+void SetTraceThreadName(std::string_view name);
+
+}
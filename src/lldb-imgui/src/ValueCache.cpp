@@ -0,0 +1,183 @@
+#include "ValueCache.h"
+
+#include "lldb/API/LLDB.h"
+
+#include <algorithm>
+#include <format>
+
+namespace lldb::imgui {
+
+static ValueCache* g_values = nullptr;
+
+const ValueInfo* FetchValue(SBDebugger& debugger, const ValuePath& path) {
+    return g_values ? g_values->Fetch(debugger, path) : nullptr;
+}
+
+void ForgetValues(OwnerID owner) {
+    if (g_values) {
+        g_values->Forget(owner);
+    }
+}
+
+ValueInfo SnapshotValue(SBValue& value) {
+    ValueInfo info;
+
+    if (auto error = value.GetError(); error.Fail()) {
+        auto* message = error.GetCString();
+
+        info.error = message ? message : "Unknown error";
+        return info;
+    }
+
+    auto string = [](const char* str) {
+        return str ? std::string(str) : std::string();
+    };
+
+    info.isValid = value.IsValid();
+    info.type = string(value.GetDisplayTypeName());
+    info.value = string(value.GetValue());
+    info.summary = string(value.GetSummary());
+    info.numChildren = value.GetNumChildren();
+
+    return info;
+}
+
+class ValueCache::FetchTask : public QueryTask {
+public:
+    FetchTask(ValuePath path, std::shared_ptr<Entry> entry)
+    : _path(std::move(path))
+    , _entry(std::move(entry))
+    {}
+
+    void Run(SBDebugger& debugger) override {
+        auto process = debugger.GetSelectedTarget().GetProcess();
+
+        auto thread = _path.threadID ? process.GetThreadByID(_path.threadID) : process.GetSelectedThread();
+        auto frame = thread.GetFrameAtIndex(_path.frameIndex);
+
+        if (!frame.IsValid()) {
+            _entry->info.error = "No such frame";
+            return;
+        }
+
+        auto value = frame.GetValueForVariablePath(_path.path.c_str());
+
+        _entry->info = SnapshotValue(value);
+    }
+
+    void Complete() override {
+        _entry->isReady.store(true, std::memory_order_release);
+        MarkWaitingDirty();
+    }
+    void Cancel() override {
+        _entry->isCancelled.store(true, std::memory_order_release);
+        MarkWaitingDirty();
+    }
+
+private:
+    void MarkWaitingDirty() {
+        std::lock_guard lock(_entry->mutex);
+
+        for (auto owner : _entry->waiting) {
+            MarkOwnerDirty(owner);
+        }
+        _entry->waiting.clear();
+    }
+
+    ValuePath _path;
+
+    // Kept alive if the cache drops it first
+    std::shared_ptr<Entry> _entry;
+};
+
+ValueCache::ValueCache(QueryEngine& queries)
+: _queries(queries)
+{
+    g_values = this;
+}
+
+ValueCache::~ValueCache() {
+    g_values = nullptr;
+}
+
+void ValueCache::BeginFrame(std::span<SBDebugger> debuggers) {
+    for (auto& debugger : debuggers) {
+        auto& scope = _scopes[debugger.GetID()];
+        auto generation = _queries.Generation(debugger);
+
+        if (std::exchange(scope.generation, generation) != generation) {
+            scope.entries.clear();
+        }
+    }
+
+    // Plugins may fetch from debuggers the app doesn't know about, which are dropped once destroyed
+    std::erase_if(_scopes, [&](const auto& entry) {
+        auto id = entry.first;
+
+        if (std::ranges::any_of(debuggers, [&](SBDebugger& debugger) { return debugger.GetID() == id; })) {
+            return false;
+        }
+        return !SBDebugger::FindDebuggerWithID(int(id)).IsValid();
+    });
+}
+
+void ValueCache::Forget(OwnerID owner) {
+    for (auto& [_, scope] : _scopes) {
+        std::erase(scope.watchers, owner);
+
+        for (auto& [_, entry] : scope.entries) {
+            std::lock_guard lock(entry->mutex);
+            std::erase(entry->waiting, owner);
+        }
+    }
+}
+
+const ValueInfo* ValueCache::Fetch(SBDebugger& debugger, const ValuePath& path) {
+    auto& scope = _scopes[debugger.GetID()];
+
+    // Not one of the app's debuggers, so `BeginFrame` never saw it
+    if (scope.generation == 0) {
+        scope.generation = _queries.Generation(debugger);
+    }
+
+    auto owner = CurrentOwner();
+
+    if (owner != kAppOwner && std::ranges::find(scope.watchers, owner) == scope.watchers.end()) {
+        scope.watchers.push_back(owner);
+        _queries.Watch(debugger, owner);
+    }
+
+    auto key = std::format("{}/{}/{}", path.threadID, path.frameIndex, path.path);
+
+    auto& entry = scope.entries[key];
+
+    // Cancelled fetches are retried, whatever cancelled them may not drop the scope
+    if (!entry || entry->isCancelled.load(std::memory_order_acquire)) {
+        entry = std::make_shared<Entry>();
+
+        // Shared between plugins, so owned by the app rather than whichever plugin asked first
+        _queries.Submit(debugger, std::make_shared<FetchTask>(path, entry), kAppOwner);
+    }
+
+    if (entry->isReady.load(std::memory_order_acquire)) {
+        return &entry->info;
+    }
+
+    // Whoever asked runs again once the value is there
+    std::lock_guard lock(entry->mutex);
+
+    if (entry->isReady.load(std::memory_order_acquire)) {
+        return &entry->info;
+    }
+    if (entry->isCancelled.load(std::memory_order_acquire)) {
+        // Fetched again the next time around
+        MarkOwnerDirty(owner);
+        return nullptr;
+    }
+    if (std::ranges::find(entry->waiting, owner) == entry->waiting.end()) {
+        entry->waiting.push_back(owner);
+    }
+    return nullptr;
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "lldb-imgui/Values.h"
+
+#include "QueryEngine.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Blocks on the debugger, so belongs on the query thread
+ValueInfo SnapshotValue(SBValue& value);
+
+/// Backs `FetchValue`, holding the values fetched in each debugger's current generation
+class ValueCache {
+public:
+    explicit ValueCache(QueryEngine& queries);
+    ~ValueCache();
+
+    ValueCache(const ValueCache&) = delete;
+
+    /// Drops the values of debuggers which changed generation, so the results of `Fetch` are
+    /// consistent for the rest of the frame
+    void BeginFrame(std::span<SBDebugger> debuggers);
+
+    const ValueInfo* Fetch(SBDebugger& debugger, const ValuePath& path);
+
+    /// Stops tracking `owner`, whose code was unloaded
+    void Forget(OwnerID owner);
+
+private:
+    class FetchTask;
+
+    struct Entry {
+        std::atomic<bool> isReady = false;
+        std::atomic<bool> isCancelled = false;
+        ValueInfo info;
+
+        // Marked dirty once the fetch is over
+        std::mutex mutex;
+        std::vector<OwnerID> waiting;
+    };
+
+    struct Scope {
+        uint64_t generation = 0;
+        std::unordered_map<std::string, std::shared_ptr<Entry>> entries;
+
+        // Owners which asked for values, and get to fetch them again when the state changes
+        std::vector<OwnerID> watchers;
+    };
+
+    QueryEngine& _queries;
+
+    std::unordered_map<lldb::user_id_t, Scope> _scopes;
+};
+
+/// See `ValueCache::Forget`
+void ForgetValues(OwnerID owner);
+
+}
@@ -0,0 +1,285 @@
+#include "VariableTree.h"
+
+#include "ValueCache.h"
+
+#include "lldb/API/LLDB.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace lldb::imgui {
+
+class VariableTree::PageTask : public QueryTask {
+public:
+    PageTask(std::vector<uint32_t> indexPath, uint32_t first, std::shared_ptr<Page> page, std::shared_ptr<ContainerFormatter> formatter)
+    : _indexPath(std::move(indexPath))
+    , _first(first)
+    , _page(std::move(page))
+    , _formatter(std::move(formatter))
+    {}
+
+    void Run(SBDebugger& debugger) override {
+        auto frame = debugger.GetSelectedTarget().GetProcess().GetSelectedThread().GetSelectedFrame();
+
+        // Arguments, locals, and no statics
+        auto variables = frame.GetVariables(true, true, false, true);
+
+        auto add = [&](SBValue value) {
+            auto* name = value.GetName();
+
+            _page->children.push_back(Child {
+                .name = name ? name : "",
+                .info = SnapshotValue(value),
+            });
+        };
+
+        if (_indexPath.empty()) {
+            _page->numChildren = variables.GetSize();
+
+            for (uint32_t i = _first; i < std::min(_first + kPageSize, _page->numChildren); i++) {
+                add(variables.GetValueAtIndex(i));
+            }
+            return;
+        }
+
+        auto value = variables.GetValueAtIndex(_indexPath[0]);
+
+        for (size_t i = 1; i < _indexPath.size(); i++) {
+            value = value.GetChildAtIndex(_indexPath[i]);
+        }
+
+        // Standard containers are much cheaper to read directly
+        if (auto page = _formatter->Read(value, _first, kPageSize)) {
+            _page->numChildren = page->numChildren;
+            _page->children = std::move(page->elements);
+            return;
+        }
+
+        _page->numChildren = value.GetNumChildren();
+
+        for (uint32_t i = _first; i < std::min(_first + kPageSize, _page->numChildren); i++) {
+            add(value.GetChildAtIndex(i));
+        }
+    }
+
+    void Complete() override {
+        _page->isReady.store(true, std::memory_order_release);
+    }
+    void Cancel() override {
+        _page->isCancelled.store(true, std::memory_order_release);
+    }
+
+private:
+    std::vector<uint32_t> _indexPath;
+    uint32_t _first;
+
+    std::shared_ptr<Page> _page;
+    std::shared_ptr<ContainerFormatter> _formatter;
+};
+
+VariableTree::VariableTree(QueryEngine& queries)
+: _queries(queries)
+{}
+
+void VariableTree::Draw(SBDebugger& debugger) {
+    using namespace ImGui;
+
+    auto generation = _queries.Generation(debugger);
+
+    if (std::exchange(_generation, generation) != generation || !_formatter) {
+        Invalidate(_root);
+
+        _formatter = std::make_shared<ContainerFormatter>();
+    }
+
+    // Also learns the number of variables
+    Fetch(debugger, _root, 0);
+
+    if (_root.numChildren == 0) {
+        TextDisabled(_root.pages[0]->isReady ? "No variables" : "Loading...");
+        return;
+    }
+
+    CountRows(_root);
+
+    auto flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+
+    if (!BeginTable("Variables", 3, flags)) {
+        return;
+    }
+
+    TableSetupScrollFreeze(0, 1);
+    TableSetupColumn("Name");
+    TableSetupColumn("Value");
+    TableSetupColumn("Type");
+    TableHeadersRow();
+
+    // Applied after the rows are drawn, so they don't shift around while drawing
+    struct Toggle {
+        Node* parent;
+        uint32_t index;
+
+        std::string name;
+    };
+    std::vector<Toggle> toggles;
+
+    ImGuiListClipper clipper;
+    clipper.Begin(int(std::min<size_t>(_root.numRows, INT_MAX)));
+
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            auto [parent, index, depth] = Locate(_root, row, 0);
+
+            TableNextRow();
+            TableNextColumn();
+
+            PushID(parent);
+            PushID(int(index));
+
+            if (depth > 0) {
+                Indent(depth * GetStyle().IndentSpacing);
+            }
+
+            if (auto* child = Fetch(debugger, *parent, index)) {
+                auto it = parent->expanded.find(index);
+
+                bool isOpen = it != parent->expanded.end();
+
+                // Some other variable took its place
+                if (isOpen && it->second.name != child->name) {
+                    toggles.push_back(Toggle { parent, index, child->name });
+                    isOpen = false;
+                }
+                if (isOpen) {
+                    it->second.numChildren = child->info.numChildren;
+                }
+
+                ImGuiTreeNodeFlags nodeFlags = ImGuiTreeNodeFlags_NoTreePushOnOpen | ImGuiTreeNodeFlags_SpanFullWidth;
+                if (child->info.numChildren == 0) {
+                    nodeFlags |= ImGuiTreeNodeFlags_Leaf;
+                }
+
+                SetNextItemOpen(isOpen);
+                if (TreeNodeEx(child->name.c_str(), nodeFlags) != isOpen) {
+                    toggles.push_back(Toggle { parent, index, child->name });
+                }
+
+                TableNextColumn();
+                if (!child->info.isValid) {
+                    TextDisabled("%s", child->info.error.c_str());
+                } else if (child->info.summary.empty()) {
+                    TextUnformatted(child->info.value.c_str());
+                } else if (child->info.value.empty()) {
+                    TextUnformatted(child->info.summary.c_str());
+                } else {
+                    Text("%s %s", child->info.value.c_str(), child->info.summary.c_str());
+                }
+
+                TableNextColumn();
+                TextUnformatted(child->info.type.c_str());
+            } else {
+                TextDisabled("...");
+            }
+
+            if (depth > 0) {
+                Unindent(depth * GetStyle().IndentSpacing);
+            }
+
+            PopID();
+            PopID();
+        }
+    }
+
+    EndTable();
+
+    for (auto& toggle : toggles) {
+        auto& expanded = toggle.parent->expanded;
+
+        if (expanded.erase(toggle.index)) {
+            continue;
+        }
+
+        auto& node = expanded[toggle.index];
+
+        node.name = std::move(toggle.name);
+        node.indexPath = toggle.parent->indexPath;
+        node.indexPath.push_back(toggle.index);
+    }
+}
+
+size_t VariableTree::CountRows(Node& node) {
+    node.numRows = node.numChildren;
+
+    for (auto& [index, child] : node.expanded) {
+        if (index >= node.numChildren) {
+            break;
+        }
+        node.numRows += CountRows(child);
+    }
+
+    return node.numRows;
+}
+
+VariableTree::Row VariableTree::Locate(Node& node, size_t row, int depth) {
+    size_t consumed = 0;
+
+    // First child not accounted for yet
+    uint32_t next = 0;
+
+    for (auto& [index, child] : node.expanded) {
+        if (index >= node.numChildren) {
+            break;
+        }
+
+        // Collapsed siblings before the expanded child, then the child itself
+        size_t siblings = index - next + 1;
+
+        if (row < consumed + siblings) {
+            return Row { &node, uint32_t(next + row - consumed), depth };
+        }
+        consumed += siblings;
+
+        if (row < consumed + child.numRows) {
+            return Locate(child, row - consumed, depth + 1);
+        }
+        consumed += child.numRows;
+
+        next = index + 1;
+    }
+
+    return Row { &node, uint32_t(next + row - consumed), depth };
+}
+
+void VariableTree::Invalidate(Node& node) {
+    node.pages.clear();
+
+    for (auto& [_, child] : node.expanded) {
+        Invalidate(child);
+    }
+}
+
+const VariableTree::Child* VariableTree::Fetch(SBDebugger& debugger, Node& parent, uint32_t index) {
+    auto first = index / kPageSize * kPageSize;
+    auto& page = parent.pages[first];
+
+    if (!page || page->isCancelled.load(std::memory_order_acquire)) {
+        page = std::make_shared<Page>();
+
+        _queries.Submit(debugger, std::make_shared<PageTask>(parent.indexPath, first, page, _formatter), kAppOwner);
+    }
+
+    if (!page->isReady.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+
+    parent.numChildren = page->numChildren;
+
+    if (index - first >= page->children.size()) {
+        return nullptr;
+    }
+    return &page->children[index - first];
+}
+
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "lldb-imgui/Values.h"
+
+#include "ContainerFormatter.h"
+#include "QueryEngine.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Tree of the variables in the selected frame of a debugger. Only the visible rows are fetched, in
+/// pages of children, so expanding a container costs the same regardless of its size.
+///
+/// Expanded nodes stay expanded across stops, as long as the child at their index keeps its name.
+class VariableTree {
+public:
+    static constexpr uint32_t kPageSize = 64;
+
+    explicit VariableTree(QueryEngine& queries);
+
+    void Draw(SBDebugger& debugger);
+
+private:
+    using Child = ContainerFormatter::Element;
+
+    struct Page {
+        std::atomic<bool> isReady = false;
+        std::atomic<bool> isCancelled = false;
+
+        uint32_t numChildren = 0;
+        std::vector<Child> children;
+    };
+
+    struct Node {
+        std::string name;
+
+        // Child indices leading to this node, starting at a variable of the frame
+        std::vector<uint32_t> indexPath;
+
+        uint32_t numChildren = 0;
+
+        // Rows below this node, updated once per frame
+        size_t numRows = 0;
+
+        std::map<uint32_t, Node> expanded;
+        std::unordered_map<uint32_t, std::shared_ptr<Page>> pages;
+    };
+
+    class PageTask;
+
+    struct Row {
+        Node* parent;
+        uint32_t index;
+        int depth;
+    };
+
+    static size_t CountRows(Node& node);
+    static Row Locate(Node& node, size_t row, int depth);
+
+    static void Invalidate(Node& node);
+
+    /// Null while the page holding the child is being fetched
+    const Child* Fetch(SBDebugger& debugger, Node& parent, uint32_t index);
+
+    QueryEngine& _queries;
+
+    uint64_t _generation = 0;
+
+    // Only valid for a single generation
+    std::shared_ptr<ContainerFormatter> _formatter;
+
+    // Children of the root are the frame's variables
+    Node _root;
+};
+
+}
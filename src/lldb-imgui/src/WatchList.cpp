@@ -0,0 +1,576 @@
+#include "WatchList.h"
+
+#include "lldb-imgui/Query.h"
+#include "Trace.h"
+#include "ValueCache.h"
+
+#include "lldb/API/LLDB.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cfloat>
+#include <chrono>
+#include <functional>
+#include <span>
+
+namespace lldb::imgui {
+
+/// Ranges closer than this are read at once
+static constexpr uint64_t kMaxGap = 256;
+
+/// Watches reading more memory than this are cheaper to evaluate again
+static constexpr uint64_t kMaxDependencySize = 1024 * 1024;
+
+/// Memory of many small ranges, read with as few reads as possible
+class WatchList::MemorySnapshot {
+public:
+    MemorySnapshot(SBProcess& process, std::vector<Range> ranges) {
+        std::ranges::sort(ranges, {}, &Range::address);
+
+        for (size_t begin = 0; begin < ranges.size(); ) {
+            auto address = ranges[begin].address;
+            auto end = address + ranges[begin].size;
+
+            size_t next = begin + 1;
+
+            while (next < ranges.size() && ranges[next].address <= end + kMaxGap) {
+                end = std::max(end, ranges[next].address + ranges[next].size);
+                next++;
+            }
+
+            Block block {
+                .address = address,
+                .bytes = std::vector<uint8_t>(end - address),
+            };
+
+            // Reads stop at the first unreadable byte, which leaves the rest of the block missing
+            SBError error;
+            block.bytes.resize(process.ReadMemory(address, block.bytes.data(), block.bytes.size(), error));
+
+            _blocks.push_back(std::move(block));
+            begin = next;
+        }
+    }
+
+    /// Empty unless the whole range was read
+    std::span<const uint8_t> Get(const Range& range) const {
+        auto block = std::ranges::upper_bound(_blocks, range.address, {}, &Block::address);
+        if (block == _blocks.begin()) {
+            return {};
+        }
+        block--;
+
+        auto offset = range.address - block->address;
+
+        if (offset > block->bytes.size() || range.size > block->bytes.size() - offset) {
+            return {};
+        }
+        return std::span(block->bytes).subspan(offset, range.size);
+    }
+
+private:
+    struct Block {
+        uint64_t address;
+        std::vector<uint8_t> bytes;
+    };
+
+    // Ordered by address
+    std::vector<Block> _blocks;
+};
+
+static void Combine(size_t& hash, size_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+}
+
+static size_t HashBytes(std::span<const uint8_t> bytes) {
+    size_t hash = bytes.size();
+    Combine(hash, std::hash<std::string_view>()({ reinterpret_cast<const char*>(bytes.data()), bytes.size() }));
+
+    return hash;
+}
+
+static size_t HashFrame(SBFrame& frame) {
+    size_t hash = 0;
+
+    auto* function = frame.GetFunctionName();
+
+    Combine(hash, frame.GetThread().GetThreadID());
+    Combine(hash, frame.GetCFA());
+    Combine(hash, std::hash<std::string_view>()(function ? function : ""));
+
+    return hash;
+}
+
+namespace {
+
+struct Token {
+    enum Kind {
+        Identifier,
+        Literal,
+        Punctuator,
+    };
+
+    Kind kind;
+    std::string_view text;
+
+    bool Is(std::string_view other) const {
+        return kind == Punctuator && text == other;
+    }
+};
+
+}
+
+static std::vector<Token> Tokenize(std::string_view text) {
+    std::vector<Token> tokens;
+
+    auto isIdentifier = [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    };
+
+    size_t i = 0;
+
+    while (i < text.size()) {
+        char c = text[i];
+
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            i++;
+            continue;
+        }
+
+        auto start = i;
+
+        if (std::isdigit(static_cast<unsigned char>(c))) {
+            while (i < text.size() && (isIdentifier(text[i]) || text[i] == '.' || text[i] == '\'')) {
+                i++;
+            }
+            tokens.push_back(Token { Token::Literal, text.substr(start, i - start) });
+        } else if (isIdentifier(c)) {
+            // Qualified names are looked up as a whole
+            while (i < text.size()) {
+                if (isIdentifier(text[i])) {
+                    i++;
+                } else if (text.substr(i, 2) == "::" && i + 2 < text.size() && isIdentifier(text[i + 2])) {
+                    i += 2;
+                } else {
+                    break;
+                }
+            }
+            tokens.push_back(Token { Token::Identifier, text.substr(start, i - start) });
+        } else if (c == '"' || c == '\'') {
+            for (i++; i < text.size() && text[i] != c; i++) {
+                if (text[i] == '\\') {
+                    i++;
+                }
+            }
+            i = std::min(i + 1, text.size());
+
+            tokens.push_back(Token { Token::Literal, text.substr(start, i - start) });
+        } else {
+            static constexpr std::string_view kPunctuators[] = {
+                "->", "::", "<<", ">>", "++", "--", "&&", "||",
+                "==", "!=", "<=", ">=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=",
+            };
+
+            auto pair = text.substr(i, 2);
+            bool isPair = std::ranges::find(kPunctuators, pair) != std::end(kPunctuators);
+
+            i += isPair ? 2 : 1;
+            tokens.push_back(Token { Token::Punctuator, text.substr(start, i - start) });
+        }
+    }
+
+    return tokens;
+}
+
+/// Whether evaluating `token` changes the state of the process
+static bool IsSideEffect(const Token& token) {
+    if (token.kind != Token::Punctuator) {
+        return false;
+    }
+    if (token.text == "=" || token.text == "++" || token.text == "--") {
+        return true;
+    }
+
+    // Compound assignments
+    return token.text.size() == 2 && token.text[1] == '='
+        && token.text != "==" && token.text != "!=" && token.text != "<=" && token.text != ">=";
+}
+
+/// Whether the `*` at `index` dereferences, as opposed to multiplying
+static bool IsDereference(std::span<const Token> tokens, size_t index) {
+    if (index == 0) {
+        return true;
+    }
+
+    const auto& before = tokens[index - 1];
+    return before.kind == Token::Punctuator && !before.Is("]");
+}
+
+/// Finds the variables an expression reads by walking the variable paths in it, like `*a->b[2].c`.
+/// Each step along a path is a read of memory the expression depends on.
+///
+/// Reads through anything else, like `p[i]->next`, are only covered by the storage of the result,
+/// which is enough for a single one of them.
+WatchList::Dependencies WatchList::Collect(SBFrame& frame, std::string_view expression, SBValue& result) {
+    Dependencies dependencies {
+        .frameHash = HashFrame(frame),
+    };
+
+    auto target = frame.GetThread().GetProcess().GetTarget();
+
+    uint64_t size = 0;
+
+    auto add = [&](SBValue value, const char* registerName) {
+        if (!value.IsValid()) {
+            return;
+        }
+
+        auto address = value.GetLoadAddress();
+        auto byteSize = value.GetByteSize();
+
+        if (address != LLDB_INVALID_ADDRESS && byteSize > 0) {
+            dependencies.ranges.push_back(Range { address, byteSize });
+            size += byteSize;
+        } else if (registerName) {
+            dependencies.registers.emplace_back(registerName);
+        }
+    };
+
+    auto tokens = Tokenize(expression);
+
+    auto is = [&](size_t i, std::string_view text) {
+        return i < tokens.size() && tokens[i].Is(text);
+    };
+    auto kind = [&](size_t i) {
+        return i < tokens.size() ? tokens[i].kind : Token::Punctuator;
+    };
+
+    // Tokens of the paths which were walked
+    std::vector<bool> isWalked(tokens.size());
+
+    for (size_t i = 0; i < tokens.size(); i++) {
+        const auto& token = tokens[i];
+
+        if (IsSideEffect(token)) {
+            dependencies.isVolatile = true;
+            break;
+        }
+
+        // Members are walked along with the variable they belong to
+        if (token.kind != Token::Identifier || (i > 0 && (tokens[i - 1].Is(".") || tokens[i - 1].Is("->")))) {
+            continue;
+        }
+
+        size_t next = i + 1;
+        std::vector<std::string> steps;
+
+        while (true) {
+            if ((is(next, ".") || is(next, "->")) && kind(next + 1) == Token::Identifier) {
+                steps.push_back(std::string(tokens[next].text) + std::string(tokens[next + 1].text));
+                next += 2;
+            } else if (is(next, "[") && kind(next + 1) == Token::Literal && is(next + 2, "]")) {
+                steps.push_back("[" + std::string(tokens[next + 1].text) + "]");
+                next += 3;
+            } else {
+                break;
+            }
+        }
+
+        if (is(next, "(")) {
+            static constexpr std::string_view kOperators[] = { "sizeof", "alignof", "decltype" };
+
+            // Function and method calls
+            if (!steps.empty() || std::ranges::find(kOperators, token.text) == std::end(kOperators)) {
+                dependencies.isVolatile = true;
+                break;
+            }
+            continue;
+        }
+
+        static constexpr std::string_view kKeywords[] = {
+            "true", "false", "nullptr", "const", "volatile", "signed", "unsigned",
+            "struct", "class", "enum", "static_cast", "reinterpret_cast", "const_cast",
+        };
+
+        if (std::ranges::find(kKeywords, token.text) != std::end(kKeywords)) {
+            continue;
+        }
+
+        std::string name(token.text);
+
+        // Locals, arguments, and the members of `this` named without it
+        auto value = frame.GetValueForVariablePath(name.c_str());
+        if (!value.IsValid()) {
+            value = target.FindFirstGlobalVariable(name.c_str());
+        }
+
+        // Types read nothing. Anything else, like a static member or a register, may read what isn't
+        // known to be depended on.
+        if (!value.IsValid()) {
+            if (!target.FindFirstType(name.c_str()).IsValid()) {
+                dependencies.isVolatile = true;
+                break;
+            }
+            continue;
+        }
+
+        add(value, name.c_str());
+
+        std::string path;
+
+        for (const auto& step : steps) {
+            path += step;
+            add(value.GetValueForExpressionPath(path.c_str()), nullptr);
+        }
+
+        std::fill(isWalked.begin() + i, isWalked.begin() + next, true);
+
+        // Stars in front of the path dereference all of it, unless it is indexed further
+        if (!is(next, "[")) {
+            auto last = path.empty() ? value : value.GetValueForExpressionPath(path.c_str());
+
+            for (auto j = i; j > 0 && tokens[j - 1].Is("*") && IsDereference(tokens, j - 1); j--) {
+                last = last.Dereference();
+                add(last, nullptr);
+
+                isWalked[j - 1] = true;
+            }
+        }
+    }
+
+    size_t numUnwalkedReads = 0;
+
+    for (size_t i = 0; i < tokens.size(); i++) {
+        if (isWalked[i]) {
+            continue;
+        }
+        if (tokens[i].Is("->") || tokens[i].Is("[") || (tokens[i].Is("*") && IsDereference(tokens, i))) {
+            numUnwalkedReads++;
+        }
+    }
+
+    // The result itself, which covers the last read through something other than a path
+    add(result, nullptr);
+
+    if (numUnwalkedReads > 1 || size > kMaxDependencySize) {
+        dependencies.isVolatile = true;
+    }
+
+    return dependencies;
+}
+
+size_t WatchList::Hash(SBFrame& frame, const MemorySnapshot& memory, const Dependencies& dependencies) {
+    size_t hash = dependencies.frameHash;
+
+    for (const auto& range : dependencies.ranges) {
+        Combine(hash, HashBytes(memory.Get(range)));
+    }
+
+    for (const auto& name : dependencies.registers) {
+        auto data = frame.GetValueForVariablePath(name.c_str()).GetData();
+
+        std::vector<uint8_t> bytes(data.GetByteSize());
+
+        SBError error;
+        bytes.resize(data.ReadRawData(error, 0, bytes.data(), bytes.size()));
+
+        Combine(hash, HashBytes(bytes));
+    }
+
+    return hash;
+}
+
+WatchList::Update WatchList::Run(SBDebugger& debugger, std::vector<Watch> watches) {
+    TRACE_ZONE("Watches");
+
+    auto start = std::chrono::steady_clock::now();
+
+    Update update {
+        .watches = std::move(watches),
+    };
+
+    auto process = debugger.GetSelectedTarget().GetProcess();
+    auto frame = process.GetSelectedThread().GetSelectedFrame();
+
+    for (auto& watch : update.watches) {
+        watch.isEvaluated = false;
+    }
+
+    // Memory of running processes can't be read, keep showing the results of the last stop
+    if (!SBDebugger::StateIsStoppedState(process.GetState()) || !frame.IsValid()) {
+        return update;
+    }
+
+    auto frameHash = HashFrame(frame);
+
+    auto isCandidate = [&](const Watch& watch) {
+        return watch.info && !watch.dependencies.isVolatile && watch.dependencies.frameHash == frameHash;
+    };
+
+    // The memory of all watches which may not have changed, in one go
+    std::vector<Range> ranges;
+
+    for (const auto& watch : update.watches) {
+        if (isCandidate(watch)) {
+            ranges.insert(ranges.end(), watch.dependencies.ranges.begin(), watch.dependencies.ranges.end());
+        }
+    }
+
+    MemorySnapshot memory(process, std::move(ranges));
+
+    for (auto& watch : update.watches) {
+        if (isCandidate(watch) && Hash(frame, memory, watch.dependencies) == watch.dependencies.hash) {
+            continue;
+        }
+
+        TRACE_ZONE("Evaluate watch");
+
+        auto value = frame.EvaluateExpression(watch.expression.c_str());
+
+        watch.info = SnapshotValue(value);
+        watch.dependencies = Collect(frame, watch.expression, value);
+
+        if (!watch.dependencies.isVolatile) {
+            MemorySnapshot read(process, watch.dependencies.ranges);
+            watch.dependencies.hash = Hash(frame, read, watch.dependencies);
+        }
+
+        watch.isEvaluated = true;
+        update.numEvaluated++;
+    }
+
+    update.durationMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    return update;
+}
+
+void WatchList::Apply(Update update) {
+    for (auto& result : update.watches) {
+        auto it = std::ranges::find(_watches, result.id, &Watch::id);
+
+        // Edited while being evaluated, the next update picks up the new expression
+        if (it == _watches.end() || it->expression != result.expression) {
+            continue;
+        }
+
+        *it = std::move(result);
+    }
+
+    _numEvaluated = update.numEvaluated;
+    _updateMs = update.durationMs;
+}
+
+void WatchList::Draw(SBDebugger& debugger) {
+    using namespace ImGui;
+
+    auto generation = GetDebuggerGeneration(debugger);
+
+    if (_updateQuery && _updateQuery->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        try {
+            Apply(_updateQuery->get());
+        } catch (const QueryCancelled&) {
+            // Try again next frame
+            _generation = 0;
+        }
+        _updateQuery.reset();
+    }
+
+    bool isOutdated = std::exchange(_generation, generation) != generation || _isEdited;
+
+    if (isOutdated && !_updateQuery && !_watches.empty()) {
+        _updateQuery = Submit(debugger, [watches = _watches](SBDebugger& debugger) mutable {
+            return Run(debugger, std::move(watches));
+        });
+        _isEdited = false;
+    } else if (isOutdated && _updateQuery) {
+        // Picked up once the update in flight finishes
+        _generation = 0;
+    }
+
+    SetNextItemWidth(-FLT_MIN);
+    if (InputTextWithHint("##Expression", "Add watch", _expression.data(), _expression.size(), ImGuiInputTextFlags_EnterReturnsTrue)) {
+        if (_expression[0] != '\0') {
+            _watches.push_back(Watch {
+                .id = _nextID++,
+                .expression = _expression.data(),
+            });
+            _isEdited = true;
+        }
+
+        _expression[0] = '\0';
+        SetKeyboardFocusHere(-1);
+    }
+
+    if (!_watches.empty()) {
+        TextDisabled("Evaluated %zu of %zu watches at the last stop, in %.1f ms", _numEvaluated, _watches.size(), _updateMs);
+    }
+
+    auto flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable | ImGuiTableFlags_ScrollY;
+
+    if (!BeginTable("Watches", 3, flags)) {
+        return;
+    }
+
+    TableSetupScrollFreeze(0, 1);
+    TableSetupColumn("Expression");
+    TableSetupColumn("Value");
+    TableSetupColumn("Type");
+    TableHeadersRow();
+
+    std::optional<uint64_t> removed;
+
+    for (const auto& watch : _watches) {
+        PushID(int(watch.id));
+
+        TableNextRow();
+        TableNextColumn();
+
+        if (SmallButton("x")) {
+            removed = watch.id;
+        }
+        SameLine();
+        TextUnformatted(watch.expression.c_str());
+
+        TableNextColumn();
+        if (!watch.info) {
+            TextDisabled("...");
+        } else if (!watch.info->isValid) {
+            TextDisabled("%s", watch.info->error.c_str());
+        } else if (watch.info->summary.empty()) {
+            TextUnformatted(watch.info->value.c_str());
+        } else if (watch.info->value.empty()) {
+            TextUnformatted(watch.info->summary.c_str());
+        } else {
+            Text("%s %s", watch.info->value.c_str(), watch.info->summary.c_str());
+        }
+
+        if (watch.info && BeginItemTooltip()) {
+            if (watch.dependencies.isVolatile) {
+                TextUnformatted("Evaluated at every stop, as it calls functions or has side effects");
+            } else {
+                Text("Depends on %zu memory ranges and %zu registers", watch.dependencies.ranges.size(), watch.dependencies.registers.size());
+                TextUnformatted(watch.isEvaluated ? "Evaluated at the last stop" : "Unchanged at the last stop");
+            }
+            EndTooltip();
+        }
+
+        TableNextColumn();
+        if (watch.info) {
+            TextUnformatted(watch.info->type.c_str());
+        }
+
+        PopID();
+    }
+
+    EndTable();
+
+    if (removed) {
+        std::erase_if(_watches, [&](const Watch& watch) {
+            return watch.id == *removed;
+        });
+    }
+}
+
+}
@@ -0,0 +1,91 @@
+#pragma once
+
+#include "lldb-imgui/Values.h"
+
+#include "lldb/API/SBDebugger.h"
+
+#include <array>
+#include <future>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace lldb::imgui {
+
+/// Expressions evaluated in the selected frame of a debugger each time it stops.
+///
+/// Evaluating an expression can take seconds, so each watch remembers the variables and memory its
+/// last evaluation read. At the next stop the memory of all watches is read in one batch, and only
+/// the watches whose memory hashes differently are evaluated again.
+class WatchList {
+public:
+    void Draw(SBDebugger& debugger);
+
+private:
+    /// Memory an evaluation depends on
+    struct Range {
+        uint64_t address;
+        uint64_t size;
+    };
+
+    struct Dependencies {
+        // Calls and side effects may depend on anything, these are evaluated at every stop
+        bool isVolatile = false;
+
+        // Locals resolve to different storage in other frames
+        size_t frameHash = 0;
+
+        std::vector<Range> ranges;
+
+        // Variables kept in registers, which have no memory to read
+        std::vector<std::string> registers;
+
+        size_t hash = 0;
+    };
+
+    struct Watch {
+        uint64_t id;
+        std::string expression;
+
+        // Null until first evaluated
+        std::optional<ValueInfo> info;
+        Dependencies dependencies;
+
+        // Whether the last update had to evaluate it
+        bool isEvaluated = false;
+    };
+
+    struct Update {
+        std::vector<Watch> watches;
+
+        size_t numEvaluated = 0;
+        double durationMs = 0;
+    };
+
+    class MemorySnapshot;
+
+    /// Runs on the query thread
+    static Update Run(SBDebugger& debugger, std::vector<Watch> watches);
+
+    static Dependencies Collect(SBFrame& frame, std::string_view expression, SBValue& result);
+    static size_t Hash(SBFrame& frame, const MemorySnapshot& memory, const Dependencies& dependencies);
+
+    void Apply(Update update);
+
+    std::vector<Watch> _watches;
+    uint64_t _nextID = 1;
+
+    uint64_t _generation = 0;
+    bool _isEdited = false;
+
+    std::optional<std::shared_future<Update>> _updateQuery;
+
+    // Statistics of the last update
+    size_t _numEvaluated = 0;
+    double _updateMs = 0;
+
+    std::array<char, 256> _expression {};
+};
+
+}
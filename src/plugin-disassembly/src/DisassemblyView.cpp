@@ -0,0 +1,321 @@
+#include "DisassemblyView.h"
+
+#include "lldb-imgui/Query.h"
+
+#include "lldb/API/LLDB.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <format>
+#include <unordered_map>
+
+/// Bump when the layout written by `SectionCode::Save` changes
+static constexpr std::string_view kStatePrefix = "disassembly.v1/";
+
+static std::unordered_map<std::string, std::shared_ptr<SectionCode>> g_sections;
+
+// Handed over by the previous version of the plugin, sections are restored once shown again
+static lldb::imgui::PluginState* g_restoredState = nullptr;
+
+/// Code of `location`'s section, shared by every view showing it
+static std::shared_ptr<SectionCode> GetSectionCode(const lldb::SBSection& section, const std::string& key, uint64_t begin, uint64_t end) {
+    auto& code = g_sections[key];
+    if (!code) {
+        code = std::make_shared<SectionCode>(section, begin, end);
+
+        if (auto bytes = g_restoredState ? g_restoredState->Find(std::format("{}{}", kStatePrefix, key)) : std::span<const std::byte>(); !bytes.empty()) {
+            // Left as is if the section changed since
+            lldb::imgui::StateReader reader(bytes);
+            code->Restore(reader);
+        }
+    }
+    return code;
+}
+
+void SaveSectionCode(lldb::imgui::PluginState& state) {
+    for (const auto& [key, code] : g_sections) {
+        lldb::imgui::StateWriter writer;
+        code->Save(writer);
+
+        state.Store(std::format("{}{}", kStatePrefix, key), writer.Bytes());
+    }
+}
+
+void RestoreSectionCode(lldb::imgui::PluginState& state) {
+    g_restoredState = &state;
+}
+
+void DisassemblyView::Draw(lldb::SBDebugger& debugger) {
+    using namespace ImGui;
+
+    UpdateLocation(debugger);
+
+    if (!_pc) {
+        TextDisabled("No frame selected");
+        return;
+    }
+
+    _code->BeginFrame();
+
+    if (_window.empty()) {
+        if (auto* piece = _code->Get(_pc->address)) {
+            _window.push_back(piece);
+            RebuildRows();
+        }
+    }
+
+    if (_window.empty()) {
+        TextDisabled("Disassembling...");
+    } else {
+        DrawRows();
+    }
+
+    _code->EndFrame(debugger);
+}
+
+void DisassemblyView::UpdateLocation(lldb::SBDebugger& debugger) {
+    auto generation = lldb::imgui::GetDebuggerGeneration(debugger);
+
+    if (std::exchange(_generation, generation) != generation) {
+        _locationQuery = lldb::imgui::Submit(debugger, [](lldb::SBDebugger& debugger) -> std::optional<Location> {
+            auto target = debugger.GetSelectedTarget();
+            auto frame = target.GetProcess().GetSelectedThread().GetSelectedFrame();
+
+            auto pc = frame.GetPCAddress();
+            auto section = pc.GetSection();
+
+            if (!frame.IsValid() || !section.IsValid()) {
+                return std::nullopt;
+            }
+
+            auto module = pc.GetModule();
+
+            std::string moduleKey;
+
+            if (auto* uuid = module.GetUUIDString()) {
+                moduleKey = uuid;
+            } else {
+                char path[PATH_MAX];
+                module.GetFileSpec().GetPath(path, sizeof(path));
+
+                moduleKey = path;
+            }
+
+            auto begin = section.GetFileAddress();
+            auto loadAddress = section.GetLoadAddress(target);
+
+            return Location {
+                .section = section,
+                .sectionKey = std::format("{}/{:x}", moduleKey, begin),
+                .sectionBegin = begin,
+                .sectionEnd = begin + section.GetByteSize(),
+                .address = pc.GetFileAddress(),
+                .loadBias = loadAddress != LLDB_INVALID_ADDRESS ? loadAddress - begin : 0,
+            };
+        });
+    }
+
+    if (!_locationQuery || _locationQuery->wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return;
+    }
+
+    try {
+        auto location = _locationQuery->get();
+
+        if (!location) {
+            _code.reset();
+            _window.clear();
+        } else if (!_pc || _pc->sectionKey != location->sectionKey) {
+            _code = GetSectionCode(location->section, location->sectionKey, location->sectionBegin, location->sectionEnd);
+            _window.clear();
+        } else if (!FindRow(location->address)) {
+            // Stepping within the window scrolls, anything else starts over around the new address
+            _window.clear();
+        }
+
+        RebuildRows();
+
+        _pc = std::move(location);
+        _isScrollToPC = true;
+    } catch (const lldb::imgui::QueryCancelled&) {
+        // Try again next frame
+        _generation = 0;
+    }
+    _locationQuery.reset();
+}
+
+void DisassemblyView::RebuildRows() {
+    _rowOffsets.clear();
+
+    size_t offset = 0;
+
+    for (auto* piece : _window) {
+        _rowOffsets.push_back(offset);
+        offset += piece->rows.size();
+    }
+    _rowOffsets.push_back(offset);
+}
+
+std::optional<size_t> DisassemblyView::FindRow(uint64_t address) const {
+    for (size_t i = 0; i < _window.size(); i++) {
+        const auto& piece = *_window[i];
+
+        if (address < piece.begin || address >= piece.end) {
+            continue;
+        }
+
+        for (size_t row = 0; row < piece.rows.size(); row++) {
+            const auto& pieceRow = piece.rows[row];
+
+            if (pieceRow.kind == SectionCode::Row::Kind::Instruction && piece.instructions[pieceRow.instruction].address == address) {
+                return _rowOffsets[i] + row;
+            }
+        }
+    }
+    return std::nullopt;
+}
+
+void DisassemblyView::DrawRows() {
+    using namespace ImGui;
+
+    auto rowHeight = GetTextLineHeightWithSpacing();
+
+    if (_isScrollToPC) {
+        if (auto row = FindRow(_pc->address)) {
+            // Keep still while stepping through what is on screen already
+            if (*row < _firstVisible || *row + 1 >= _lastVisible) {
+                _scrollY = std::max(0.0f, *row * rowHeight - GetContentRegionAvail().y / 2);
+            }
+            _isScrollToPC = false;
+        }
+    }
+    if (_scrollY) {
+        SetNextWindowScroll(ImVec2(-1, *std::exchange(_scrollY, std::nullopt)));
+    }
+
+    if (!BeginChild("Rows")) {
+        EndChild();
+        return;
+    }
+
+    auto* drawList = GetWindowDrawList();
+    auto textHeight = GetTextLineHeight();
+
+    size_t firstVisible = SIZE_MAX;
+    size_t lastVisible = 0;
+
+    ImGuiListClipper clipper;
+    clipper.Begin(int(_rowOffsets.back()), rowHeight);
+
+    while (clipper.Step()) {
+        firstVisible = std::min<size_t>(firstVisible, clipper.DisplayStart);
+        lastVisible = std::max<size_t>(lastVisible, clipper.DisplayEnd);
+
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            auto index = size_t(std::ranges::upper_bound(_rowOffsets, size_t(row)) - _rowOffsets.begin()) - 1;
+
+            const auto& piece = *_window[index];
+            const auto& pieceRow = piece.rows[row - _rowOffsets[index]];
+            const auto& instruction = piece.instructions[pieceRow.instruction];
+
+            switch (pieceRow.kind) {
+                case SectionCode::Row::Kind::Symbol:
+                    Text("%s:", piece.symbols.at(pieceRow.instruction).c_str());
+                    break;
+
+                case SectionCode::Row::Kind::Line:
+                    TextDisabled("  %s", piece.lines.at(pieceRow.instruction).c_str());
+                    break;
+
+                case SectionCode::Row::Kind::Instruction: {
+                    bool isPC = instruction.address == _pc->address;
+
+                    if (isPC) {
+                        auto min = GetCursorScreenPos();
+                        auto max = ImVec2(min.x + GetContentRegionAvail().x, min.y + textHeight);
+
+                        drawList->AddRectFilled(min, max, GetColorU32(ImGuiCol_TextSelectedBg));
+                    }
+
+                    auto line = std::format("{} {:016x}  {:<8} {}", isPC ? "->" : "  ", instruction.address + _pc->loadBias, instruction.mnemonic, instruction.operands);
+                    TextUnformatted(line.data(), line.data() + line.size());
+
+                    if (!instruction.comment.empty()) {
+                        SameLine();
+                        TextDisabled("; %s", instruction.comment.c_str());
+                    }
+                    break;
+                }
+            }
+        }
+    }
+
+    if (firstVisible <= lastVisible) {
+        _firstVisible = firstVisible;
+        _lastVisible = lastVisible;
+
+        UpdateWindow();
+    }
+
+    EndChild();
+}
+
+void DisassemblyView::UpdateWindow() {
+    using namespace ImGui;
+
+    // Rows added, or removed above what is on screen
+    ptrdiff_t shift = 0;
+
+    // Grow towards the ends coming into view, as far as decoded code allows
+    while (_lastVisible + kWindowMargin > _rowOffsets.back()) {
+        auto* next = _code->Next(*_window.back());
+        if (!next) {
+            break;
+        }
+
+        _window.push_back(next);
+        RebuildRows();
+    }
+
+    while (_firstVisible + shift < kWindowMargin) {
+        auto* previous = _code->Previous(*_window.front());
+        if (!previous) {
+            break;
+        }
+
+        _window.push_front(previous);
+        RebuildRows();
+
+        shift += previous->rows.size();
+    }
+
+    // Drop pieces far off screen, from whichever end has more of them
+    while (_window.size() > 1 && _rowOffsets.back() > kMaxWindowRows) {
+        auto above = _firstVisible + shift;
+        auto below = _rowOffsets.back() - (_lastVisible + shift);
+
+        auto frontRows = _window.front()->rows.size();
+        auto backRows = _window.back()->rows.size();
+
+        if (above >= below && frontRows + kWindowMargin <= above) {
+            _window.pop_front();
+            shift -= frontRows;
+        } else if (below > above && backRows + kWindowMargin <= below) {
+            _window.pop_back();
+        } else {
+            break;
+        }
+
+        RebuildRows();
+    }
+
+    if (shift != 0) {
+        _scrollY = GetScrollY() + shift * GetTextLineHeightWithSpacing();
+
+        _firstVisible += shift;
+        _lastVisible += shift;
+    }
+}
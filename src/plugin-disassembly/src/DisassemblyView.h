@@ -0,0 +1,76 @@
+#pragma once
+
+#include "SectionCode.h"
+
+#include "lldb/API/SBDebugger.h"
+#include "lldb/API/SBSection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/// Disassembly around the program counter of the selected frame. Rows are laid out from a window of
+/// adjacent pieces of decoded code, which grows towards whichever end is scrolled to, and drops
+/// pieces far off screen, so scrolling only ever decodes the code coming into view.
+class DisassemblyView {
+public:
+    /// Pieces are dropped from the far end of the window beyond this many rows
+    static constexpr size_t kMaxWindowRows = 4096;
+
+    /// Pieces are added to the window once it has fewer rows than this past what's on screen
+    static constexpr size_t kWindowMargin = 64;
+
+    void Draw(lldb::SBDebugger& debugger);
+
+private:
+    struct Location {
+        lldb::SBSection section;
+
+        /// Shared by all debuggers which load the same module
+        std::string sectionKey;
+        uint64_t sectionBegin;
+        uint64_t sectionEnd;
+
+        uint64_t address;
+
+        /// Added to file addresses to get load addresses
+        uint64_t loadBias;
+    };
+
+    void UpdateLocation(lldb::SBDebugger& debugger);
+    void UpdateWindow();
+
+    void DrawRows();
+
+    void RebuildRows();
+    std::optional<size_t> FindRow(uint64_t address) const;
+
+    uint64_t _generation = 0;
+    std::optional<std::shared_future<std::optional<Location>>> _locationQuery;
+
+    std::optional<Location> _pc;
+    std::shared_ptr<SectionCode> _code;
+
+    std::deque<const SectionCode::Piece*> _window;
+
+    // First row of each piece of the window, and the number of rows past the end
+    std::vector<size_t> _rowOffsets;
+
+    // Rows drawn last frame
+    size_t _firstVisible = 0;
+    size_t _lastVisible = 0;
+
+    bool _isScrollToPC = false;
+    std::optional<float> _scrollY;
+};
+
+/// Decoded code of all sections shown so far, for the next version of the plugin
+void SaveSectionCode(lldb::imgui::PluginState& state);
+
+/// Sections are restored from `state` once they are shown again, it stays valid until the next reload
+void RestoreSectionCode(lldb::imgui::PluginState& state);
@@ -0,0 +1,38 @@
+#include "DisassemblyView.h"
+
+#include "lldb/API/LLDB.h"
+#include "lldb-imgui/Plugin.h"
+
+#include "imgui.h"
+
+#include <format>
+#include <unordered_map>
+
+// Decoding a big section takes a while, which is not worth repeating for every rebuild
+static void SaveState(lldb::imgui::PluginState& state) {
+    SaveSectionCode(state);
+}
+
+static void RestoreState(lldb::imgui::PluginState& state) {
+    RestoreSectionCode(state);
+}
+
+static void DrawDebugger(lldb::SBDebugger& debugger) {
+    static std::unordered_map<lldb::user_id_t, DisassemblyView> views;
+
+    auto title = std::format("Disassembly ({})", debugger.GetID());
+
+    if (ImGui::Begin(title.c_str())) {
+        views[debugger.GetID()].Draw(debugger);
+    }
+    ImGui::End();
+}
+
+// Only changes with the debugger's state, the code it has loaded, the selected frame, or query results
+LLDB_IMGUI_PLUGIN({
+    .flags = lldb::imgui::kPluginRetained,
+    .events = lldb::imgui::kEventStateChanges | lldb::imgui::kEventModules | lldb::imgui::kEventSymbols | lldb::imgui::kEventSelection,
+    .drawDebugger = DrawDebugger,
+    .saveState = SaveState,
+    .restoreState = RestoreState,
+});
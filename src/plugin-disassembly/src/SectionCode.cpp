@@ -0,0 +1,351 @@
+#include "SectionCode.h"
+
+#include "lldb-imgui/Query.h"
+#include "lldb-imgui/Trace.h"
+
+#include "lldb/API/LLDB.h"
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+
+static std::string DescribeLine(lldb::SBLineEntry& line) {
+    auto* file = line.GetFileSpec().GetFilename();
+
+    return std::format("{}:{}", file ? file : "?", line.GetLine());
+}
+
+SectionCode::SectionCode(lldb::SBSection section, uint64_t begin, uint64_t end)
+: _begin(begin)
+, _end(end)
+, _section(std::move(section))
+{}
+
+void SectionCode::BeginFrame() {
+    if (_symbolsQuery && _symbolsQuery->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        try {
+            _symbols = _symbolsQuery->get();
+            _isLoaded = true;
+
+            _starts.insert(_begin);
+            _starts.insert(_symbols.begin(), _symbols.end());
+        } catch (const lldb::imgui::QueryCancelled&) {
+            // Loaded again on the next request
+        }
+        _symbolsQuery.reset();
+    }
+
+    std::erase_if(_decodes, [&](const auto& decode) {
+        const auto& [jobs, future] = decode;
+
+        if (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        for (const auto& job : jobs) {
+            _pending.erase(job.begin);
+        }
+
+        try {
+            for (const auto& piece : future.get()) {
+                _starts.insert(piece.end);
+                _pieces.emplace(piece.begin, piece);
+            }
+        } catch (const lldb::imgui::QueryCancelled&) {
+            // Requested again once shown
+        }
+        return true;
+    });
+}
+
+const SectionCode::Piece* SectionCode::Get(uint64_t address) {
+    if (address < _begin || address >= _end) {
+        return nullptr;
+    }
+
+    if (auto it = _pieces.upper_bound(address); it != _pieces.begin()) {
+        if (auto& piece = std::prev(it)->second; address < piece.end) {
+            return &piece;
+        }
+    }
+
+    // The closest instruction before the address is where decoding towards it continues
+    if (_isLoaded) {
+        auto start = *std::prev(_starts.upper_bound(address));
+
+        if (!_pending.contains(start)) {
+            _queued.insert(start);
+        }
+    }
+    return nullptr;
+}
+
+const SectionCode::Piece* SectionCode::Next(const Piece& piece) {
+    return Get(piece.end);
+}
+
+const SectionCode::Piece* SectionCode::Previous(const Piece& piece) {
+    return piece.begin > _begin ? Get(piece.begin - 1) : nullptr;
+}
+
+void SectionCode::EndFrame(lldb::SBDebugger& debugger) {
+    if (!_isLoaded) {
+        if (!_symbolsQuery) {
+            _symbolsQuery = lldb::imgui::Submit(debugger, [section = _section, begin = _begin, end = _end](lldb::SBDebugger&) {
+                TRACE_ZONE("Load section symbols");
+
+                auto module = lldb::SBAddress(section, 0).GetModule();
+
+                std::vector<uint64_t> symbols;
+
+                for (size_t i = 0; i < module.GetNumSymbols(); i++) {
+                    auto address = module.GetSymbolAtIndex(i).GetStartAddress().GetFileAddress();
+
+                    if (address >= begin && address < end) {
+                        symbols.push_back(address);
+                    }
+                }
+
+                std::ranges::sort(symbols);
+                symbols.erase(std::ranges::unique(symbols).begin(), symbols.end());
+                return symbols;
+            });
+        }
+        return;
+    }
+
+    if (_queued.empty()) {
+        return;
+    }
+
+    std::vector<Job> jobs;
+
+    for (auto begin : _queued) {
+        auto next = std::ranges::upper_bound(_symbols, begin);
+        auto symbolEnd = next != _symbols.end() ? *next : _end;
+
+        jobs.push_back(Job {
+            .begin = begin,
+            .limit = std::min(symbolEnd, begin + kMaxPieceSize),
+            .isCut = begin + kMaxPieceSize < symbolEnd,
+        });
+        _pending.insert(begin);
+    }
+    _queued.clear();
+
+    auto future = lldb::imgui::Submit(debugger, [section = _section, sectionBegin = _begin, jobs](lldb::SBDebugger& debugger) mutable {
+        TRACE_ZONE("Disassemble");
+
+        auto target = debugger.GetSelectedTarget();
+
+        std::vector<Piece> pieces;
+
+        for (const auto& job : jobs) {
+            auto offset = job.begin - sectionBegin;
+
+            // Sections are read from the module's file, not process memory
+            lldb::SBError error;
+            auto data = section.GetSectionData(offset, job.limit - job.begin);
+
+            std::vector<uint8_t> bytes(data.GetByteSize());
+            data.ReadRawData(error, 0, bytes.data(), bytes.size());
+
+            auto list = target.GetInstructions(lldb::SBAddress(section, offset), bytes.data(), bytes.size());
+
+            Piece piece {
+                .begin = job.begin,
+                .end = job.limit,
+            };
+
+            for (size_t i = 0; i < list.GetSize(); i++) {
+                auto instruction = list.GetInstructionAtIndex(i);
+
+                auto* mnemonic = instruction.GetMnemonic(target);
+                auto* operands = instruction.GetOperands(target);
+                auto* comment = instruction.GetComment(target);
+
+                piece.instructions.push_back(Instruction {
+                    .address = instruction.GetAddress().GetFileAddress(),
+                    .size = uint32_t(instruction.GetByteSize()),
+                    .mnemonic = mnemonic ? mnemonic : "",
+                    .operands = operands ? operands : "",
+                    .comment = comment ? comment : "",
+                });
+            }
+
+            if (job.isCut && piece.instructions.size() > 1) {
+                piece.instructions.pop_back();
+            }
+            if (!piece.instructions.empty()) {
+                auto& last = piece.instructions.back();
+
+                piece.end = std::min(job.limit, last.address + last.size);
+            }
+
+            // Annotations are resolved for the whole piece at once, rather than per row when drawn
+            std::string previousLine;
+
+            for (uint32_t i = 0; i < piece.instructions.size(); i++) {
+                auto address = lldb::SBAddress(section, piece.instructions[i].address - sectionBegin);
+                auto context = address.GetSymbolContext(lldb::eSymbolContextSymbol | lldb::eSymbolContextLineEntry);
+
+                auto symbol = context.GetSymbol();
+                auto* name = symbol.GetDisplayName();
+
+                if (name && symbol.GetStartAddress().GetFileAddress() == piece.instructions[i].address) {
+                    piece.symbols.emplace(i, name);
+                    piece.rows.push_back(Row { .kind = Row::Kind::Symbol, .instruction = i });
+                }
+
+                if (auto lineEntry = context.GetLineEntry(); lineEntry.IsValid()) {
+                    auto line = DescribeLine(lineEntry);
+
+                    if (line != previousLine) {
+                        piece.lines.emplace(i, line);
+                        piece.rows.push_back(Row { .kind = Row::Kind::Line, .instruction = i });
+                    }
+                    previousLine = std::move(line);
+                }
+
+                piece.rows.push_back(Row { .kind = Row::Kind::Instruction, .instruction = i });
+            }
+
+            pieces.push_back(std::move(piece));
+        }
+        return pieces;
+    });
+
+    _decodes.emplace_back(std::move(jobs), std::move(future));
+}
+
+void SectionCode::Save(lldb::imgui::StateWriter& writer) const {
+    writer.Write(_begin);
+    writer.Write(_end);
+
+    writer.Write(_isLoaded);
+    writer.Write<uint64_t>(_symbols.size());
+
+    for (auto symbol : _symbols) {
+        writer.Write(symbol);
+    }
+
+    writer.Write<uint64_t>(_starts.size());
+
+    for (auto start : _starts) {
+        writer.Write(start);
+    }
+
+    writer.Write<uint64_t>(_pieces.size());
+
+    for (const auto& [_, piece] : _pieces) {
+        writer.Write(piece.begin);
+        writer.Write(piece.end);
+
+        writer.Write<uint64_t>(piece.instructions.size());
+
+        for (const auto& instruction : piece.instructions) {
+            writer.Write(instruction.address);
+            writer.Write(instruction.size);
+            writer.Write(instruction.mnemonic);
+            writer.Write(instruction.operands);
+            writer.Write(instruction.comment);
+        }
+
+        writer.Write<uint64_t>(piece.rows.size());
+
+        for (const auto& row : piece.rows) {
+            writer.Write(row);
+        }
+
+        for (const auto* annotations : { &piece.symbols, &piece.lines }) {
+            writer.Write<uint64_t>(annotations->size());
+
+            for (const auto& [instruction, text] : *annotations) {
+                writer.Write(instruction);
+                writer.Write(text);
+            }
+        }
+    }
+}
+
+bool SectionCode::Restore(lldb::imgui::StateReader& reader) {
+    uint64_t begin = 0;
+    uint64_t end = 0;
+
+    if (!reader.Read(begin) || !reader.Read(end) || begin != _begin || end != _end) {
+        return false;
+    }
+
+    bool isLoaded = false;
+    std::vector<uint64_t> symbols;
+    std::set<uint64_t> starts;
+    std::map<uint64_t, Piece> pieces;
+
+    uint64_t count = 0;
+
+    reader.Read(isLoaded);
+    reader.Read(count);
+
+    for (uint64_t i = 0; i < count && reader.Read(symbols.emplace_back()); i++) {}
+
+    reader.Read(count);
+
+    for (uint64_t i = 0, start = 0; i < count && reader.Read(start); i++) {
+        starts.insert(start);
+    }
+
+    reader.Read(count);
+
+    for (uint64_t i = 0; i < count && !reader.IsFailed(); i++) {
+        Piece piece;
+
+        reader.Read(piece.begin);
+        reader.Read(piece.end);
+
+        uint64_t numInstructions = 0;
+        reader.Read(numInstructions);
+
+        for (uint64_t j = 0; j < numInstructions && !reader.IsFailed(); j++) {
+            auto& instruction = piece.instructions.emplace_back();
+
+            reader.Read(instruction.address);
+            reader.Read(instruction.size);
+            reader.Read(instruction.mnemonic);
+            reader.Read(instruction.operands);
+            reader.Read(instruction.comment);
+        }
+
+        uint64_t numRows = 0;
+        reader.Read(numRows);
+
+        for (uint64_t j = 0; j < numRows && reader.Read(piece.rows.emplace_back()); j++) {}
+
+        for (auto* annotations : { &piece.symbols, &piece.lines }) {
+            uint64_t numAnnotations = 0;
+            reader.Read(numAnnotations);
+
+            for (uint64_t j = 0; j < numAnnotations && !reader.IsFailed(); j++) {
+                uint32_t instruction = 0;
+                std::string text;
+
+                reader.Read(instruction);
+                reader.Read(text);
+
+                annotations->emplace(instruction, std::move(text));
+            }
+        }
+
+        pieces.emplace(piece.begin, std::move(piece));
+    }
+
+    if (!reader.IsDone()) {
+        return false;
+    }
+
+    _isLoaded = isLoaded;
+    _symbols = std::move(symbols);
+    _starts = std::move(starts);
+    _pieces = std::move(pieces);
+
+    return true;
+}
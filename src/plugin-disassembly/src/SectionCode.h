@@ -0,0 +1,108 @@
+#pragma once
+
+#include "lldb-imgui/State.h"
+
+#include "lldb/API/SBDebugger.h"
+#include "lldb/API/SBSection.h"
+
+#include <cstdint>
+#include <future>
+#include <map>
+#include <optional>
+#include <set>
+#include <string>
+#include <vector>
+
+/// Instructions of a single code section, decoded a piece at a time as they are shown. Code hardly
+/// ever changes while debugging, so decoded pieces are kept for as long as the section is.
+///
+/// Instructions can only be decoded starting at the address of another instruction, which on
+/// variable length instruction sets means symbols, or the end of a piece decoded before. Pieces
+/// span at most `kMaxPieceSize` bytes, and never cross symbols.
+class SectionCode {
+public:
+    static constexpr uint64_t kMaxPieceSize = 4096;
+
+    struct Instruction {
+        uint64_t address;
+        uint32_t size;
+
+        std::string mnemonic;
+        std::string operands;
+        std::string comment;
+    };
+
+    struct Row {
+        enum class Kind : uint8_t {
+            Symbol,
+            Line,
+            Instruction,
+        };
+        Kind kind;
+
+        /// Instruction the row belongs to, annotations precede their instruction
+        uint32_t instruction;
+    };
+
+    struct Piece {
+        uint64_t begin;
+        uint64_t end;
+
+        std::vector<Instruction> instructions;
+        std::vector<Row> rows;
+
+        // Annotations by instruction index
+        std::map<uint32_t, std::string> symbols;
+        std::map<uint32_t, std::string> lines;
+    };
+
+    /// File addresses the section spans
+    SectionCode(lldb::SBSection section, uint64_t begin, uint64_t end);
+
+    /// Applies finished decodes
+    void BeginFrame();
+
+    /// Decoded piece containing `address`, or null while it is being decoded
+    const Piece* Get(uint64_t address);
+
+    /// Decoded pieces adjacent to `piece`, null at the ends of the section, or while they are being decoded
+    const Piece* Next(const Piece& piece);
+    const Piece* Previous(const Piece& piece);
+
+    /// Decodes pieces requested during the frame, in a single query
+    void EndFrame(lldb::SBDebugger& debugger);
+
+    /// Symbols and decoded pieces, for the next version of the plugin
+    void Save(lldb::imgui::StateWriter& writer) const;
+
+    /// Takes what `Save` wrote, false if it doesn't make sense for this section
+    bool Restore(lldb::imgui::StateReader& reader);
+
+private:
+    struct Job {
+        uint64_t begin;
+        uint64_t limit;
+
+        // Whether the piece ends in the middle of a symbol, and its last instruction may be cut in half
+        bool isCut;
+    };
+
+    uint64_t _begin;
+    uint64_t _end;
+
+    lldb::SBSection _section;
+
+    // Start addresses of the section's symbols, loaded by the first query
+    std::optional<std::shared_future<std::vector<uint64_t>>> _symbolsQuery;
+    std::vector<uint64_t> _symbols;
+    bool _isLoaded = false;
+
+    // Addresses known to start an instruction
+    std::set<uint64_t> _starts;
+
+    std::map<uint64_t, Piece> _pieces;
+
+    std::set<uint64_t> _queued;
+    std::set<uint64_t> _pending;
+    std::vector<std::pair<std::vector<Job>, std::shared_future<std::vector<Piece>>>> _decodes;
+};
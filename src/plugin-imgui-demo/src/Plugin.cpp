@@ -1,12 +1,67 @@
-
 #include "lldb/API/LLDB.h"
+#include "lldb-imgui/API.h"
+#include "lldb-imgui/Log.h"
+#include "lldb-imgui/Plugin.h"
+#include "lldb-imgui/Query.h"
+#include "lldb-imgui/Trace.h"
 
 #include "imgui.h"
 
-void Draw() {
+#include <format>
+#include <string>
+#include <unordered_map>
+
+static lldb::imgui::Logger logger("plugin-imgui-demo");
+
+/// A `QueryCache` only holds the results of a single debugger
+struct DebuggerState {
+    lldb::imgui::QueryCache<std::string> queries;
+
+    // Last result logged
+    std::string threads;
+};
+
+static std::unordered_map<lldb::user_id_t, DebuggerState> g_debuggers;
+
+static void Draw() {
+    TRACE_ZONE("ShowDemoWindow");
     ImGui::ShowDemoWindow();
+
+    // The demo is full of animations, which only need frames while they can be seen. Beginning the
+    // window again appends to it, and tells whether it is collapsed or clipped.
+    if (ImGui::Begin("Dear ImGui Demo")) {
+        lldb::imgui::RequestRedraw();
+    }
+    ImGui::End();
 }
 
-void DrawDebugger(lldb::SBDebugger& debugger) {
+static void DrawDebugger(lldb::SBDebugger& debugger) {
+    auto& state = g_debuggers[debugger.GetID()];
+
+    // Only windows of its own are kept on screen in the frames the plugin is throttled in
+    auto title = std::format("Demo ({})", debugger.GetID());
+
+    if (!ImGui::Begin(title.c_str())) {
+        ImGui::End();
+        return;
+    }
+
     ImGui::Text("DrawDebugger");
+
+    auto* threads = state.queries.Get(debugger, "threads", [](lldb::SBDebugger& debugger) {
+        return std::format("{} threads", debugger.GetSelectedTarget().GetProcess().GetNumThreads());
+    });
+    ImGui::TextUnformatted(threads ? threads->c_str() : "...");
+
+    if (threads && *threads != state.threads) {
+        state.threads = *threads;
+
+        logger.Debug("Debugger {} has {}", debugger.GetID(), state.threads);
+    }
+    ImGui::End();
 }
+
+LLDB_IMGUI_PLUGIN({
+    .draw = Draw,
+    .drawDebugger = DrawDebugger,
+});
@@ -0,0 +1,204 @@
+#include "MemoryCache.h"
+
+#include "lldb-imgui/Memory.h"
+#include "lldb-imgui/Query.h"
+#include "lldb-imgui/Trace.h"
+
+#include "lldb/API/LLDB.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+void MemoryCache::BeginFrame(lldb::SBDebugger& debugger) {
+    _frame++;
+    _debugger = debugger;
+    _generation = lldb::imgui::GetDebuggerGeneration(debugger);
+
+    std::erase_if(_batches, [&](const Batch& batch) {
+        if (batch.future.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            return false;
+        }
+
+        try {
+            Apply(batch, batch.future.get());
+        } catch (const lldb::imgui::QueryCancelled&) {
+            // Requested again once shown
+            for (auto address : batch.addresses) {
+                if (auto it = _entries.find(address); it != _entries.end()) {
+                    it->second.requestedAt = 0;
+                }
+            }
+        }
+        return true;
+    });
+}
+
+const MemoryCache::Page* MemoryCache::Get(uint64_t address) {
+    auto& entry = Touch(address);
+
+    return entry.hasData ? &entry.page : nullptr;
+}
+
+void MemoryCache::Prefetch(uint64_t address) {
+    Touch(address);
+}
+
+MemoryCache::Entry& MemoryCache::Touch(uint64_t address) {
+    auto page = address & ~(kPageSize - 1);
+
+    auto& entry = _entries[page];
+    entry.lastUsedFrame = _frame;
+
+    // Memory may change whenever the debugger's state does
+    if (entry.readAt != _generation && entry.requestedAt != _generation) {
+        auto mapped = lldb::imgui::MapCoreMemory(_debugger, page, kPageSize);
+
+        if (mapped.empty()) {
+            entry.requestedAt = _generation;
+            _queued.push_back(page);
+        } else {
+            entry.page.bytes = { reinterpret_cast<const uint8_t*>(mapped.data()), mapped.size() };
+            entry.page.isReadable = true;
+            entry.page.changed.reset();
+
+            entry.hasData = true;
+            entry.readAt = _generation;
+        }
+    }
+    return entry;
+}
+
+void MemoryCache::EndFrame(lldb::SBDebugger& debugger) {
+    if (!_queued.empty()) {
+        std::ranges::sort(_queued);
+
+        auto future = lldb::imgui::Submit(debugger, [addresses = _queued](lldb::SBDebugger& debugger) {
+            TRACE_ZONE("Read memory");
+
+            auto process = debugger.GetSelectedTarget().GetProcess();
+
+            Batch::Result result {
+                .processID = process.GetUniqueID(),
+                .stopID = process.GetStopID(),
+            };
+
+            // Memory of running processes can't be read, keep showing what was there at the last stop
+            if (!lldb::SBDebugger::StateIsStoppedState(process.GetState())) {
+                return result;
+            }
+
+            for (size_t begin = 0; begin < addresses.size(); ) {
+                auto end = begin + 1;
+
+                while (end < addresses.size() && addresses[end] == addresses[end - 1] + kPageSize) {
+                    end++;
+                }
+
+                // Adjacent pages are read at once
+                std::vector<uint8_t> buffer((end - begin) * kPageSize);
+
+                lldb::SBError error;
+                auto size = process.ReadMemory(addresses[begin], buffer.data(), buffer.size(), error);
+
+                for (auto i = begin; i < end; i++) {
+                    auto offset = (i - begin) * kPageSize;
+
+                    Read read {
+                        .address = addresses[i],
+                        .isReadable = offset + kPageSize <= size,
+                    };
+
+                    if (read.isReadable) {
+                        read.bytes.assign(buffer.begin() + offset, buffer.begin() + offset + kPageSize);
+                    } else if (end - begin > 1) {
+                        // Reads stop at the first unmapped page, the rest of the run may still be readable
+                        read.bytes.resize(kPageSize);
+                        read.isReadable = process.ReadMemory(read.address, read.bytes.data(), kPageSize, error) == kPageSize;
+                    }
+
+                    result.reads.push_back(std::move(read));
+                }
+
+                begin = end;
+            }
+            return result;
+        });
+
+        _batches.push_back(Batch {
+            .generation = _generation,
+            .addresses = std::move(_queued),
+            .future = std::move(future),
+        });
+        _queued.clear();
+    }
+
+    Evict();
+}
+
+void MemoryCache::Apply(const Batch& batch, const Batch::Result& result) {
+    for (const auto& read : result.reads) {
+        auto it = _entries.find(read.address);
+        if (it == _entries.end()) {
+            continue;
+        }
+
+        auto& entry = it->second;
+        auto& page = entry.page;
+
+        bool isSameProcess = entry.hasData && page.processID == result.processID;
+
+        if (!isSameProcess) {
+            page.changed.reset();
+        } else if (page.stopID != result.stopID) {
+            page.changed.reset();
+
+            if (page.isReadable && read.isReadable && memcmp(page.bytes.data(), read.bytes.data(), kPageSize) != 0) {
+                for (size_t i = 0; i < kPageSize; i++) {
+                    page.changed[i] = page.bytes[i] != read.bytes[i];
+                }
+            }
+        }
+
+        page.processID = result.processID;
+        page.stopID = result.stopID;
+        page.isReadable = read.isReadable;
+
+        if (read.isReadable) {
+            std::ranges::copy(read.bytes, entry.storage.begin());
+            page.bytes = entry.storage;
+        }
+
+        entry.hasData = true;
+        entry.readAt = batch.generation;
+        entry.requestedAt = 0;
+    }
+}
+
+void MemoryCache::Evict() {
+    if (_entries.size() <= kMaxPages) {
+        return;
+    }
+
+    std::vector<std::pair<uint64_t, uint64_t>> candidates;
+
+    for (const auto& [address, entry] : _entries) {
+        if (entry.lastUsedFrame != _frame) {
+            candidates.emplace_back(entry.lastUsedFrame, address);
+        }
+    }
+
+    auto count = std::min(candidates.size(), _entries.size() - kMaxPages);
+
+    std::ranges::nth_element(candidates, candidates.begin() + count);
+
+    for (size_t i = 0; i < count; i++) {
+        _entries.erase(candidates[i].second);
+    }
+}
+
+void MemoryCache::Clear() {
+    _entries.clear();
+    _queued.clear();
+    _batches.clear();
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "lldb/API/SBDebugger.h"
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <future>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+/// Page granular copies of the selected process' memory. Pages are read on demand, and all pages
+/// requested during a frame are read by a single query, coalescing adjacent ones into one read.
+///
+/// Pages are kept across stops, and shown until they are read again. Re-reading a page after the
+/// process stopped again records which of its bytes changed.
+///
+/// Pages of processes loaded from a core file are used in place, if the core holds them.
+class MemoryCache {
+public:
+    static constexpr uint64_t kPageSize = 4096;
+
+    /// Pages beyond this are evicted, least recently used first
+    static constexpr size_t kMaxPages = 4096;
+
+    struct Page {
+        // Stop of the process the bytes were read at
+        uint64_t processID = 0;
+        uint32_t stopID = 0;
+
+        bool isReadable = false;
+
+        /// Either a copy read through LLDB, or the page in place in the mapped core file
+        std::span<const uint8_t> bytes;
+        /// Bytes which differ from the previous stop the page was read at
+        std::bitset<kPageSize> changed;
+    };
+
+    /// Applies finished reads, and drops pending ones if the debugger's state changed
+    void BeginFrame(lldb::SBDebugger& debugger);
+
+    /// Page containing `address`, or null if it was never read. Queues a read if the page is missing,
+    /// or may be outdated.
+    const Page* Get(uint64_t address);
+
+    /// Queues a read of the page containing `address` if needed, in anticipation of it being shown
+    void Prefetch(uint64_t address);
+
+    /// Submits queued reads, and evicts pages not used recently
+    void EndFrame(lldb::SBDebugger& debugger);
+
+    void Clear();
+
+private:
+    struct Entry {
+        Page page;
+        bool hasData = false;
+
+        // Backs the page unless it is mapped from a core
+        std::array<uint8_t, kPageSize> storage {};
+
+        // Generation of the debugger the page was last read, or requested at
+        uint64_t readAt = 0;
+        uint64_t requestedAt = 0;
+
+        uint64_t lastUsedFrame = 0;
+    };
+
+    struct Read {
+        uint64_t address;
+        bool isReadable;
+        std::vector<uint8_t> bytes;
+    };
+
+    struct Batch {
+        uint64_t generation;
+        std::vector<uint64_t> addresses;
+
+        struct Result {
+            uint64_t processID;
+            uint32_t stopID;
+            std::vector<Read> reads;
+        };
+        std::shared_future<Result> future;
+    };
+
+    Entry& Touch(uint64_t address);
+    void Apply(const Batch& batch, const Batch::Result& result);
+
+    void Evict();
+
+    lldb::SBDebugger _debugger;
+
+    uint64_t _generation = 0;
+    uint64_t _frame = 0;
+
+    std::unordered_map<uint64_t, Entry> _entries;
+
+    std::vector<uint64_t> _queued;
+    std::vector<Batch> _batches;
+};
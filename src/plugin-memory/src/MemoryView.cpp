@@ -0,0 +1,235 @@
+#include "MemoryView.h"
+
+#include "lldb-imgui/Query.h"
+
+#include "lldb/API/LLDB.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <charconv>
+#include <chrono>
+#include <string>
+#include <string_view>
+
+static constexpr uint64_t kMaxWindowBase = ~uint64_t(0) - MemoryView::kWindowSize + 1;
+
+static constexpr ImU32 kChangedColor = IM_COL32(255, 64, 64, 110);
+
+// "0000000100003f80  cf fa ed fe 0c 00 00 01  00 00 00 00 02 00 00 00  ................"
+static constexpr size_t kAddressColumns = 18;
+static constexpr size_t kAsciiColumn = kAddressColumns + MemoryView::kBytesPerRow * 3 + 2;
+
+static size_t ByteColumn(size_t i) {
+    return kAddressColumns + i * 3 + (i >= MemoryView::kBytesPerRow / 2 ? 1 : 0);
+}
+
+static std::optional<uint64_t> ParseAddress(std::string_view text) {
+    // Anything else is left to the expression evaluator, which also takes decimal numbers
+    if (!text.starts_with("0x") && !text.starts_with("0X")) {
+        return std::nullopt;
+    }
+    text.remove_prefix(2);
+
+    uint64_t address;
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), address, 16);
+
+    if (text.empty() || error != std::errc() || end != text.data() + text.size()) {
+        return std::nullopt;
+    }
+    return address;
+}
+
+void MemoryView::Draw(lldb::SBDebugger& debugger) {
+    _cache.BeginFrame(debugger);
+
+    DrawGoTo(debugger);
+    DrawRows();
+
+    _cache.EndFrame(debugger);
+}
+
+void MemoryView::DrawGoTo(lldb::SBDebugger& debugger) {
+    using namespace ImGui;
+
+    SetNextItemWidth(-FLT_MIN);
+
+    if (InputTextWithHint("##GoTo", "Address or expression", _expression.data(), _expression.size(), ImGuiInputTextFlags_EnterReturnsTrue)) {
+        std::string_view text(_expression.data());
+
+        _isExpressionFailed = false;
+
+        if (auto address = ParseAddress(text)) {
+            GoTo(*address);
+        } else {
+            _expressionQuery = lldb::imgui::Submit(debugger, [expression = std::string(text)](lldb::SBDebugger& debugger) -> std::optional<uint64_t> {
+                auto target = debugger.GetSelectedTarget();
+                auto frame = target.GetProcess().GetSelectedThread().GetSelectedFrame();
+
+                auto value = frame.IsValid() ? frame.EvaluateExpression(expression.c_str()) : target.EvaluateExpression(expression.c_str());
+                if (value.GetError().Fail()) {
+                    return std::nullopt;
+                }
+
+                // Scalars, and pointers go to the address they hold, aggregates to where they are
+                lldb::SBError error;
+                auto address = value.GetValueAsUnsigned(error);
+
+                if (error.Success()) {
+                    return address;
+                }
+                if (auto loadAddress = value.GetLoadAddress(); loadAddress != LLDB_INVALID_ADDRESS) {
+                    return loadAddress;
+                }
+                return std::nullopt;
+            });
+        }
+    }
+
+    if (_expressionQuery && _expressionQuery->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        try {
+            if (auto address = _expressionQuery->get()) {
+                GoTo(*address);
+            } else {
+                _isExpressionFailed = true;
+            }
+        } catch (const lldb::imgui::QueryCancelled&) {
+            // The process moved on, the expression may mean something else by now
+        }
+        _expressionQuery.reset();
+    }
+
+    if (_isExpressionFailed) {
+        TextDisabled("Failed to evaluate '%s' to an address", _expression.data());
+    }
+}
+
+void MemoryView::GoTo(uint64_t address) {
+    auto row = address & ~(kBytesPerRow - 1);
+
+    _windowBase = std::min(row > kWindowSize / 2 ? row - kWindowSize / 2 : 0, kMaxWindowBase);
+    _scrollTo = row;
+    _target = address;
+}
+
+void MemoryView::DrawRows() {
+    using namespace ImGui;
+
+    auto rowHeight = GetTextLineHeightWithSpacing();
+
+    if (_scrollTo) {
+        auto row = (*std::exchange(_scrollTo, std::nullopt) - _windowBase) / kBytesPerRow;
+
+        _scrollY = std::max(0.0f, row * rowHeight - GetContentRegionAvail().y / 2);
+    }
+    if (_scrollY) {
+        SetNextWindowScroll(ImVec2(-1, *std::exchange(_scrollY, std::nullopt)));
+    }
+
+    if (!BeginChild("Rows")) {
+        EndChild();
+        return;
+    }
+
+    auto charWidth = CalcTextSize("0").x;
+    auto textHeight = GetTextLineHeight();
+
+    auto* drawList = GetWindowDrawList();
+
+    auto highlight = [&](ImVec2 position, size_t column, size_t width, ImU32 color) {
+        auto min = ImVec2(position.x + column * charWidth, position.y);
+        auto max = ImVec2(min.x + width * charWidth, min.y + textHeight);
+
+        drawList->AddRectFilled(min, max, color);
+    };
+
+    static constexpr char kHex[] = "0123456789abcdef";
+
+    std::optional<uint64_t> first;
+    std::optional<uint64_t> last;
+
+    ImGuiListClipper clipper;
+    clipper.Begin(int(kWindowSize / kBytesPerRow), rowHeight);
+
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++) {
+            auto address = _windowBase + row * kBytesPerRow;
+            auto offset = address % MemoryCache::kPageSize;
+
+            auto* page = _cache.Get(address);
+
+            if (!first) {
+                first = address;
+            }
+            last = address;
+
+            std::string line(kAsciiColumn + kBytesPerRow, ' ');
+
+            for (size_t i = 0; i < kAddressColumns - 2; i++) {
+                line[i] = kHex[(address >> ((kAddressColumns - 3 - i) * 4)) & 0xF];
+            }
+
+            auto position = GetCursorScreenPos();
+
+            for (size_t i = 0; i < kBytesPerRow; i++) {
+                auto column = ByteColumn(i);
+
+                if (!page) {
+                    line.replace(column, 2, "??");
+                    continue;
+                }
+                if (!page->isReadable) {
+                    line.replace(column, 2, "--");
+                    continue;
+                }
+
+                auto byte = page->bytes[offset + i];
+
+                line[column] = kHex[byte >> 4];
+                line[column + 1] = kHex[byte & 0xF];
+                line[kAsciiColumn + i] = (byte >= 0x20 && byte < 0x7F) ? char(byte) : '.';
+
+                if (page->changed[offset + i]) {
+                    highlight(position, column, 2, kChangedColor);
+                    highlight(position, kAsciiColumn + i, 1, kChangedColor);
+                }
+                if (_target == address + i) {
+                    highlight(position, column, 2, GetColorU32(ImGuiCol_TextSelectedBg));
+                }
+            }
+
+            if (page && page->isReadable) {
+                TextUnformatted(line.data(), line.data() + line.size());
+            } else {
+                TextDisabled("%s", line.c_str());
+            }
+        }
+    }
+
+    // Neighbours of what is on screen are likely shown next
+    if (first && *first >= MemoryCache::kPageSize) {
+        _cache.Prefetch(*first - MemoryCache::kPageSize);
+    }
+    if (last && *last <= ~uint64_t(0) - MemoryCache::kPageSize) {
+        _cache.Prefetch(*last + MemoryCache::kPageSize);
+    }
+
+    // Move the window along before the scroll position reaches either end of it
+    auto scrollY = GetScrollY();
+    auto margin = GetScrollMaxY() / 4;
+
+    if (scrollY < margin && _windowBase > 0) {
+        auto shift = std::min(_windowBase, kWindowSize / 2);
+
+        _windowBase -= shift;
+        _scrollY = scrollY + shift / kBytesPerRow * rowHeight;
+    } else if (scrollY > GetScrollMaxY() - margin && _windowBase < kMaxWindowBase) {
+        auto shift = std::min(kMaxWindowBase - _windowBase, kWindowSize / 2);
+
+        _windowBase += shift;
+        _scrollY = scrollY - shift / kBytesPerRow * rowHeight;
+    }
+
+    EndChild();
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "MemoryCache.h"
+
+#include "lldb/API/SBDebugger.h"
+
+#include <array>
+#include <cstdint>
+#include <future>
+#include <optional>
+
+/// Hex view of the selected process' memory. Only the rows on screen are read, through the cache.
+///
+/// Scroll positions are floats, which can't address every row of a 64-bit address space. The view
+/// scrolls through a window of `kWindowSize` bytes instead, which is moved along once the scroll
+/// position nears either of its ends.
+class MemoryView {
+public:
+    static constexpr uint64_t kBytesPerRow = 16;
+    static constexpr uint64_t kWindowSize = 1024 * 1024;
+
+    void Draw(lldb::SBDebugger& debugger);
+
+private:
+    void DrawGoTo(lldb::SBDebugger& debugger);
+    void DrawRows();
+
+    void GoTo(uint64_t address);
+
+    MemoryCache _cache;
+
+    uint64_t _windowBase = 0;
+
+    // Row to center on, the next time the rows are drawn
+    std::optional<uint64_t> _scrollTo;
+    std::optional<float> _scrollY;
+
+    /// Byte last navigated to
+    std::optional<uint64_t> _target;
+
+    std::array<char, 256> _expression {};
+    std::optional<std::shared_future<std::optional<uint64_t>>> _expressionQuery;
+    bool _isExpressionFailed = false;
+};
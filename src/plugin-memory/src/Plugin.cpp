@@ -0,0 +1,24 @@
+#include "MemoryView.h"
+
+#include "lldb/API/LLDB.h"
+#include "lldb-imgui/Plugin.h"
+
+#include "imgui.h"
+
+#include <format>
+#include <unordered_map>
+
+static void DrawDebugger(lldb::SBDebugger& debugger) {
+    static std::unordered_map<lldb::user_id_t, MemoryView> views;
+
+    auto title = std::format("Memory ({})", debugger.GetID());
+
+    if (ImGui::Begin(title.c_str())) {
+        views[debugger.GetID()].Draw(debugger);
+    }
+    ImGui::End();
+}
+
+LLDB_IMGUI_PLUGIN({
+    .drawDebugger = DrawDebugger,
+});
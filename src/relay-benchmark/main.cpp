@@ -0,0 +1,214 @@
+#include "SocketRelay.h"
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+#include <print>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace lldb::imgui;
+
+namespace {
+
+uint8_t PatternAt(uint64_t offset) {
+    return uint8_t(offset ^ (offset >> 8) ^ (offset >> 16));
+}
+
+/// Writes `total` bytes of the pattern in uneven chunks, then closes the socket
+void WritePattern(int fd, uint64_t total) {
+    static constexpr size_t kChunkSizes[] = { 1, 100, 4096, 65536 + 17, 1024 * 1024 };
+
+    std::vector<uint8_t> chunk;
+    uint64_t offset = 0;
+
+    for (size_t i = 0; offset < total; i++) {
+        chunk.resize(std::min<uint64_t>(kChunkSizes[i % std::size(kChunkSizes)], total - offset));
+
+        for (size_t j = 0; j < chunk.size(); j++) {
+            chunk[j] = PatternAt(offset + j);
+        }
+
+        for (size_t written = 0; written < chunk.size();) {
+            auto size = write(fd, chunk.data() + written, chunk.size() - written);
+            if (size <= 0) {
+                std::println(stderr, "write() failed");
+                std::exit(1);
+            }
+            written += size;
+        }
+        offset += chunk.size();
+    }
+
+    close(fd);
+}
+
+/// The relay as it was: 1 KiB reads appended to a locked string, which the reader swaps out, and
+/// copies into its buffer through a staging string
+class LegacyRelay {
+public:
+    explicit LegacyRelay(int fd)
+    : _fd(fd)
+    , _thread([this] { Run(); })
+    {}
+    ~LegacyRelay() {
+        _thread.join();
+    }
+
+    /// Returns zero once the socket closed
+    size_t Read(std::vector<uint8_t>& buffer) {
+        std::string staging;
+        {
+            std::unique_lock lock(_mutex);
+
+            _wakeup.wait(lock, [&] {
+                return !_buffer.empty() || _isClosed;
+            });
+            staging.append(std::exchange(_buffer, std::string()));
+        }
+
+        buffer.clear();
+        buffer.insert(buffer.end(), staging.begin(), staging.end());
+        return buffer.size();
+    }
+
+private:
+    void Run() {
+        char buffer[1024];
+
+        while (true) {
+            auto size = read(_fd, buffer, sizeof(buffer));
+
+            std::scoped_lock lock(_mutex);
+
+            if (size <= 0) {
+                _isClosed = true;
+                _wakeup.notify_one();
+                return;
+            }
+
+            _buffer.append(buffer, size);
+            _wakeup.notify_one();
+        }
+    }
+
+    int _fd;
+
+    std::mutex _mutex;
+    std::condition_variable _wakeup;
+
+    std::string _buffer;
+    bool _isClosed = false;
+
+    std::thread _thread;
+};
+
+struct Result {
+    double seconds = 0;
+    uint64_t reads = 0;
+};
+
+bool Verify(const uint8_t* data, size_t size, uint64_t& offset) {
+    for (size_t i = 0; i < size; i++) {
+        if (data[i] != PatternAt(offset + i)) {
+            std::println(stderr, "Mismatch at byte {}", offset + i);
+            return false;
+        }
+    }
+    offset += size;
+    return true;
+}
+
+template<typename F>
+Result Measure(uint64_t total, F&& consume) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        std::println(stderr, "socketpair() failed");
+        std::exit(1);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread writer(WritePattern, fds[0], total);
+
+    Result result;
+    result.reads = consume(fds[1]);
+
+    writer.join();
+    close(fds[1]);
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+}
+
+int main(int argc, const char* argv[]) {
+    uint64_t megabytes = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 512;
+    uint64_t total = megabytes * 1024 * 1024;
+
+    bool isValid = true;
+
+    auto legacy = Measure(total, [&](int fd) {
+        LegacyRelay relay(fd);
+
+        std::vector<uint8_t> buffer;
+        uint64_t offset = 0;
+        uint64_t reads = 0;
+
+        while (auto size = relay.Read(buffer)) {
+            isValid &= Verify(buffer.data(), size, offset);
+            reads++;
+        }
+
+        isValid &= offset == total;
+        return reads;
+    });
+
+    auto relay = Measure(total, [&](int fd) {
+        SocketRelay relay(fd);
+
+        std::vector<uint8_t> buffer;
+        uint64_t offset = 0;
+        uint64_t reads = 0;
+
+        while (true) {
+            relay.Wait();
+
+            // Delivered straight into the caller's buffer, sized to what is available
+            buffer.resize(relay.Available());
+            if (buffer.empty() && relay.IsClosed()) {
+                break;
+            }
+
+            auto size = relay.Read(buffer);
+            isValid &= Verify(buffer.data(), size, offset);
+            reads++;
+        }
+
+        isValid &= offset == total;
+        return reads;
+    });
+
+    auto print = [&](const char* name, const Result& result) {
+        std::println("{:<16}{:>12.1f}{:>12}{:>16.1f}", name, megabytes / result.seconds, result.reads, double(total) / result.reads / 1024);
+    };
+
+    std::println("Relayed {} MiB", megabytes);
+    std::println();
+    std::println("{:<16}{:>12}{:>12}{:>16}", "Relay", "MiB/s", "Reads", "KiB per read");
+    print("Legacy", legacy);
+    print("SocketRelay", relay);
+
+    if (!isValid) {
+        std::println(stderr, "Relayed data does not match what was written");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,208 @@
+#include "DrawStream.h"
+
+#include "imgui.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <print>
+#include <span>
+#include <vector>
+
+using namespace lldb::imgui;
+
+namespace {
+
+constexpr int kFrames = 300;
+
+/// Texture of the font atlas on the serving side
+const auto kFontTexture = ImTextureID(1);
+
+/// Texture of the font atlas on the viewing side, which decoded commands are expected to use
+const auto kViewerFontTexture = ImTextureID(2);
+
+/// Draws a frame which changes a little every time, and a lot every now and then
+ImDrawData* DrawFrame(int frame) {
+    ImGuiIO& io = ImGui::GetIO();
+
+    io.DeltaTime = 1.0f / 60;
+    io.DisplaySize = frame < kFrames / 2 ? ImVec2(1280, 720) : ImVec2(1920, 1080);
+    io.MousePos = ImVec2(float(frame * 7 % 1280), float(frame * 3 % 720));
+
+    ImGui::NewFrame();
+    ImGui::ShowDemoWindow();
+
+    // Lists come and go
+    if (frame % 20 < 10) {
+        ImGui::Begin("Counter");
+        ImGui::Text("Frame %d", frame);
+        ImGui::End();
+    }
+
+    ImGui::Render();
+    return ImGui::GetDrawData();
+}
+
+bool IsSameList(const ImDrawList* expected, const ImDrawList* actual) {
+    if (expected->VtxBuffer.Size != actual->VtxBuffer.Size || expected->IdxBuffer.Size != actual->IdxBuffer.Size) {
+        return false;
+    }
+    if (memcmp(expected->VtxBuffer.Data, actual->VtxBuffer.Data, expected->VtxBuffer.size_in_bytes()) != 0) {
+        return false;
+    }
+    if (memcmp(expected->IdxBuffer.Data, actual->IdxBuffer.Data, expected->IdxBuffer.size_in_bytes()) != 0) {
+        return false;
+    }
+
+    int j = 0;
+
+    for (const auto& command : expected->CmdBuffer) {
+        if (command.UserCallback || command.TextureId != kFontTexture) {
+            continue;
+        }
+        if (j == actual->CmdBuffer.Size) {
+            return false;
+        }
+
+        const auto& decoded = actual->CmdBuffer[j++];
+
+        if (memcmp(&command.ClipRect, &decoded.ClipRect, sizeof(ImVec4)) != 0 || decoded.TextureId != kViewerFontTexture) {
+            return false;
+        }
+        if (command.VtxOffset != decoded.VtxOffset || command.IdxOffset != decoded.IdxOffset || command.ElemCount != decoded.ElemCount) {
+            return false;
+        }
+    }
+    return j == actual->CmdBuffer.Size;
+}
+
+bool IsSameFrame(const ImDrawData* expected, stream::DrawStreamDecoder& decoder) {
+    ImDrawData decoded;
+    decoder.EndFrame(&decoded);
+
+    if (decoded.CmdListsCount != expected->CmdListsCount) {
+        return false;
+    }
+
+    for (int i = 0; i < expected->CmdListsCount; i++) {
+        if (!IsSameList(expected->CmdLists[i], decoded.CmdLists[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Encodes `drawData` on its own, and checks that a fresh decoder rejects it
+bool IsRejected(const ImDrawData* drawData) {
+    stream::DrawStreamEncoder encoder;
+    stream::DrawStreamDecoder decoder;
+
+    std::vector<uint8_t> payload;
+    encoder.Encode(drawData, kFontTexture, payload);
+
+    return !decoder.Decode(payload, kViewerFontTexture);
+}
+
+}
+
+int main() {
+    ImGui::CreateContext();
+    {
+        ImGuiIO& io = ImGui::GetIO();
+        io.IniFilename = nullptr;
+
+        unsigned char* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+        io.Fonts->SetTexID(kFontTexture);
+    }
+
+    bool isValid = true;
+
+    auto check = [&](bool condition, const char* message, int frame) {
+        if (!condition) {
+            std::println(stderr, "Frame {}: {}", frame, message);
+            isValid = false;
+        }
+    };
+
+    stream::DrawStreamEncoder encoder;
+    stream::DrawStreamDecoder decoder;
+
+    std::vector<uint8_t> payload;
+    size_t sent = 0;
+    size_t rawSize = 0;
+
+    for (int frame = 0; frame < kFrames; frame++) {
+        auto* drawData = DrawFrame(frame);
+
+        rawSize += drawData->TotalVtxCount * sizeof(ImDrawVert) + drawData->TotalIdxCount * sizeof(ImDrawIdx);
+
+        if (!encoder.Encode(drawData, kFontTexture, payload)) {
+            check(frame > 0, "the first frame was not encoded", frame);
+            continue;
+        }
+        sent += payload.size();
+
+        check(decoder.Decode(payload, kViewerFontTexture), "a valid frame was rejected", frame);
+        check(IsSameFrame(drawData, decoder), "the decoded frame differs", frame);
+    }
+
+    auto* drawData = DrawFrame(kFrames);
+
+    // A truncated frame never decodes
+    {
+        stream::DrawStreamEncoder fresh;
+        fresh.Encode(drawData, kFontTexture, payload);
+
+        for (size_t size = 0; size < payload.size(); size += 1 + size / 64) {
+            stream::DrawStreamDecoder truncated;
+            check(!truncated.Decode(std::span(payload).first(size), kViewerFontTexture), "a truncated frame was accepted", kFrames);
+        }
+    }
+
+    // Corrupted bytes may decode to a different frame, but never out of bounds
+    {
+        uint32_t seed = 1;
+
+        for (int i = 0; i < 1000; i++) {
+            auto corrupted = payload;
+
+            for (int j = 0; j < 4; j++) {
+                seed = seed * 1664525 + 1013904223;
+                corrupted[seed % corrupted.size()] ^= uint8_t(seed >> 24) | 1;
+            }
+
+            stream::DrawStreamDecoder target;
+            target.Decode(corrupted, kViewerFontTexture);
+        }
+    }
+
+    // Indices past the vertices
+    {
+        auto* list = drawData->CmdLists[0];
+
+        auto index = list->IdxBuffer[0];
+        list->IdxBuffer[0] = ImDrawIdx(list->VtxBuffer.Size);
+        check(IsRejected(drawData), "an index past the vertices was accepted", kFrames);
+        list->IdxBuffer[0] = index;
+
+        auto vertexOffset = list->CmdBuffer[0].VtxOffset;
+        list->CmdBuffer[0].VtxOffset = list->VtxBuffer.Size;
+        check(IsRejected(drawData), "a vertex offset past the vertices was accepted", kFrames);
+        list->CmdBuffer[0].VtxOffset = vertexOffset;
+
+        check(!IsRejected(drawData), "the restored frame was rejected", kFrames);
+    }
+
+    ImGui::DestroyContext();
+
+    std::println("Streamed {} frames, {} KiB of {} KiB of draw data", kFrames, sent / 1024, rawSize / 1024);
+
+    if (!isValid) {
+        std::println(stderr, "Decoded frames do not match what was encoded");
+        return 1;
+    }
+    return 0;
+}
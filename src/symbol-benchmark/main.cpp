@@ -0,0 +1,139 @@
+#include "SymbolIndex.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <memory>
+#include <print>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+using namespace lldb::imgui;
+
+namespace {
+
+constexpr size_t kNumModules = 16;
+
+constexpr int kRepetitions = 5;
+
+/// Per keystroke, so the whole search has to fit in a frame
+constexpr double kBudgetMs = 16;
+
+constexpr std::string_view kWords[] = {
+    "lldb", "imgui", "llvm", "clang", "std", "detail", "impl", "internal",
+    "Target", "Process", "Thread", "Frame", "Module", "Symbol", "Value", "Type",
+    "Debugger", "Breakpoint", "Address", "Section", "Memory", "Register", "Plugin", "Window",
+    "get", "set", "find", "create", "update", "resolve", "read", "write",
+    "Index", "Cache", "Table", "Map", "List", "Buffer", "Stream", "Context",
+};
+
+/// Names shaped like demangled C++ functions, `ns::ns::Class::method42`
+std::vector<std::string> GenerateNames(size_t count, uint32_t seed) {
+    auto next = [&] {
+        seed = seed * 1664525 + 1013904223;
+        return seed >> 8;
+    };
+    auto word = [&] {
+        return kWords[next() % std::size(kWords)];
+    };
+
+    std::vector<std::string> names;
+    names.reserve(count);
+
+    for (size_t i = 0; i < count; i++) {
+        std::string name;
+
+        for (uint32_t depth = next() % 3 + 1; depth > 0; depth--) {
+            name += word();
+            name += "::";
+        }
+        name += word();
+        name += word();
+        name += "::";
+        name += word();
+        name += word();
+        name += std::to_string(next() % 100);
+
+        names.push_back(std::move(name));
+    }
+    return names;
+}
+
+}
+
+int main(int argc, const char* argv[]) {
+    uint64_t numSymbols = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4 * 1024 * 1024;
+
+    ThreadPool pool;
+    SymbolSearch search(pool);
+
+    {
+        std::vector<std::shared_ptr<const ModuleSymbolIndex>> modules;
+
+        for (size_t i = 0; i < kNumModules; i++) {
+            auto names = GenerateNames(numSymbols / kNumModules, uint32_t(i + 1));
+
+            std::vector<ModuleSymbolIndex::Symbol> symbols;
+            symbols.reserve(names.size());
+
+            for (size_t j = 0; j < names.size(); j++) {
+                symbols.push_back(ModuleSymbolIndex::Symbol {
+                    .name = names[j],
+                    .fileAddress = j * 16,
+                });
+            }
+
+            modules.push_back(ModuleSymbolIndex::Create(std::format("lib{}.so", i), symbols));
+        }
+        search.SetModules(std::move(modules));
+    }
+
+    std::println("Searching {} symbols in {} modules on {} threads", search.NumSymbols(), search.NumModules(), pool.Size() + 1);
+    std::println();
+    std::println("{:<24}{:>12}{:>12}{:>12}", "Query", "Results", "Median ms", "Max ms");
+
+    double slowestMs = 0;
+
+    // Typed one key at a time, the longer the query the fewer names get past the masks
+    for (std::string_view typed : { "debuggerframe", "gtmodsym", "resolveaddress42", "zzz" }) {
+        for (size_t length = 1; length <= typed.size(); length++) {
+            auto query = typed.substr(0, length);
+
+            std::vector<double> durations;
+            size_t numResults = 0;
+
+            for (int i = 0; i < kRepetitions; i++) {
+                auto start = std::chrono::steady_clock::now();
+                numResults = search.Search(query).size();
+
+                durations.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            }
+
+            std::ranges::sort(durations);
+
+            auto medianMs = durations[durations.size() / 2];
+            slowestMs = std::max(slowestMs, medianMs);
+
+            std::println("{:<24}{:>12}{:>12.2f}{:>12.2f}", query, numResults, medianMs, durations.back());
+        }
+    }
+
+    // Searching is split evenly between the threads, this tells how many it takes to stay in budget
+    auto numThreads = std::min<size_t>(pool.Size() + 1, std::max(std::thread::hardware_concurrency(), 1u));
+    auto nanosecondsPerSymbol = slowestMs * 1e6 * numThreads / search.NumSymbols();
+
+    std::println();
+    std::println("Slowest query took {:.2f} ms, the budget is {:.0f} ms", slowestMs, kBudgetMs);
+    std::println("That is {:.1f} ns per symbol and thread, or {} symbols per thread in budget", nanosecondsPerSymbol, uint64_t(kBudgetMs * 1e6 / nanosecondsPerSymbol));
+
+    if (slowestMs > kBudgetMs) {
+        std::println(stderr, "Searching is over budget");
+        return 1;
+    }
+    return 0;
+}